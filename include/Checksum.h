@@ -0,0 +1,42 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Checksums appended to UART frames, selected by name. Each is stored on
+// the wire in the byte order its protocols use.
+const char kChecksumCrc16Modbus[] = "crc16-modbus";  // little endian
+const char kChecksumCrc16Ccitt[] = "crc16-ccitt";    // big endian
+const char kChecksumCrc32[] = "crc32";               // little endian
+
+uint16_t Crc16Modbus(const uint8_t* data, size_t size);
+uint16_t Crc16Ccitt(const uint8_t* data, size_t size);
+uint32_t Crc32(const uint8_t* data, size_t size);
+
+bool IsChecksum(const std::string& checksum);
+
+// Size of |checksum| on the wire, 0 if unknown.
+size_t ChecksumSize(const std::string& checksum);
+
+void AppendChecksum(const std::string& checksum, std::vector<uint8_t>* data);
+
+// Checks the checksum at the end of |frame| and strips it. Returns false
+// if it is missing or does not match.
+bool VerifyChecksum(const std::string& checksum, std::vector<uint8_t>* frame);
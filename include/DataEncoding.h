@@ -0,0 +1,35 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Text encodings for binary payloads, selected by the "encoding" property
+// of the data-carrying methods. Without it data stays a JSON byte array.
+const char kEncodingBase64[] = "base64";
+const char kEncodingHex[] = "hex";
+
+bool IsDataEncoding(const std::string& encoding);
+
+std::string EncodeData(const uint8_t* data, size_t size,
+        const std::string& encoding);
+
+// Returns false if |text| is not valid in |encoding|.
+bool DecodeData(const std::string& text, const std::string& encoding,
+        std::vector<uint8_t>* data);
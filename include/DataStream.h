@@ -0,0 +1,120 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Every packet on a data stream socket is one frame: this header followed
+// by |length| payload bytes. Both ends live on the same host, so fields are
+// in host byte order.
+struct StreamFrameHeader {
+    uint16_t type;
+    uint16_t flags;
+    uint32_t sequence;
+    uint32_t length;
+};
+
+enum StreamFrameType : uint16_t {
+    // Raw device bytes, in either direction.
+    kStreamFrameData = 1,
+    // Sent by the service when a data frame failed; the payload is the
+    // int32_t PeripheralManagerErrors code.
+    kStreamFrameError = 2,
+    // Sent by the service once the peer's hello is accepted when the
+    // stream uses a SharedRing:
+    // the memfd and eventfd travel as SCM_RIGHTS, the payload is the
+    // uint32_t ring capacity. Device data then goes through the ring as
+    // length-framed records: one per UART read or one per GPIO edge.
+    kStreamFrameRing = 3,
+    // The first frame a peer sends; the payload is the token from the
+    // openStream reply. The service drops peers that open with anything
+    // else.
+    kStreamFrameHello = 4,
+};
+
+// One GPIO edge, the payload of one record in a gpio stream's SharedRing.
+struct StreamGpioEdge {
+    uint64_t timestamp_ns;
+    uint32_t value;
+    uint32_t reserved;
+};
+
+// Largest payload one frame may carry.
+const size_t kStreamMaxPayload = 65536;
+// Most fds one frame may carry.
+const size_t kStreamMaxFds = 4;
+
+// Local AF_UNIX SEQPACKET endpoint that carries raw frames between the
+// service and one client, so bulk data never goes through JSON. The
+// service listens and keeps at most one peer; clients and tools connect.
+// Send() may be called from any thread, the rest from one thread only.
+// The service's peer socket is non-blocking: a peer that stops reading
+// loses frames, visible as a gap in their sequence numbers, instead of
+// stalling the main loop or a bus worker.
+class DataStream {
+public:
+    // Listens on |path|, replacing a stale socket left there.
+    static std::unique_ptr<DataStream> Listen(const std::string& path);
+    // Connects to a stream the service listens on.
+    static std::unique_ptr<DataStream> Connect(const std::string& path);
+    // Closes both sockets and removes the listening path.
+    ~DataStream();
+
+    const std::string& Path() const { return path_; }
+    int ListenFd() const { return listen_fd_; }
+    int PeerFd() const { return peer_fd_; }
+    // Credentials of the peer when it connected, from SO_PEERCRED.
+    pid_t PeerPid() const { return peer_pid_; }
+    uid_t PeerUid() const { return peer_uid_; }
+    // Frames Send() dropped because the peer's socket buffer was full.
+    uint64_t Dropped() const { return dropped_; }
+
+    // Takes the pending connection as the peer. While a peer is connected
+    // further connections are refused and false is returned.
+    bool Accept();
+    void Disconnect();
+
+    // |fds| are passed along with the frame. Returns false when the frame
+    // was not sent, also when the accepted peer is too slow to take it.
+    bool Send(uint16_t type, uint32_t sequence, const uint8_t* data, size_t size,
+            const std::vector<int>& fds = std::vector<int>());
+    // Reads the next frame, blocking on a connected stream; the service
+    // calls it once the peer socket is readable. Returns false once the
+    // peer is gone or sent something that is not a well-formed frame. Fds that came with
+    // the frame are stored in |fds| and owned by the caller, or closed
+    // when |fds| is null.
+    bool Receive(StreamFrameHeader* header, std::vector<uint8_t>* payload,
+            std::vector<int>* fds = nullptr);
+
+private:
+    DataStream(int listen_fd, int peer_fd, const std::string& path);
+
+    // Guards |peer_fd_| against Send() from another thread.
+    std::mutex mutex_;
+    int listen_fd_;
+    int peer_fd_;
+    pid_t peer_pid_;
+    uid_t peer_uid_;
+    std::string path_;
+    std::atomic<uint64_t> dropped_;
+};
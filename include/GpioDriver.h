@@ -1,66 +1,87 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <stdint.h>
-#include <memory>
-#include <string>
-#include "Constants.h"
-#include "Logger.h"
-
-
-// This interface must be implemented by all
-// Gpio drivers.
-class GpioDriverInterface {
-public:
-    GpioDriverInterface() {}
-    virtual ~GpioDriverInterface() {}
-
-    virtual bool Init(uint32_t index) = 0;
-
-    virtual bool SetValue(bool val) = 0;
-    virtual bool GetValue(bool* val) = 0;
-    virtual bool SetDirection(GpioDirection direction) = 0;
-    virtual int  GetPollingFd(int * fd) = 0;
-    virtual bool getDirection(std::string& direction) =0;
-};
-
-// The following is driver boilerplate.
-class GpioDriverInfoBase {
-public:
-    GpioDriverInfoBase() {}
-    virtual ~GpioDriverInfoBase() {}
-
-    virtual std::string Compat() = 0;
-    virtual std::unique_ptr<GpioDriverInterface> Probe() = 0;
-};
-
-template <class T, class PARAM>
-class GpioDriverInfo : public GpioDriverInfoBase {
-public:
-    explicit GpioDriverInfo(PARAM param) : param_(param) {}
-    ~GpioDriverInfo() override {}
-
-    std::string Compat() override { return T::Compat(); }
-
-    std::unique_ptr<GpioDriverInterface> Probe() override {
-        return std::unique_ptr<GpioDriverInterface>(new T(param_));
-    }
-
-private:
-    PARAM param_;
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Constants.h"
+#include "Logger.h"
+
+
+// This interface must be implemented by all
+// Gpio drivers.
+class GpioDriverInterface {
+public:
+    GpioDriverInterface() {}
+    virtual ~GpioDriverInterface() {}
+
+    // |chip| is only meaningful to drivers that address lines per chip.
+    virtual bool Init(uint32_t chip, uint32_t index) = 0;
+
+    virtual bool SetValue(bool val) = 0;
+    virtual bool GetValue(bool* val) = 0;
+    virtual bool SetDirection(GpioDirection direction) = 0;
+    // Returns a new fd on the pin's value, owned by the caller.
+    virtual int  GetPollingFd(int * fd) = 0;
+    virtual bool getDirection(std::string& direction) =0;
+
+    // Edge detection. Once an edge type is set, |fd| from GetEdgeFd()
+    // becomes ready for the poll(2) |events| whenever an edge is pending,
+    // and ReadEdgeEvent() consumes it. |timestamp_ns| is CLOCK_MONOTONIC.
+    // GetEdgeFd() fails while the edge type is kEdgeNone, since the fd
+    // would never become ready.
+    virtual bool SetEdgeType(GpioEdgeType type) = 0;
+    virtual bool GetEdgeFd(int* fd, short* events) = 0;
+    virtual bool ReadEdgeEvent(bool* value, uint64_t* timestamp_ns) = 0;
+
+    // Multi-line access, for drivers that can hold several lines of a chip
+    // in one request and change them atomically. Bit i of |bits| and |mask|
+    // maps to lines[i]. Drivers without that ability keep the defaults.
+    virtual bool InitLines(uint32_t chip, const std::vector<uint32_t>& lines) {
+        return false;
+    }
+    virtual bool SetValues(uint64_t bits, uint64_t mask) { return false; }
+    virtual bool GetValues(uint64_t* bits, uint64_t mask) { return false; }
+};
+
+// The following is driver boilerplate.
+class GpioDriverInfoBase {
+public:
+    GpioDriverInfoBase() {}
+    virtual ~GpioDriverInfoBase() {}
+
+    virtual std::string Compat() = 0;
+    virtual std::unique_ptr<GpioDriverInterface> Probe() = 0;
+};
+
+template <class T, class PARAM>
+class GpioDriverInfo : public GpioDriverInfoBase {
+public:
+    explicit GpioDriverInfo(PARAM param) : param_(param) {}
+    ~GpioDriverInfo() override {}
+
+    std::string Compat() override { return T::Compat(); }
+
+    std::unique_ptr<GpioDriverInterface> Probe() override {
+        return std::unique_ptr<GpioDriverInterface>(new T(param_));
+    }
+
+private:
+    PARAM param_;
+};
@@ -0,0 +1,66 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include "CharDevice.h"
+#include "GpioDriver.h"
+#include "Logger.h"
+
+// Gpio driver backed by the Linux GPIO character device (uAPI v2).
+// Each pin is a single line request on /dev/gpiochipN; a pin group on one
+// chip can also be held as one multi-line request.
+class GpioDriverChardev : public GpioDriverInterface {
+public:
+    explicit GpioDriverChardev(CharDeviceFactory* char_device_factory);
+    ~GpioDriverChardev();
+
+    static std::string Compat() { return "GPIOCHARDEV"; }
+
+    bool Init(uint32_t chip, uint32_t index) override;
+
+    // Gpio Driver interface.
+    bool SetValue(bool val) override;
+    bool GetValue(bool* val) override;
+    bool SetDirection(GpioDirection direction) override;
+    bool getDirection(std::string& direction) override;
+    int  GetPollingFd(int * fd) override;
+    bool SetEdgeType(GpioEdgeType type) override;
+    bool GetEdgeFd(int* fd, short* events) override;
+    bool ReadEdgeEvent(bool* value, uint64_t* timestamp_ns) override;
+
+    bool InitLines(uint32_t chip, const std::vector<uint32_t>& lines) override;
+    bool SetValues(uint64_t bits, uint64_t mask) override;
+    bool GetValues(uint64_t* bits, uint64_t mask) override;
+
+private:
+    // Chip fd, used for line info queries.
+    int fd_;
+    // Line request fd returned by GPIO_V2_GET_LINE_IOCTL.
+    int line_fd_;
+    // Offset of the first requested line.
+    uint32_t offset_;
+    uint32_t num_lines_;
+    // Edge type the line is configured for.
+    GpioEdgeType edge_type_;
+
+    // Used for unit testing and is null in production.
+    // Ownership is in the test and outlives this class.
+    CharDeviceFactory* char_device_factory_;
+    std::unique_ptr<CharDeviceInterface> char_interface_;
+};
@@ -1,96 +1,187 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-// Author(s)    : Sanjay Poptani
-// Email ID.    : sanjay.poptani@lge.com
-
-#pragma once
-
-#include <stdint.h>
-#include <map>
-#include <memory>
-#include <string>
-#include <vector>
-#include "GpioDriver.h"
-#include "Logger.h"
-#include "PinmuxManager.h"
-
-struct GpioPinSysfs {
-    uint32_t index;
-    std::string mux;
-    std::unique_ptr<GpioDriverInterface> driver_;
-};
-
-class GpioPin {
-public:
-    explicit GpioPin(GpioPinSysfs* pin) : pin_(pin) {}
-    ~GpioPin() {
-        if (!pin_->mux.empty()) {
-            PinMuxManager::GetPinMuxManager()->ReleaseGpio(pin_->mux);
-        }
-        pin_->driver_.reset();
-    }
-
-    bool SetValue(bool val) { return pin_->driver_->SetValue(val); }
-
-    bool GetValue(bool* val) { return pin_->driver_->GetValue(val); }
-
-    bool SetDirection(GpioDirection direction) {
-        if (!pin_->mux.empty()) {
-            bool dir = true;
-            if (direction == kDirectionIn)
-                dir = false;
-        }
-        return pin_->driver_->SetDirection(direction);
-    }
-    bool getDirection(std::string&  direction) { return pin_->driver_->getDirection(direction);}
-    bool GetPollingFd(int* fd) {
-        return pin_->driver_->GetPollingFd(fd);
-    }
-
-private:
-    GpioPinSysfs* pin_;
-};
-
-class GpioManager {
-public:
-    friend class GpioManagerTest;
-    ~GpioManager();
-
-    // Get the singleton.
-    static GpioManager* GetGpioManager();
-
-    // Delete the GpioManager (used for test);
-    static void ResetGpioManager();
-
-    // Used by the BSP to tell PMan of an GPIO Pin.
-    bool RegisterGpioSysfs(const std::string& name, uint32_t index);
-    bool SetPinMux(const std::string& name, const std::string& mux);
-
-    // Query for available pins.
-    std::vector<std::string> GetGpioPins();
-    bool HasGpio(const std::string& pin_name);
-
-    bool RegisterDriver(std::unique_ptr<GpioDriverInfoBase> driver_info);
-
-    std::unique_ptr<GpioPin> OpenGpioPin(const std::string& name);
-
-private:
-    GpioManager();
-
-    std::map<std::string, std::unique_ptr<GpioDriverInfoBase>> driver_infos_;
-    std::map<std::string, GpioPinSysfs> sysfs_pins_;
-
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+// Author(s)    : Sanjay Poptani
+// Email ID.    : sanjay.poptani@lge.com
+
+#pragma once
+
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "GpioDriver.h"
+#include "Logger.h"
+#include "PinmuxManager.h"
+
+struct GpioPinSysfs {
+    uint32_t index;
+    // Gpio chip the line belongs to, for drivers addressing lines per chip.
+    uint32_t chip;
+    // Compat string of the driver used to open this pin.
+    std::string driver;
+    std::string mux;
+    // Set while the line is held by a multi-line GpioGroup request.
+    bool in_group;
+    std::unique_ptr<GpioDriverInterface> driver_;
+};
+
+class GpioPin {
+public:
+    explicit GpioPin(GpioPinSysfs* pin) : pin_(pin) {}
+    ~GpioPin() {
+        if (!pin_->mux.empty()) {
+            PinMuxManager::GetPinMuxManager()->ReleaseGpio(pin_->mux);
+        }
+        pin_->driver_.reset();
+    }
+
+    bool SetValue(bool val) { return pin_->driver_->SetValue(val); }
+
+    bool GetValue(bool* val) { return pin_->driver_->GetValue(val); }
+
+    bool SetDirection(GpioDirection direction) {
+        if (!pin_->mux.empty()) {
+            bool dir = true;
+            if (direction == kDirectionIn)
+                dir = false;
+        }
+        return pin_->driver_->SetDirection(direction);
+    }
+    bool getDirection(std::string&  direction) { return pin_->driver_->getDirection(direction);}
+    bool GetPollingFd(int* fd) {
+        return pin_->driver_->GetPollingFd(fd);
+    }
+
+    bool SetEdgeType(GpioEdgeType type) {
+        return pin_->driver_->SetEdgeType(type);
+    }
+
+    bool GetEdgeFd(int* fd, short* events) {
+        return pin_->driver_->GetEdgeFd(fd, events);
+    }
+
+    bool ReadEdgeEvent(bool* value, uint64_t* timestamp_ns) {
+        return pin_->driver_->ReadEdgeEvent(value, timestamp_ns);
+    }
+
+private:
+    GpioPinSysfs* pin_;
+};
+
+// A set of pins driven together. Bit i of a value/mask maps to the i-th pin.
+// When every pin sits on one chip of a driver supporting multi-line requests
+// the group holds a single request and changes atomically; otherwise it
+// falls back to one GpioPin per member.
+class GpioGroup {
+public:
+    GpioGroup(std::vector<GpioPinSysfs*> pins,
+            std::unique_ptr<GpioDriverInterface> driver)
+        : members_(std::move(pins)), driver_(std::move(driver)) {}
+    explicit GpioGroup(std::vector<std::unique_ptr<GpioPin>> pins)
+        : pins_(std::move(pins)) {}
+    ~GpioGroup() {
+        for (auto pin : members_) {
+            if (!pin->mux.empty()) {
+                PinMuxManager::GetPinMuxManager()->ReleaseGpio(pin->mux);
+            }
+            pin->in_group = false;
+        }
+    }
+
+    size_t Size() const { return driver_ ? members_.size() : pins_.size(); }
+
+    bool SetValues(uint64_t bits, uint64_t mask) {
+        if (driver_)
+            return driver_->SetValues(bits, mask);
+        for (size_t i = 0; i < pins_.size(); i++) {
+            if ((mask >> i) & 1) {
+                if (!pins_[i]->SetValue((bits >> i) & 1))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    bool GetValues(uint64_t* bits, uint64_t mask) {
+        if (driver_)
+            return driver_->GetValues(bits, mask);
+        uint64_t result = 0;
+        for (size_t i = 0; i < pins_.size(); i++) {
+            if ((mask >> i) & 1) {
+                bool val = false;
+                if (!pins_[i]->GetValue(&val))
+                    return false;
+                if (val)
+                    result |= (1ULL << i);
+            }
+        }
+        *bits = result;
+        return true;
+    }
+
+    bool SetDirection(GpioDirection direction) {
+        if (driver_)
+            return driver_->SetDirection(direction);
+        for (auto& pin : pins_) {
+            if (!pin->SetDirection(direction))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    // Atomic group: the pins held by |driver_|.
+    std::vector<GpioPinSysfs*> members_;
+    std::unique_ptr<GpioDriverInterface> driver_;
+    // Fallback group: pins opened one by one.
+    std::vector<std::unique_ptr<GpioPin>> pins_;
+};
+
+class GpioManager {
+public:
+    friend class GpioManagerTest;
+    ~GpioManager();
+
+    // Get the singleton.
+    static GpioManager* GetGpioManager();
+
+    // Delete the GpioManager (used for test);
+    static void ResetGpioManager();
+
+    // Used by the BSP to tell PMan of an GPIO Pin.
+    bool RegisterGpioSysfs(const std::string& name, uint32_t index);
+    bool RegisterGpioChardev(const std::string& name, uint32_t chip, uint32_t line);
+    bool SetPinMux(const std::string& name, const std::string& mux);
+
+    // Query for available pins.
+    std::vector<std::string> GetGpioPins();
+    bool HasGpio(const std::string& pin_name);
+    // True while any client has the pin open, alone or in a group.
+    bool IsGpioInUse(const std::string& pin_name);
+
+    bool RegisterDriver(std::unique_ptr<GpioDriverInfoBase> driver_info);
+
+    std::unique_ptr<GpioPin> OpenGpioPin(const std::string& name);
+    std::unique_ptr<GpioGroup> OpenGpioGroup(const std::vector<std::string>& names);
+
+private:
+    GpioManager();
+
+    std::map<std::string, std::unique_ptr<GpioDriverInfoBase>> driver_infos_;
+    std::map<std::string, GpioPinSysfs> sysfs_pins_;
+
+};
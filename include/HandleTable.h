@@ -0,0 +1,102 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Flat slot table behind the integer handles returned by the open calls.
+// A handle packs the slot index with the slot's generation, so a handle
+// kept after its device was closed never reaches a device that reused
+// the slot. Handles are positive; 0 is never valid.
+template <typename T>
+class HandleTable {
+public:
+    int32_t Add(std::unique_ptr<T> value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            if (slots_.size() > kIndexMask)
+                return 0;
+            index = slots_.size();
+            slots_.emplace_back();
+        }
+        Slot& slot = slots_[index];
+        slot.value = std::move(value);
+        return (slot.generation << kIndexBits) | index;
+    }
+
+    T* Get(int32_t handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = Find(handle);
+        return slot ? slot->value.get() : nullptr;
+    }
+
+    // Runs |fn| on the value while no other thread can remove it.
+    template <typename F>
+    bool With(int32_t handle, F fn) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = Find(handle);
+        if (!slot)
+            return false;
+        fn(slot->value.get());
+        return true;
+    }
+
+    // Hands the value back so that it is destroyed outside the table lock.
+    std::unique_ptr<T> Remove(int32_t handle) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Slot* slot = Find(handle);
+        if (!slot)
+            return nullptr;
+        std::unique_ptr<T> value = std::move(slot->value);
+        slot->generation = slot->generation % kMaxGeneration + 1;
+        free_.push_back(handle & kIndexMask);
+        return value;
+    }
+
+private:
+    static const int kIndexBits = 16;
+    static const uint32_t kIndexMask = (1u << kIndexBits) - 1;
+    static const uint32_t kMaxGeneration = (1u << (31 - kIndexBits)) - 1;
+
+    struct Slot {
+        uint32_t generation = 1;
+        std::unique_ptr<T> value;
+    };
+
+    Slot* Find(int32_t handle) {
+        if (handle <= 0)
+            return nullptr;
+        uint32_t index = handle & kIndexMask;
+        if (index >= slots_.size())
+            return nullptr;
+        Slot& slot = slots_[index];
+        if (!slot.value || slot.generation != (uint32_t(handle) >> kIndexBits))
+            return nullptr;
+        return &slot;
+    }
+
+    std::mutex mutex_;
+    std::vector<Slot> slots_;
+    std::vector<uint32_t> free_;
+};
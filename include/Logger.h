@@ -1,27 +1,90 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <PmLog.h>
-
-extern pmlog::PmLog appLog;
-
-#define AppLogDebug() appLog.debug()
-#define AppLogInfo() appLog.info()
-#define AppLogWarning() appLog.warning()
-#define AppLogError() appLog.error()
-#define AppLogCritical() appLog.critical()
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <PmLog.h>
+#include <atomic>
+#include <chrono>
+
+extern pmlog::PmLog appLog;
+
+#define AppLogDebug() appLog.debug()
+#define AppLogInfo() appLog.info()
+#define AppLogWarning() appLog.warning()
+#define AppLogError() appLog.error()
+#define AppLogCritical() appLog.critical()
+
+// Leveled logging for hot paths.
+//
+//   AppLogHot(Debug) << "read " << size << " bytes";
+//   AppLogHotRateLimited(Error, 1000) << "Failed I2C_SMBUS";
+//
+// A statement below APP_LOG_MIN_LEVEL is removed at compile time; one below
+// the runtime level (PERIPHERALMANAGER_LOG_LEVEL, see Logger.cpp) costs a
+// single compare. In both cases the streamed arguments are not evaluated.
+// The macros expand to a single-pass for statement, which is safe under an
+// if without braces and cannot capture a following else.
+#define APP_LOG_LEVEL_Debug    0
+#define APP_LOG_LEVEL_Info     1
+#define APP_LOG_LEVEL_Warning  2
+#define APP_LOG_LEVEL_Error    3
+#define APP_LOG_LEVEL_Critical 4
+
+#ifndef APP_LOG_MIN_LEVEL
+#define APP_LOG_MIN_LEVEL APP_LOG_LEVEL_Debug
+#endif
+
+extern int appLogLevel;
+
+inline void AppLogSetLevel(int level) { appLogLevel = level; }
+
+#define AppLogEnabled(level) \
+    (APP_LOG_LEVEL_##level >= APP_LOG_MIN_LEVEL && \
+     APP_LOG_LEVEL_##level >= appLogLevel)
+
+#define AppLogHot(level) \
+    for (bool app_log_once = AppLogEnabled(level); app_log_once; app_log_once = false) \
+        AppLog##level()
+
+// Lets at most one message through per |interval_ms| for each call site.
+class AppLogRateLimiter {
+public:
+    explicit AppLogRateLimiter(int64_t interval_ms)
+        : interval_ms_(interval_ms), next_ms_(0) {}
+
+    bool Allow() {
+        int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = next_ms_.load(std::memory_order_relaxed);
+        return now >= next &&
+                next_ms_.compare_exchange_strong(next, now + interval_ms_,
+                        std::memory_order_relaxed);
+    }
+
+private:
+    const int64_t interval_ms_;
+    std::atomic<int64_t> next_ms_;
+};
+
+#define AppLogHotRateLimited(level, interval_ms) \
+    for (bool app_log_once = AppLogEnabled(level) && \
+            []() { \
+                static AppLogRateLimiter limiter(interval_ms); \
+                return limiter.Allow(); \
+            }(); \
+            app_log_once; app_log_once = false) \
+        AppLog##level()
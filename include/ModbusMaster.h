@@ -0,0 +1,142 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "UartDriver.h"
+
+// Outcome of one Modbus transaction.
+enum class ModbusError {
+    kNone,
+    // No complete reply within the response timeout.
+    kTimeout,
+    kCrc,
+    // A reply from another unit or not matching the request.
+    kInvalidReply,
+    // The slave answered with an exception code.
+    kException,
+    kIo,
+    // The master stopped before the request ran.
+    kStopped,
+};
+
+const char* ModbusErrorText(ModbusError error);
+
+struct ModbusResult {
+    ModbusError error;
+    uint8_t exception_code;
+    std::vector<uint16_t> registers;
+};
+
+// Modbus RTU master on one UART. Requests run in order on a thread of its
+// own, which times the 3.5 character silence between frames and the end
+// of each reply, so Luna round trips add no jitter on the wire. Register
+// blocks can be polled on a schedule in between; their last values are
+// cached and read without touching the bus.
+class ModbusMaster {
+public:
+    typedef std::function<void(const ModbusResult&)> Callback;
+
+    static const uint16_t kMaxReadRegisters = 125;
+    static const uint16_t kMaxWriteRegisters = 123;
+
+    // |driver| must outlive the master.
+    ModbusMaster(UartDriverInterface* driver, int response_timeout_ms);
+    // Wakes the master thread out of any wait on the bus and fails the
+    // request in flight and those still queued with kStopped.
+    ~ModbusMaster();
+
+    // Function 0x03. |done| runs on the master thread.
+    void ReadHoldingRegisters(uint8_t unit, uint16_t address, uint16_t count,
+            Callback done);
+    // Function 0x06 for a single value, 0x10 for more.
+    void WriteRegisters(uint8_t unit, uint16_t address,
+            const std::vector<uint16_t>& values, Callback done);
+
+    // Reads the block every |interval_ms| and returns the poll's id.
+    uint32_t AddPoll(uint8_t unit, uint16_t address, uint16_t count,
+            uint32_t interval_ms);
+    bool RemovePoll(uint32_t id);
+    // Copies the range out of a polled block holding it. Returns false if
+    // none does or it has not been read yet.
+    bool GetCachedRegisters(uint8_t unit, uint16_t address, uint16_t count,
+            std::vector<uint16_t>* values, uint64_t* age_ms);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Request {
+        uint8_t unit;
+        uint8_t function;
+        // Request frame without the CRC.
+        std::vector<uint8_t> frame;
+        // Expected reply size with the CRC.
+        size_t reply_size;
+        Callback done;
+    };
+
+    struct Poll {
+        uint8_t unit;
+        uint16_t address;
+        uint16_t count;
+        std::chrono::milliseconds interval;
+        Clock::time_point due;
+        bool valid;
+        Clock::time_point updated;
+        std::vector<uint16_t> registers;
+    };
+
+    static Request ReadRequest(uint8_t unit, uint16_t address, uint16_t count);
+    void Queue(Request request);
+    void Run();
+    ModbusResult Transact(const Request& request);
+    bool ReceiveReply(const Request& request, std::vector<uint8_t>* reply);
+    ModbusResult ParseReply(const Request& request, std::vector<uint8_t>* reply);
+    void UpdateTiming();
+    // Waits for |fd| to turn readable until |until|, or only for the time
+    // with -1. Returns false on timeout and once the master is stopping.
+    bool Wait(int fd, Clock::time_point until);
+
+    UartDriverInterface* driver_;
+    const std::chrono::milliseconds response_timeout_;
+
+    // Owned by the master thread.
+    std::chrono::microseconds char_time_;
+    std::chrono::microseconds frame_gap_;
+    Clock::time_point bus_idle_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<Request> requests_;
+    std::map<uint32_t, Poll> polls_;
+    uint32_t next_poll_id_;
+    bool stop_;
+    // The destructor sets |stopping_| and signals |stop_fd_|, an eventfd
+    // every wait of the master thread polls as well.
+    std::atomic<bool> stopping_;
+    int stop_fd_;
+    std::thread thread_;
+};
@@ -1,92 +1,283 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <config.h>
-#include <glib.h>
-#include <luna-service2++/handle.hpp>
-#include <memory>
-#include <unordered_map>
-#include <list>
-#include "Logger.h"
-#include "PeripheralManagerClient.h"
-
-
-class PeripheralManagerService {
-public:
-    PeripheralManagerService(LS::Handle *ls_handle);
-    virtual ~PeripheralManagerService();
-
-    // run function should block
-    void run();
-    void registerMethodsToLsHub();
-
-    // some sort of stop should be there, so that it can be stopped
-    // may be this should be static
-    void stop();
-
-    // Actual CallBack Methods
-    bool ListGpio(LSMessage &ls_message);
-    bool OpenGpio(LSMessage &ls_message);
-    bool ReleaseGpio(LSMessage &ls_message);
-    bool SetGpioDirection(LSMessage &ls_message);
-    bool SetGpioValue(LSMessage &ls_message);
-    bool GetGpioValue(LSMessage &ls_message);
-    bool GetGpioPollingFd(LSMessage &ls_message);
-    bool ListUartDevices(LSMessage &ls_message);
-    bool OpenUartDevice(LSMessage &ls_message);
-    bool ReleaseUartDevice(LSMessage &ls_message);
-    bool SetUartDeviceBaudrate(LSMessage &ls_message);
-    bool UartDeviceWrite(LSMessage &ls_message);
-    bool UartDeviceRead(LSMessage &ls_message);
-    bool getBaudrate(LSMessage &ls_message);
-    bool getDirection(LSMessage &ls_message);
-    bool GetuartPollingFd(LSMessage &ls_message);
-    bool ListI2cBuses(LSMessage &ls_message);
-    bool OpenI2cDevice(LSMessage &ls_message);
-    bool ReleaseI2cDevice(LSMessage &ls_message);
-    bool I2cRead(LSMessage &ls_message);
-    bool I2cReadRegByte(LSMessage &ls_message);
-    bool I2cReadRegWord(LSMessage &ls_message);
-    bool I2cReadRegBuffer(LSMessage &ls_message);
-    bool I2cWrite(LSMessage &ls_message);
-    bool I2cWriteRegByte(LSMessage &ls_message);
-    bool I2cWriteRegWord(LSMessage &ls_message);
-    bool I2cWriteRegBuffer(LSMessage &ls_message);
-    bool ListSpiBuses(LSMessage &ls_message);
-    bool OpenSpiDevice(LSMessage &ls_message);
-    bool ReleaseSpiDevice(LSMessage &ls_message);
-    bool SpiDeviceWriteByte(LSMessage &ls_message);
-    bool SpiDeviceWriteBuffer(LSMessage &ls_message);
-    bool SpiDeviceTransfer(LSMessage &ls_message);
-    bool SpiDeviceSetMode(LSMessage &ls_message);
-    bool SpiDeviceSetFrequency(LSMessage &ls_message);
-    bool SpiDeviceSetBitJustification(LSMessage &ls_message);
-    bool SpiDeviceSetBitsPerWord(LSMessage &ls_message);
-    bool SpiDeviceSetDelay(LSMessage &ls_message);
-    bool Geti2cPollingFd(LSMessage &ls_message);
-
-    void subscribeLoraReceive();
-    static bool receiveCallback(LSHandle *sh, LSMessage *reply, void *ctx);
-private:
-    using MainLoopT = std::unique_ptr<GMainLoop, void (*)(GMainLoop *)>;
-    MainLoopT main_loop_ptr;
-    std::list<LS::Call> callObjects;
-    PeripheralManagerClient *peripheral_manager_client;
-    LS::Handle *luna_handle;
-    std::list<LS::Message> getTimeClients;
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <config.h>
+#include <glib.h>
+#include <luna-service2++/handle.hpp>
+#include <memory>
+#include <unordered_map>
+#include <map>
+#include <list>
+#include <functional>
+#include "Logger.h"
+#include "BusWorker.h"
+#include "DataStream.h"
+#include "SharedRing.h"
+#include "PeripheralManagerClient.h"
+
+
+class PeripheralManagerService {
+public:
+    PeripheralManagerService(LS::Handle *ls_handle);
+    virtual ~PeripheralManagerService();
+
+    // run function should block
+    void run();
+    void registerMethodsToLsHub();
+
+    // some sort of stop should be there, so that it can be stopped
+    // may be this should be static
+    void stop();
+
+    // Actual CallBack Methods
+    bool ListGpio(LSMessage &ls_message);
+    bool OpenGpio(LSMessage &ls_message);
+    bool ReleaseGpio(LSMessage &ls_message);
+    bool SetGpioDirection(LSMessage &ls_message);
+    bool SetGpioValue(LSMessage &ls_message);
+    bool GetGpioValue(LSMessage &ls_message);
+    bool GetGpioPollingFd(LSMessage &ls_message);
+    bool SetGpioEdge(LSMessage &ls_message);
+    bool OpenGpioGroup(LSMessage &ls_message);
+    bool ReleaseGpioGroup(LSMessage &ls_message);
+    bool SetGpioValues(LSMessage &ls_message);
+    bool GetGpioValues(LSMessage &ls_message);
+    bool OpenGpioStream(LSMessage &ls_message);
+    bool CloseGpioStream(LSMessage &ls_message);
+    bool ListUartDevices(LSMessage &ls_message);
+    bool OpenUartDevice(LSMessage &ls_message);
+    bool ReleaseUartDevice(LSMessage &ls_message);
+    bool SetUartDeviceBaudrate(LSMessage &ls_message);
+    bool UartDeviceWrite(LSMessage &ls_message);
+    bool UartDeviceRead(LSMessage &ls_message);
+    bool UartDeviceTransact(LSMessage &ls_message);
+    bool getBaudrate(LSMessage &ls_message);
+    bool GetUartReaderStats(LSMessage &ls_message);
+    bool OpenUartStream(LSMessage &ls_message);
+    bool CloseUartStream(LSMessage &ls_message);
+    bool OpenModbus(LSMessage &ls_message);
+    bool CloseModbus(LSMessage &ls_message);
+    bool ModbusReadHoldingRegisters(LSMessage &ls_message);
+    bool ModbusWriteRegisters(LSMessage &ls_message);
+    bool AddModbusPoll(LSMessage &ls_message);
+    bool RemoveModbusPoll(LSMessage &ls_message);
+    bool getDirection(LSMessage &ls_message);
+    bool GetuartPollingFd(LSMessage &ls_message);
+    bool ListI2cBuses(LSMessage &ls_message);
+    bool OpenI2cDevice(LSMessage &ls_message);
+    bool ReleaseI2cDevice(LSMessage &ls_message);
+    bool I2cRead(LSMessage &ls_message);
+    bool I2cReadRegByte(LSMessage &ls_message);
+    bool I2cReadRegWord(LSMessage &ls_message);
+    bool I2cReadRegBuffer(LSMessage &ls_message);
+    bool I2cWrite(LSMessage &ls_message);
+    bool I2cWriteRegByte(LSMessage &ls_message);
+    bool I2cWriteRegWord(LSMessage &ls_message);
+    bool I2cWriteRegBuffer(LSMessage &ls_message);
+    bool I2cTransfer(LSMessage &ls_message);
+    bool ListSpiBuses(LSMessage &ls_message);
+    bool OpenSpiDevice(LSMessage &ls_message);
+    bool ReleaseSpiDevice(LSMessage &ls_message);
+    bool SpiDeviceWriteByte(LSMessage &ls_message);
+    bool SpiDeviceWriteBuffer(LSMessage &ls_message);
+    bool SpiDeviceTransfer(LSMessage &ls_message);
+    bool SpiDeviceTransferMulti(LSMessage &ls_message);
+    bool SpiDeviceSetMode(LSMessage &ls_message);
+    bool SpiDeviceSetFrequency(LSMessage &ls_message);
+    bool SpiDeviceSetBitJustification(LSMessage &ls_message);
+    bool SpiDeviceSetBitsPerWord(LSMessage &ls_message);
+    bool SpiDeviceSetDelay(LSMessage &ls_message);
+    bool OpenSpiStream(LSMessage &ls_message);
+    bool CloseSpiStream(LSMessage &ls_message);
+    bool Geti2cPollingFd(LSMessage &ls_message);
+    bool Batch(LSMessage &ls_message);
+
+    void subscribeLoraReceive();
+    static bool receiveCallback(LSHandle *sh, LSMessage *reply, void *ctx);
+private:
+    // Pushes gpio/getValue subscription updates for one pin, driven by a
+    // GIOChannel watch on the pin's edge fd.
+    struct GpioEdgeWatch {
+        PeripheralManagerService *service;
+        PeripheralManagerClient *client;
+        std::string pin;
+        guint source_id;
+    };
+    static gboolean gpioEdgeCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    bool startGpioEdgeWatch(PeripheralManagerClient *client, const std::string &pin);
+    void stopGpioEdgeWatch(PeripheralManagerClient *client, const std::string &pin);
+    void stopGpioEdgeWatch(const std::string &pin);
+    bool onGpioEdge(GpioEdgeWatch *watch);
+    std::map<std::string, std::unique_ptr<GpioEdgeWatch>> gpioEdgeWatches;
+
+    // Pushes uart/read subscription updates for one device, driven by a
+    // GIOChannel watch on its polling fd. Bytes are coalesced until
+    // |threshold| of them arrived or |window_ms| passed since the first.
+    struct UartReadWatch {
+        PeripheralManagerService *service;
+        PeripheralManagerClient *client;
+        std::string interfaceId;
+        guint source_id;
+        guint timer_id;
+        guint window_ms;
+        size_t threshold;
+        std::vector<uint8_t> pending;
+    };
+    static gboolean uartReadCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    static gboolean uartFlushCallback(gpointer data);
+    bool startUartReadWatch(PeripheralManagerClient *client, const std::string &interfaceId, guint window_ms, size_t threshold);
+    void stopUartReadWatch(const std::string &interfaceId);
+    bool onUartReadable(UartReadWatch *watch, GIOCondition condition);
+    bool flushUartRead(UartReadWatch *watch);
+    std::map<std::string, std::unique_ptr<UartReadWatch>> uartReadWatches;
+
+    // One uart/transact waiting for its reply on the device's polling fd.
+    // It is complete once |terminator| or |size| bytes arrived, or a frame
+    // on a framed device, and times out after |timeout_ms|. |discarded|
+    // counts bytes read along with the reply but past its end.
+    struct UartTransaction {
+        PeripheralManagerService *service;
+        PeripheralManagerClient *client;
+        std::string interfaceId;
+        LS::Message request;
+        std::vector<uint8_t> terminator;
+        size_t size;
+        std::string dataType;
+        std::string encoding;
+        guint source_id;
+        guint timer_id;
+        std::vector<uint8_t> reply;
+        size_t discarded;
+    };
+    static gboolean uartTransactCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    static gboolean uartTransactTimeoutCallback(gpointer data);
+    bool startUartTransaction(std::unique_ptr<UartTransaction> transaction, guint timeout_ms);
+    void finishUartTransaction(const std::string &interfaceId, const pbnjson::JValue &response);
+    bool onUartTransactReadable(UartTransaction *transaction, GIOCondition condition);
+    pbnjson::JValue uartTransactResponse(UartTransaction *transaction, bool timed_out);
+    std::map<std::string, std::unique_ptr<UartTransaction>> uartTransactions;
+
+    // Pushes uart/list subscription updates as USB serial devices come
+    // and go.
+    static gboolean uartHotplugCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    void startUartHotplugWatch();
+
+    // Moves raw frames between a DataStream socket and one UART or SPI
+    // device. UART bytes are pushed as they arrive and data frames from the
+    // peer are written out; on SPI every data frame is a transfer whose rx
+    // bytes come back under the same sequence number. With a |ring|, UART
+    // bytes and GPIO edges go through shared memory instead and the socket
+    // only hands the ring over. A peer must open with a hello carrying
+    // |token| before it gets or sends anything.
+    struct StreamWatch {
+        PeripheralManagerService *service;
+        PeripheralManagerClient *client;
+        std::string key;
+        std::string kind;
+        std::string device;
+        std::shared_ptr<DataStream> stream;
+        std::shared_ptr<SharedRing> ring;
+        std::string token;
+        bool authenticated;
+        uid_t peer_uid;
+        guint listen_id;
+        guint peer_id;
+        guint device_id;
+        uint32_t sequence;
+    };
+    static gboolean streamAcceptCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    static gboolean streamPeerCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    static gboolean streamDeviceCallback(GIOChannel *channel, GIOCondition condition, gpointer data);
+    bool startStream(PeripheralManagerClient *client, const std::string &kind, const std::string &device,
+            size_t ring_size, std::string *path, std::string *token);
+    bool stopStream(PeripheralManagerClient *client, const std::string &key);
+    void stopStream(const std::string &key);
+    void dropStreamPeer(StreamWatch *watch);
+    bool acceptStreamPeer(StreamWatch *watch, const StreamFrameHeader &header, const std::vector<uint8_t> &payload);
+    bool onStreamFrame(StreamWatch *watch);
+    bool onStreamDeviceReadable(StreamWatch *watch, GIOCondition condition);
+    std::map<std::string, std::unique_ptr<StreamWatch>> streams;
+
+    // One /batch/execute operation: the method it stands for, its required
+    // params in "name/address" form and the code that runs it.
+    struct BatchOperation {
+        const char *method;
+        const char *required;
+        pbnjson::JValue (*run)(PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params);
+    };
+    static const BatchOperation kBatchOperations[];
+    pbnjson::JValue runBatchOperation(PeripheralManagerClient *client, const pbnjson::JValue &operation);
+    std::string batchBusKey(PeripheralManagerClient *client, const pbnjson::JValue &operation);
+
+    // A /batch/execute request in progress. A run of I2C or SPI operations
+    // on one bus goes to that bus's worker as a whole; the other operations
+    // run on the main loop, which picks the batch up after each run.
+    struct BatchRun {
+        PeripheralManagerService *service;
+        PeripheralManagerClient *client;
+        LS::Message request;
+        pbnjson::JValue operations;
+        bool stop_on_error;
+        int next;
+        int failed;
+        bool stopped;
+        pbnjson::JValue results;
+    };
+    static void addBatchResult(BatchRun *run, const pbnjson::JValue &result);
+    static gboolean batchContinueCallback(gpointer data);
+    void continueBatch(BatchRun *run);
+
+    // I2C and SPI requests run on a worker per physical bus so a slow
+    // transaction does not stall the main loop. The reply is sent from the
+    // main loop once the worker is done.
+    struct DeferredReply {
+        LS::Message request;
+        std::string payload;
+    };
+    static gboolean deferredReplyCallback(gpointer data);
+    // Answers |ls_message| from the main loop once the Modbus thread is done.
+    ModbusMaster::Callback modbusReply(LSMessage &ls_message);
+    BusWorker *busWorker(const std::string &bus);
+    std::string i2cWorkerKey(PeripheralManagerClient *client, int32_t handle, const std::string &name);
+    std::string spiWorkerKey(PeripheralManagerClient *client, int32_t handle, const std::string &name);
+    void respondOnBus(const std::string &bus, LSMessage &ls_message, std::function<pbnjson::JValue()> work);
+    void scanI2cBuses(PeripheralManagerClient *client, const std::vector<std::string> &names, LSMessage &ls_message);
+    std::map<std::string, std::unique_ptr<BusWorker>> busWorkers;
+
+    // Devices opened by one Luna sender live in a client of their own, so
+    // everything an app opened is released as soon as the hub reports it
+    // gone instead of staying busy until the service restarts.
+    struct Session {
+        PeripheralManagerService *service;
+        std::string sender;
+        void *status_cookie;
+        std::unique_ptr<PeripheralManagerClient> client;
+    };
+    static bool senderStatusCallback(LSHandle *sh, const char *service_name, bool connected, void *ctx);
+    static gboolean endSessionCallback(gpointer data);
+    static gboolean deleteClientCallback(gpointer data);
+    PeripheralManagerClient *session(LSMessage &ls_message);
+    void endSession(const std::string &sender);
+    std::map<std::string, std::unique_ptr<Session>> sessions;
+
+    using MainLoopT = std::unique_ptr<GMainLoop, void (*)(GMainLoop *)>;
+    MainLoopT main_loop_ptr;
+    std::list<LS::Call> callObjects;
+    LS::Handle *luna_handle;
+    std::list<LS::Message> getTimeClients;
+};
@@ -1,186 +1,378 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <map>
-#include <memory>
-#include <string>
-#include "Logger.h"
-#include <list>
-#include <vector>
-#include <bits/stdc++.h>
-#include "GpioManager.h"
-#include "I2cManager.h"
-#include "SpiManager.h"
-#include "UartManager.h"
-
-using namespace std;
-
-typedef void Status;
-
-struct DevicesPinInfo {
-    std::string name;
-    std::string status;
-};
-class PeripheralManagerClient {
-public:
-    PeripheralManagerClient();
-    ~PeripheralManagerClient();
-
-    // Gpio functions.
-    Status ListGpio(std::vector<DevicesPinInfo>& gpios) ;
-
-    bool OpenGpio(const std::string& name) ;
-
-    bool  ReleaseGpio(const std::string& name) ;
-
-    bool  SetGpioDirection(const std::string& name,
-            int direction) ;
-
-    bool  SetGpioValue(const std::string& name, bool value) ;
-
-    bool  GetGpioValue(const std::string& name, bool* value) ;
-    int  GetGpioPollingFd(const std::string& name,
-            int* fd) ;
-    bool  getDirection(const std::string& name,
-            std::string& direction) ;
-    // Spi functions.
-    Status ListSpiBuses(std::vector<std::string>* buses) ;
-
-    Status OpenSpiDevice(const std::string& name) ;
-
-    Status ReleaseSpiDevice(const std::string& name) ;
-
-    Status SpiDeviceWriteByte(const std::string& name,
-            int8_t byte) ;
-
-    Status SpiDeviceWriteBuffer(
-            const std::string& name,
-            const std::vector<uint8_t>& buffer) ;
-
-    Status SpiDeviceTransfer(
-            const std::string& name,
-            std::vector<uint8_t>& tx_data,
-            std::vector<uint8_t>* rx_data,
-            int size);
-
-    Status SpiDeviceSetMode(const std::string& name, int mode) ;
-
-    Status SpiDeviceSetFrequency(const std::string& name,
-            int frequency_hz) ;
-
-    Status SpiDeviceSetBitJustification(const std::string& name,
-            bool lsb_first) ;
-
-    Status SpiDeviceSetBitsPerWord(const std::string& name,
-            int nbits) ;
-
-    Status SpiDeviceSetDelay(const std::string& name,
-            int delay_usecs) ;
-    // I2c functions.
-    Status ListI2cBuses(pbnjson::JValue& list,
-            bool verbose) ;
-
-    Status OpenI2cDevice(const std::string& name,
-            int32_t address) ;
-
-    Status ReleaseI2cDevice(const std::string& name,
-            int32_t address) ;
-
-    Status I2cRead(const std::string& name,
-            int32_t address,
-            std::vector<uint8_t>* data,
-            int32_t size,
-            int32_t* bytes_read) ;
-
-    Status I2cReadRegByte(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            int32_t* val) ;
-
-    Status I2cReadRegWord(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            int32_t* val) ;
-
-    Status I2cReadRegBuffer(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            std::vector<uint8_t>* data,
-            int32_t size,
-            int32_t* bytes_read) ;
-
-    Status I2cWrite(const std::string& name,
-            int32_t address,
-            const std::vector<uint8_t>& data,
-            int32_t* bytes_written) ;
-
-    Status I2cWriteRegByte(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            int8_t val) ;
-
-    Status I2cWriteRegWord(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            int32_t val) ;
-
-    Status I2cWriteRegBuffer(const std::string& name,
-            int32_t address,
-            int32_t reg,
-            const std::vector<uint8_t>& data,
-            int32_t* bytes_written) ;
-    int Geti2cPollingFd(const std::string& name,
-            int32_t address,
-            int* fd);
-
-    // Uart functions.
-    Status ListUartDevices(std::vector<DevicesPinInfo>& devices);
-
-    Status OpenUartDevice(const std::string& name, bool canonical = false);
-
-    bool ReleaseUartDevice(const std::string& name);
-
-    bool SetUartDeviceBaudrate(const std::string& name,
-            int32_t baudrate);
-
-    bool UartDeviceWrite(const std::string& name,
-            const std::vector<uint8_t>& data,
-            int* bytes_written);
-
-    bool UartDeviceRead(const std::string& name,
-            std::vector<uint8_t>* data,
-            int size,
-            int* bytes_read);
-    int32_t getBaudrate(const std::string& name,
-            uint32_t* baudrate);
-    int  GetuartPollingFd(const std::string& name,
-            int* fd) ;
-
-private:
-    std::map<std::string, std::unique_ptr<GpioPin>> gpios_;
-    std::map<std::pair<std::string, uint32_t>, std::unique_ptr<I2cDevice>>
-    i2c_devices_;
-    std::map<std::string, std::unique_ptr<SpiDevice>> spi_devices_;
-    std::map<std::string, std::unique_ptr<UartDevice>> uart_devices_;
-};
-
-class test {
-public:
-    map<int, int> mp;
-    void add(void);
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include "Logger.h"
+#include "HandleTable.h"
+#include <list>
+#include <vector>
+#include <bits/stdc++.h>
+#include "GpioManager.h"
+#include "I2cManager.h"
+#include "SpiManager.h"
+#include "UartManager.h"
+#include "PeripheralManagerException.h"
+
+using namespace std;
+
+// Result of the client calls that report failure by value: kNoError, or the
+// error the Luna reply carries. Routine failures such as a closed handle do
+// not throw, since clients can hit them on every request.
+typedef PeripheralManagerErrors Status;
+
+struct DevicesPinInfo {
+    std::string name;
+    std::string status;
+};
+class PeripheralManagerClient {
+public:
+    PeripheralManagerClient();
+    ~PeripheralManagerClient();
+
+    // Handles of the devices opened by name, 0 if the device is not open.
+    // The data-path calls below also take a handle, which skips the name
+    // lookup.
+    int32_t GetGpioHandle(const std::string& name);
+    int32_t GetI2cHandle(const std::string& name, uint32_t address);
+    int32_t GetSpiHandle(const std::string& name);
+    int32_t GetUartHandle(const std::string& name);
+    // Name a GPIO or UART handle was opened under, empty if it is not open.
+    std::string GetGpioName(int32_t handle);
+    std::string GetUartName(int32_t handle);
+
+    // Bus number of the controller behind an I2C or SPI handle.
+    bool GetI2cHandleBus(int32_t handle, uint32_t* bus);
+    bool GetSpiHandleBus(int32_t handle, uint32_t* bus);
+
+    // I2C and SPI devices still open, so that they can be released on
+    // their bus worker before the client is destroyed.
+    std::vector<std::pair<std::string, uint32_t>> GetOpenI2cDevices();
+    std::vector<std::string> GetOpenSpiDevices();
+
+    // Gpio functions.
+    Status ListGpio(std::vector<DevicesPinInfo>& gpios) ;
+
+    Status OpenGpio(const std::string& name, int32_t* handle = nullptr) ;
+
+    Status  ReleaseGpio(const std::string& name) ;
+
+    Status  SetGpioDirection(const std::string& name,
+            int direction) ;
+    Status  SetGpioDirection(int32_t handle, int direction) ;
+
+    Status  SetGpioValue(const std::string& name, bool value) ;
+    Status  SetGpioValue(int32_t handle, bool value) ;
+
+    Status  GetGpioValue(const std::string& name, bool* value) ;
+    Status  GetGpioValue(int32_t handle, bool* value) ;
+    Status  GetGpioPollingFd(const std::string& name,
+            int* fd) ;
+    Status  getDirection(const std::string& name,
+            std::string& direction) ;
+
+    Status  SetGpioEdge(const std::string& name, int edge) ;
+
+    Status  GetGpioEdgeFd(const std::string& name,
+            int* fd,
+            short* events) ;
+
+    bool  ReadGpioEdgeEvent(const std::string& name,
+            bool* value,
+            uint64_t* timestamp_ns) ;
+
+    // Bulk access. Bit i of |bits| and |mask| maps to the i-th pin.
+    Status  SetGpioValues(const std::vector<std::string>& names,
+            uint64_t bits,
+            uint64_t mask) ;
+
+    Status  GetGpioValues(const std::vector<std::string>& names,
+            uint64_t* bits) ;
+
+    Status  OpenGpioGroup(const std::string& group,
+            const std::vector<std::string>& names) ;
+
+    Status  ReleaseGpioGroup(const std::string& group) ;
+
+    Status  SetGpioGroupDirection(const std::string& group,
+            int direction) ;
+
+    Status  SetGpioGroupValues(const std::string& group,
+            uint64_t bits,
+            uint64_t mask) ;
+
+    Status  GetGpioGroupValues(const std::string& group,
+            uint64_t* bits) ;
+    // Spi functions.
+    Status ListSpiBuses(std::vector<std::string>* buses) ;
+
+    Status OpenSpiDevice(const std::string& name,
+            int32_t* handle = nullptr) ;
+
+    Status ReleaseSpiDevice(const std::string& name) ;
+
+    Status SpiDeviceWriteByte(const std::string& name,
+            int8_t byte) ;
+    Status SpiDeviceWriteByte(int32_t handle,
+            int8_t byte) ;
+
+    Status SpiDeviceWriteBuffer(
+            const std::string& name,
+            const std::vector<uint8_t>& buffer) ;
+    Status SpiDeviceWriteBuffer(
+            int32_t handle,
+            const std::vector<uint8_t>& buffer) ;
+
+    Status SpiDeviceTransfer(
+            const std::string& name,
+            std::vector<uint8_t>& tx_data,
+            std::vector<uint8_t>* rx_data,
+            int size);
+    Status SpiDeviceTransfer(
+            int32_t handle,
+            std::vector<uint8_t>& tx_data,
+            std::vector<uint8_t>* rx_data,
+            int size);
+
+    Status SpiDeviceTransferMulti(
+            const std::string& name,
+            std::vector<SpiSegment>* segments);
+    Status SpiDeviceTransferMulti(
+            int32_t handle,
+            std::vector<SpiSegment>* segments);
+
+    Status SpiDeviceSetMode(const std::string& name, int mode) ;
+
+    Status SpiDeviceSetFrequency(const std::string& name,
+            int frequency_hz) ;
+
+    Status SpiDeviceSetBitJustification(const std::string& name,
+            bool lsb_first) ;
+
+    Status SpiDeviceSetBitsPerWord(const std::string& name,
+            int nbits) ;
+
+    Status SpiDeviceSetDelay(const std::string& name,
+            int delay_usecs) ;
+    // I2c functions.
+    Status ListI2cBuses(pbnjson::JValue& list,
+            bool verbose) ;
+    // Buses a verbose list has to scan first; ScanI2cBus blocks on the bus.
+    std::vector<std::string> GetStaleI2cScans();
+    Status ScanI2cBus(const std::string& name);
+
+    Status OpenI2cDevice(const std::string& name,
+            int32_t address,
+            int32_t* handle = nullptr) ;
+
+    Status ReleaseI2cDevice(const std::string& name,
+            int32_t address) ;
+
+    Status I2cRead(const std::string& name,
+            int32_t address,
+            std::vector<uint8_t>* data,
+            int32_t size,
+            int32_t* bytes_read) ;
+    Status I2cRead(int32_t handle,
+            std::vector<uint8_t>* data,
+            int32_t size,
+            int32_t* bytes_read) ;
+
+    Status I2cReadRegByte(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            int32_t* val) ;
+    Status I2cReadRegByte(int32_t handle,
+            int32_t reg,
+            int32_t* val) ;
+
+    Status I2cReadRegWord(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            int32_t* val) ;
+    Status I2cReadRegWord(int32_t handle,
+            int32_t reg,
+            int32_t* val) ;
+
+    Status I2cReadRegBuffer(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            std::vector<uint8_t>* data,
+            int32_t size,
+            int32_t* bytes_read) ;
+    Status I2cReadRegBuffer(int32_t handle,
+            int32_t reg,
+            std::vector<uint8_t>* data,
+            int32_t size,
+            int32_t* bytes_read) ;
+
+    Status I2cWrite(const std::string& name,
+            int32_t address,
+            const std::vector<uint8_t>& data,
+            int32_t* bytes_written) ;
+    Status I2cWrite(int32_t handle,
+            const std::vector<uint8_t>& data,
+            int32_t* bytes_written) ;
+
+    Status I2cWriteRegByte(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            int8_t val) ;
+    Status I2cWriteRegByte(int32_t handle,
+            int32_t reg,
+            int8_t val) ;
+
+    Status I2cWriteRegWord(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            int32_t val) ;
+    Status I2cWriteRegWord(int32_t handle,
+            int32_t reg,
+            int32_t val) ;
+
+    Status I2cWriteRegBuffer(const std::string& name,
+            int32_t address,
+            int32_t reg,
+            const std::vector<uint8_t>& data,
+            int32_t* bytes_written) ;
+    Status I2cWriteRegBuffer(int32_t handle,
+            int32_t reg,
+            const std::vector<uint8_t>& data,
+            int32_t* bytes_written) ;
+    Status Geti2cPollingFd(const std::string& name,
+            int32_t address,
+            int* fd);
+
+    Status I2cTransfer(const std::string& name,
+            int32_t address,
+            std::vector<I2cMessage>* msgs) ;
+    Status I2cTransfer(int32_t handle,
+            std::vector<I2cMessage>* msgs) ;
+
+    // Uart functions.
+    Status ListUartDevices(std::vector<DevicesPinInfo>& devices);
+
+    // A non-zero |buffer_size| starts a background reader with a buffer of
+    // that many bytes.
+    Status OpenUartDevice(const std::string& name, bool canonical = false,
+            uint32_t buffer_size = 0, int32_t* handle = nullptr);
+
+    Status ReleaseUartDevice(const std::string& name);
+
+    Status SetUartDeviceBaudrate(const std::string& name,
+            int32_t baudrate);
+
+    Status UartDeviceWrite(const std::string& name,
+            const std::vector<uint8_t>& data,
+            int* bytes_written);
+    Status UartDeviceWrite(int32_t handle,
+            const std::vector<uint8_t>& data,
+            int* bytes_written);
+    // Drops the input received so far, before a request whose reply must
+    // not pick up older bytes.
+    Status UartDeviceFlushInput(int32_t handle);
+
+    Status UartDeviceRead(const std::string& name,
+            std::vector<uint8_t>* data,
+            int size,
+            int* bytes_read);
+    Status UartDeviceRead(int32_t handle,
+            std::vector<uint8_t>* data,
+            int size,
+            int* bytes_read);
+    Status getBaudrate(const std::string& name,
+            uint32_t* baudrate);
+    Status  GetuartPollingFd(const std::string& name,
+            int* fd) ;
+    Status GetUartReaderStats(const std::string& name,
+            UartReaderStats* stats);
+    // Has the device's background reader, started on demand, fill |sink|.
+    // A null |sink| detaches it again.
+    Status SetUartReaderSink(const std::string& name,
+            std::shared_ptr<SharedRing> sink);
+    // Cuts what the device receives into frames. A null |framer| goes
+    // back to raw bytes.
+    Status SetUartFramer(const std::string& name,
+            std::unique_ptr<UartFramer> framer);
+    // Null unless the device is open and framed.
+    UartFramer* GetUartFramer(const std::string& name);
+    UartFramer* GetUartFramer(int32_t handle);
+    // Hands the device to a Modbus RTU master. Until it stops, plain
+    // reads and writes of the device fail with kEBUSY.
+    Status StartUartModbus(const std::string& name, int response_timeout_ms);
+    Status StopUartModbus(const std::string& name);
+    // Null unless the device runs a Modbus master.
+    ModbusMaster* GetUartModbus(const std::string& name);
+
+private:
+    // I2C and SPI devices are used from the bus worker threads, so the
+    // name maps are only touched under |devices_mutex_|; the handle tables
+    // lock themselves. Requests for one bus are serialized by its worker,
+    // which keeps a looked up device alive.
+    GpioPin* FindGpio(const std::string& name);
+    I2cDevice* FindI2cDevice(const std::string& name, uint32_t address);
+    SpiDevice* FindSpiDevice(const std::string& name);
+    UartDevice* FindUartDevice(const std::string& name);
+
+    // Helpers for the name maps, called with |devices_mutex_| held.
+    template <typename Key>
+    int32_t LookupHandle(const std::map<Key, int32_t>& handles,
+            const Key& key) {
+        auto handle = handles.find(key);
+        return handle == handles.end() ? 0 : handle->second;
+    }
+
+    template <typename Key, typename T>
+    int32_t AddHandle(std::map<Key, int32_t>& handles, HandleTable<T>& table,
+            const Key& key, std::unique_ptr<T> value) {
+        int32_t handle = table.Add(std::move(value));
+        if (handle)
+            handles[key] = handle;
+        return handle;
+    }
+
+    template <typename Key, typename T>
+    bool RemoveHandle(std::map<Key, int32_t>& handles, HandleTable<T>& table,
+            const Key& key) {
+        auto handle = handles.find(key);
+        if (handle == handles.end())
+            return false;
+        table.Remove(handle->second);
+        handles.erase(handle);
+        return true;
+    }
+
+    std::mutex devices_mutex_;
+    HandleTable<GpioPin> gpios_;
+    std::map<std::string, int32_t> gpio_handles_;
+    std::map<std::string, std::unique_ptr<GpioGroup>> gpio_groups_;
+    HandleTable<I2cDevice> i2c_devices_;
+    std::map<std::pair<std::string, uint32_t>, int32_t> i2c_handles_;
+    HandleTable<SpiDevice> spi_devices_;
+    std::map<std::string, int32_t> spi_handles_;
+    HandleTable<UartDevice> uart_devices_;
+    std::map<std::string, int32_t> uart_handles_;
+};
+
+class test {
+public:
+    map<int, int> mp;
+    void add(void);
+};
@@ -0,0 +1,122 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <pbnjson.hpp>
+
+// JSON type a request property must have.
+enum class ParamType {
+    kAny,
+    kString,
+    kNumber,
+    kBoolean,
+    kArray,
+    kObject,
+};
+
+bool HasParamType(const pbnjson::JValue& value, ParamType type);
+
+// One request property as read by ReadParams(). |set| tells whether the
+// request had it.
+template <typename T>
+struct Param {
+    Param() : set(false), value() {}
+
+    bool set;
+    T value;
+};
+
+// One allowed property of a Luna method and the member of the method's
+// params struct |P| it is read into. Strings, numbers and booleans are
+// typed by their member; arrays, objects and properties of any type stay
+// JSON values. Each handler keeps a static table of these.
+template <typename P>
+struct ParamSpec {
+    ParamSpec(const char* key, Param<std::string> P::*field)
+    : key(key), type(ParamType::kString) { string_field = field; }
+    ParamSpec(const char* key, Param<int64_t> P::*field)
+    : key(key), type(ParamType::kNumber) { number_field = field; }
+    ParamSpec(const char* key, Param<bool> P::*field)
+    : key(key), type(ParamType::kBoolean) { boolean_field = field; }
+    ParamSpec(const char* key, Param<pbnjson::JValue> P::*field, ParamType type)
+    : key(key), type(type) { value_field = field; }
+
+    // Checks the type of |value| and stores it in |params|.
+    bool Read(const pbnjson::JValue& value, P* params) const {
+        if (!HasParamType(value, type))
+            return false;
+        switch (type) {
+        case ParamType::kString:
+            Store(&(params->*string_field), value.asString());
+            break;
+        case ParamType::kNumber:
+            Store(&(params->*number_field), value.asNumber<int64_t>());
+            break;
+        case ParamType::kBoolean:
+            Store(&(params->*boolean_field), value.asBool());
+            break;
+        default:
+            Store(&(params->*value_field), value);
+            break;
+        }
+        return true;
+    }
+
+    const char* key;
+    ParamType type;
+    union {
+        Param<std::string> P::*string_field;
+        Param<int64_t> P::*number_field;
+        Param<bool> P::*boolean_field;
+        Param<pbnjson::JValue> P::*value_field;
+    };
+
+private:
+    template <typename T>
+    static void Store(Param<T>* param, const T& value) {
+        param->set = true;
+        param->value = value;
+    }
+};
+
+// Checks every property of |request| against |specs| and reads it into
+// |params|, in a single pass. On failure |error| gets the errorText of
+// the reply.
+template <typename P, size_t N>
+bool ReadParams(const pbnjson::JValue& request, const ParamSpec<P> (&specs)[N], P* params,
+        std::string* error) {
+    for (auto member : request) {
+        // The key is converted once and then compared in place, instead of
+        // once per allowed name.
+        const std::string key = member.first.asString();
+        size_t i = 0;
+        while (i < N && key != specs[i].key)
+            i++;
+        if (i == N) {
+            *error = key + " property not allowed";
+            return false;
+        }
+        if (!specs[i].Read(member.second, params)) {
+            *error = key + " value not allowed";
+            return false;
+        }
+    }
+    return true;
+}
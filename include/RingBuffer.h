@@ -0,0 +1,86 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Fixed-size byte ring for one producer thread and one consumer thread.
+// The producer only moves tail_ and the consumer only moves head_, so
+// neither side takes a lock.
+class ByteRingBuffer {
+public:
+    // |capacity| is rounded up to a power of two.
+    explicit ByteRingBuffer(size_t capacity) : head_(0), tail_(0) {
+        size_t size = 1;
+        while (size < capacity)
+            size <<= 1;
+        buffer_.resize(size);
+        mask_ = size - 1;
+    }
+
+    size_t Capacity() const { return buffer_.size(); }
+
+    size_t Size() const {
+        // Load head first so that it can never pass the tail we compare to.
+        size_t head = head_.load(std::memory_order_acquire);
+        return tail_.load(std::memory_order_acquire) - head;
+    }
+
+    // Producer side. Returns how many bytes fitted.
+    size_t Push(const uint8_t* data, size_t size) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_acquire);
+        size = std::min(size, buffer_.size() - (tail - head));
+        CopyIn(tail, data, size);
+        tail_.store(tail + size, std::memory_order_release);
+        return size;
+    }
+
+    // Consumer side. Returns how many bytes were taken.
+    size_t Pop(uint8_t* data, size_t size) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size = std::min(size, tail - head);
+        CopyOut(head, data, size);
+        head_.store(head + size, std::memory_order_release);
+        return size;
+    }
+
+private:
+    void CopyIn(size_t pos, const uint8_t* data, size_t size) {
+        size_t offset = pos & mask_;
+        size_t first = std::min(size, buffer_.size() - offset);
+        memcpy(&buffer_[offset], data, first);
+        memcpy(&buffer_[0], data + first, size - first);
+    }
+
+    void CopyOut(size_t pos, uint8_t* data, size_t size) const {
+        size_t offset = pos & mask_;
+        size_t first = std::min(size, buffer_.size() - offset);
+        memcpy(data, &buffer_[offset], first);
+        memcpy(data + first, &buffer_[0], size - first);
+    }
+
+    std::vector<uint8_t> buffer_;
+    size_t mask_;
+    std::atomic<size_t> head_;
+    std::atomic<size_t> tail_;
+};
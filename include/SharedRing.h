@@ -0,0 +1,98 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <string>
+
+// Control block at the start of a shared ring's memfd. The data area of
+// |capacity| bytes follows at kSharedRingDataOffset. The producer only
+// moves |tail| and the consumer only moves |head|; each sits on a cache
+// line of its own.
+struct SharedRingControl {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    uint32_t reserved;
+    alignas(64) std::atomic<uint64_t> tail;
+    // Records the producer dropped because the consumer fell behind.
+    std::atomic<uint64_t> dropped;
+    alignas(64) std::atomic<uint64_t> head;
+};
+
+const uint32_t kSharedRingMagic = 0x50524e47;  // "PRNG"
+const uint32_t kSharedRingVersion = 2;
+const size_t kSharedRingDataOffset = 4096;
+
+// Every record in the data area is this header followed by |length|
+// payload bytes; either part may wrap around the end of the area.
+struct SharedRingRecordHeader {
+    uint32_t length;
+};
+
+// Single-producer record ring in a sealed memfd, shared with one client
+// process, with an eventfd signalled after every push. The service
+// creates it and hands both fds over; the client Attach()es to them.
+// Each Push() stores one length-framed record and each Pop() takes one
+// back whole, so record boundaries survive the ring.
+//
+// Push() never waits for the consumer, so it may run on the main loop:
+// gpio streams push from the edge watch there, uart streams from the
+// device's reader thread. Either way a ring has exactly one producer.
+class SharedRing {
+public:
+    // |capacity| is rounded up to a power of two.
+    static std::unique_ptr<SharedRing> Create(const std::string& name, size_t capacity);
+    // Maps a ring received from the service and takes over both fds.
+    static std::unique_ptr<SharedRing> Attach(int memfd, int event_fd);
+    ~SharedRing();
+
+    int MemFd() const { return memfd_; }
+    int EventFd() const { return eventfd_; }
+    size_t Capacity() const { return mask_ + 1; }
+    uint64_t Dropped() const;
+
+    // Producer side. Stores |data| as one record and returns true or, when
+    // it does not fit, drops it, counts it as dropped and returns false.
+    // An empty |data| stores nothing.
+    bool Push(const uint8_t* data, size_t size);
+    // Consumer side. Takes the oldest record and returns its length, or 0
+    // when the ring is empty. Like a datagram socket, a record longer than
+    // |size| is truncated to it; the returned length tells. A malformed
+    // header discards everything buffered.
+    size_t Pop(uint8_t* data, size_t size);
+
+private:
+    SharedRing(int memfd, int event_fd, void* map, size_t map_size);
+
+    // Copy between the data area at ring position |pos| and a flat buffer.
+    void CopyIn(uint64_t pos, const uint8_t* data, size_t size);
+    void CopyOut(uint64_t pos, uint8_t* data, size_t size) const;
+
+    int memfd_;
+    int eventfd_;
+    void* map_;
+    size_t map_size_;
+    SharedRingControl* control_;
+    uint8_t* data_;
+    size_t mask_;
+    // The producer's own tail; the copy in shared memory is only published
+    // to, since the client can write anything there.
+    uint64_t tail_;
+};
@@ -1,66 +1,91 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <stdint.h>
-
-#include <memory>
-#include <string>
-#include <vector>
-
-
-class UartDriverInterface {
-public:
-    virtual ~UartDriverInterface() {}
-
-    virtual bool Init(const std::string& name, bool canonical = false) = 0;
-
-    virtual int SetBaudrate(uint32_t baudrate) = 0;
-    virtual uint32_t getBaudrate(uint32_t* baudrate) = 0;
-
-    virtual int Write(const std::vector<uint8_t>& data,
-            uint32_t* bytes_written) = 0;
-
-    virtual int Read(std::vector<uint8_t>* data,
-            uint32_t size,
-            uint32_t* bytes_read) = 0;
-    virtual int  GetuPollingFd(int * fd) = 0;
-};
-
-class UartDriverInfoBase {
-public:
-    virtual ~UartDriverInfoBase() {}
-
-    virtual std::string Compat() = 0;
-    virtual std::unique_ptr<UartDriverInterface> Probe() = 0;
-};
-
-template <class T, class PARAM>
-class UartDriverInfo : public UartDriverInfoBase {
-public:
-    explicit UartDriverInfo(PARAM param) : param_(param) {}
-    ~UartDriverInfo() override {}
-
-    std::string Compat() override { return T::Compat(); }
-
-    std::unique_ptr<UartDriverInterface> Probe() override {
-        return std::unique_ptr<UartDriverInterface>(new T(param_));
-    }
-
-private:
-    PARAM param_;
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "SharedRing.h"
+
+
+// Counters of a background reader, see UartDriverInterface::StartReader.
+struct UartReaderStats {
+    uint32_t capacity;
+    uint32_t buffered;
+    uint64_t received;
+    // Bytes dropped because the buffer was full.
+    uint64_t overflow;
+};
+
+class UartDriverInterface {
+public:
+    virtual ~UartDriverInterface() {}
+
+    virtual bool Init(const std::string& name, bool canonical = false) = 0;
+
+    virtual int SetBaudrate(uint32_t baudrate) = 0;
+    virtual uint32_t getBaudrate(uint32_t* baudrate) = 0;
+
+    // Neither call blocks. Write may take fewer bytes than given, none
+    // while the output queue is full, and Read returns EAGAIN when nothing,
+    // or in canonical mode no complete line, is there yet.
+    virtual int Write(const std::vector<uint8_t>& data,
+            uint32_t* bytes_written) = 0;
+
+    virtual int Read(std::vector<uint8_t>* data,
+            uint32_t size,
+            uint32_t* bytes_read) = 0;
+    virtual int  GetuPollingFd(int * fd) = 0;
+    // Discards what was received but not read yet. Returns 0 or an errno.
+    virtual int FlushInput() { return ENOTSUP; }
+
+    // Optional background reader draining the device into a buffer of
+    // |buffer_size| bytes. While it runs, Read serves from that buffer and
+    // the polling fd becomes readable whenever it holds data.
+    virtual bool StartReader(uint32_t buffer_size) { return false; }
+    virtual bool GetReaderStats(UartReaderStats* stats) { return false; }
+    // Points the running background reader at a client's shared ring, or
+    // back at its own buffer when |sink| is null.
+    virtual bool SetReaderSink(std::shared_ptr<SharedRing> sink) { return false; }
+};
+
+class UartDriverInfoBase {
+public:
+    virtual ~UartDriverInfoBase() {}
+
+    virtual std::string Compat() = 0;
+    virtual std::unique_ptr<UartDriverInterface> Probe() = 0;
+};
+
+template <class T, class PARAM>
+class UartDriverInfo : public UartDriverInfoBase {
+public:
+    explicit UartDriverInfo(PARAM param) : param_(param) {}
+    ~UartDriverInfo() override {}
+
+    std::string Compat() override { return T::Compat(); }
+
+    std::unique_ptr<UartDriverInterface> Probe() override {
+        return std::unique_ptr<UartDriverInterface>(new T(param_));
+    }
+
+private:
+    PARAM param_;
+};
@@ -1,50 +1,82 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <stdint.h>
-#include "CharDevice.h"
-#include "UartDriver.h"
-#include "Logger.h"
-
-class UartDriverSysfs : public UartDriverInterface {
-public:
-    explicit UartDriverSysfs(CharDeviceFactory* factory);
-    ~UartDriverSysfs();
-
-    static std::string Compat() { return "UARTSYSFS"; }
-
-    bool Init(const std::string& name, bool canonical = false) override;
-
-    int SetBaudrate(uint32_t baudrate) override;
-    uint32_t getBaudrate(uint32_t* baudrate) override;
-
-    int Write(const std::vector<uint8_t>& data, uint32_t* bytes_written) override;
-
-    int Read(std::vector<uint8_t>* data,
-            uint32_t size,
-            uint32_t* bytes_read) override;
-    int  GetuPollingFd(int * fd) override;
-
-private:
-    int fd_;
-    std::string path_;
-
-    CharDeviceFactory* char_device_factory_;
-    std::unique_ptr<CharDeviceInterface> char_interface_;
-
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "CharDevice.h"
+#include "RingBuffer.h"
+#include "UartDriver.h"
+#include "Logger.h"
+
+class UartDriverSysfs : public UartDriverInterface {
+public:
+    explicit UartDriverSysfs(CharDeviceFactory* factory);
+    ~UartDriverSysfs();
+
+    static std::string Compat() { return "UARTSYSFS"; }
+
+    bool Init(const std::string& name, bool canonical = false) override;
+
+    int SetBaudrate(uint32_t baudrate) override;
+    uint32_t getBaudrate(uint32_t* baudrate) override;
+
+    int Write(const std::vector<uint8_t>& data, uint32_t* bytes_written) override;
+
+    int Read(std::vector<uint8_t>* data,
+            uint32_t size,
+            uint32_t* bytes_read) override;
+    int  GetuPollingFd(int * fd) override;
+    int FlushInput() override;
+
+    bool StartReader(uint32_t buffer_size) override;
+    bool GetReaderStats(UartReaderStats* stats) override;
+    bool SetReaderSink(std::shared_ptr<SharedRing> sink) override;
+
+private:
+    void ReaderLoop();
+    void StopReader();
+    // Marks the reader as stopped on a tty error and wakes data_fd_.
+    void FailReader(const char* reason);
+    // Rates outside the standard table, through termios2 and BOTHER.
+    int SetCustomBaudrate(uint32_t baudrate);
+
+    int fd_;
+    std::string path_;
+
+    // Background reader state, unused until StartReader.
+    std::unique_ptr<ByteRingBuffer> ring_;
+    std::thread reader_;
+    // eventfd waking the reader up for shutdown.
+    int stop_fd_;
+    // eventfd readable while ring_ holds data.
+    int data_fd_;
+    std::atomic<uint64_t> received_bytes_;
+    std::atomic<uint64_t> overflow_bytes_;
+    // Set once the reader stopped on a hangup or error; Read then reports
+    // EIO after the buffered bytes.
+    std::atomic<bool> reader_failed_;
+    // Shared ring the reader fills instead of ring_, swapped under the lock.
+    std::mutex sink_mutex_;
+    std::shared_ptr<SharedRing> sink_;
+
+    CharDeviceFactory* char_device_factory_;
+    std::unique_ptr<CharDeviceInterface> char_interface_;
+
+};
@@ -0,0 +1,87 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Framing of UART input, selected by the "framing" config of uart/open.
+const char kFramingDelimiter[] = "delimiter";
+const char kFramingLength[] = "length";
+const char kFramingCobs[] = "cobs";
+const char kFramingSlip[] = "slip";
+
+struct UartFramerConfig {
+    std::string type;
+    // "delimiter": the byte ending a frame, and whether it stays in it.
+    uint8_t delimiter;
+    bool keep_delimiter;
+    // "length": size and byte order of the prefix counting the bytes after it.
+    size_t length_bytes;
+    bool big_endian;
+    // Longest frame accepted, checksum included. Longer ones are dropped.
+    size_t max_length;
+    // Checksum at the end of every frame, verified and stripped. Empty for none.
+    std::string checksum;
+
+    UartFramerConfig()
+    : delimiter('\n'), keep_delimiter(false), length_bytes(1), big_endian(true),
+      max_length(4096) {}
+};
+
+// Cuts the bytes a UART receives into frames. Input may be split anywhere;
+// partial frames are kept until the rest arrives. Malformed, oversized
+// and checksum failing frames are dropped and counted.
+class UartFramer {
+public:
+    typedef std::vector<std::vector<uint8_t>> Frames;
+
+    // Returns null if |config| is not valid.
+    static std::unique_ptr<UartFramer> Create(const UartFramerConfig& config);
+    virtual ~UartFramer() {}
+
+    // Appends every frame completed by |data| to |frames|.
+    void Feed(const uint8_t* data, size_t size, Frames* frames);
+
+    const UartFramerConfig& Config() const { return config_; }
+    uint64_t FrameCount() const { return frame_count_; }
+    uint64_t DroppedCount() const { return dropped_count_; }
+
+protected:
+    explicit UartFramer(const UartFramerConfig& config)
+    : config_(config), frame_count_(0), dropped_count_(0) {}
+
+    // Appends the raw frames completed by |data|, checksum still attached.
+    virtual void Decode(const uint8_t* data, size_t size, Frames* frames) = 0;
+
+    void Drop() { dropped_count_++; }
+
+    const UartFramerConfig config_;
+
+private:
+    uint64_t frame_count_;
+    uint64_t dropped_count_;
+};
+
+// Appends |data| to the |reply| of a uart/transact that ends after
+// |terminator| or at |reply_size| bytes; either may be unset (empty or 0). A
+// terminator split across two reads is still found. The reply is cut right
+// after the terminator or at |reply_size|. Returns true once it is complete.
+bool AppendUartReply(const uint8_t* data, size_t size, const std::vector<uint8_t>& terminator,
+        size_t reply_size, std::vector<uint8_t>* reply);
@@ -1,92 +1,201 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#pragma once
-
-#include <stdint.h>
-#include <map>
-#include <memory>
-#include <string>
-#include <vector>
-#include "UartDriver.h"
-#include "Logger.h"
-#include "PinmuxManager.h"
-
-struct UartSysfs {
-    std::string name;
-    std::string path;
-    std::string mux;
-    std::unique_ptr<UartDriverInterface> driver_;
-};
-
-class UartDevice {
-public:
-    explicit UartDevice(UartSysfs* uart_device) : uart_device_(uart_device) {}
-    ~UartDevice() {
-        if (!uart_device_->mux.empty()) {
-            PinMuxManager::GetPinMuxManager()->ReleaseSource(uart_device_->mux,uart_device_->mux);
-        }
-        uart_device_->driver_.reset();
-    }
-
-    int SetBaudrate(uint32_t baudrate) {
-        return uart_device_->driver_->SetBaudrate(baudrate);
-    }
-    uint32_t getBaudrate(uint32_t* baudrate){
-        return uart_device_->driver_->getBaudrate(baudrate);
-    }
-
-    int Write(const std::vector<uint8_t>& data, uint32_t* bytes_written) {
-        return uart_device_->driver_->Write(data, bytes_written);
-    }
-
-    int Read(std::vector<uint8_t>* data, uint32_t size, uint32_t* bytes_read) {
-        return uart_device_->driver_->Read(data, size, bytes_read);
-    }
-    bool GetuPollingFd(int* fd) {
-        return uart_device_->driver_->GetuPollingFd(fd);
-    }
-
-private:
-    UartSysfs* uart_device_;
-};
-
-class UartManager {
-public:
-    ~UartManager();
-
-    // Get the singleton.
-    static UartManager* GetManager();
-    static void ResetManager();
-
-    // Used by the BSP to tell PMan of an sysfs uart_device.
-    bool RegisterUartDevice(const std::string& name, const std::string& path);
-    bool SetPinMux(const std::string& name, const std::string& mux);
-
-    std::vector<std::string> GetDevicesList();
-    bool HasUartDevice(const std::string& name);
-
-    bool RegisterDriver(std::unique_ptr<UartDriverInfoBase> driver_info);
-
-    std::unique_ptr<UartDevice> OpenUartDevice(const std::string& name, bool canonical = false);
-
-private:
-    UartManager();
-
-    std::map<std::string, std::unique_ptr<UartDriverInfoBase>> driver_infos_;
-    std::map<std::string, UartSysfs> uart_devices_;
-
-};
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <errno.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include "ModbusMaster.h"
+#include "UartDriver.h"
+#include "UartFramer.h"
+#include "Logger.h"
+#include "PinmuxManager.h"
+
+class UartDevice;
+
+struct UartSysfs {
+    std::string name;
+    std::string path;
+    std::string mux;
+    std::unique_ptr<UartDriverInterface> driver_;
+    // The handle that has the device open, if any.
+    UartDevice* handle_ = nullptr;
+};
+
+// A USB serial device showing up in or leaving /dev.
+struct UartHotplugEvent {
+    std::string name;
+    bool added;
+};
+
+class UartDevice {
+public:
+    explicit UartDevice(UartSysfs* uart_device) : uart_device_(uart_device) {
+        uart_device_->handle_ = this;
+    }
+    ~UartDevice() {
+        Invalidate();
+    }
+
+    // Closes the driver for good, leaving a handle whose calls fail with
+    // EIO. Done when the device is unplugged while open, so that nothing
+    // keeps using its stale fd, even once it comes back.
+    void Invalidate() {
+        if (!uart_device_) {
+            return;
+        }
+        // The Modbus thread uses the driver until it is stopped.
+        modbus_.reset();
+        if (!uart_device_->mux.empty()) {
+            PinMuxManager::GetPinMuxManager()->ReleaseSource(uart_device_->mux,uart_device_->mux);
+        }
+        uart_device_->driver_.reset();
+        uart_device_->handle_ = nullptr;
+        uart_device_ = nullptr;
+    }
+
+    int SetBaudrate(uint32_t baudrate) {
+        if (!uart_device_) {
+            return EIO;
+        }
+        return uart_device_->driver_->SetBaudrate(baudrate);
+    }
+    uint32_t getBaudrate(uint32_t* baudrate){
+        if (!uart_device_) {
+            *baudrate = 0;
+            return 0;
+        }
+        return uart_device_->driver_->getBaudrate(baudrate);
+    }
+
+    int Write(const std::vector<uint8_t>& data, uint32_t* bytes_written) {
+        if (!uart_device_) {
+            *bytes_written = 0;
+            return EIO;
+        }
+        return uart_device_->driver_->Write(data, bytes_written);
+    }
+
+    int Read(std::vector<uint8_t>* data, uint32_t size, uint32_t* bytes_read) {
+        if (!uart_device_) {
+            data->clear();
+            *bytes_read = 0;
+            return EIO;
+        }
+        return uart_device_->driver_->Read(data, size, bytes_read);
+    }
+    int FlushInput() {
+        if (!uart_device_) {
+            return EIO;
+        }
+        return uart_device_->driver_->FlushInput();
+    }
+    bool GetuPollingFd(int* fd) {
+        if (!uart_device_) {
+            *fd = -1;
+            return false;
+        }
+        return uart_device_->driver_->GetuPollingFd(fd);
+    }
+
+    bool StartReader(uint32_t buffer_size) {
+        return uart_device_ && uart_device_->driver_->StartReader(buffer_size);
+    }
+
+    bool GetReaderStats(UartReaderStats* stats) {
+        return uart_device_ && uart_device_->driver_->GetReaderStats(stats);
+    }
+
+    bool SetReaderSink(std::shared_ptr<SharedRing> sink) {
+        return uart_device_ && uart_device_->driver_->SetReaderSink(std::move(sink));
+    }
+
+    void SetFramer(std::unique_ptr<UartFramer> framer) {
+        framer_ = std::move(framer);
+    }
+
+    UartFramer* Framer() {
+        return framer_.get();
+    }
+
+    bool StartModbus(int response_timeout_ms) {
+        if (!uart_device_ || modbus_) {
+            return false;
+        }
+        modbus_.reset(new ModbusMaster(uart_device_->driver_.get(), response_timeout_ms));
+        return true;
+    }
+
+    void StopModbus() {
+        modbus_.reset();
+    }
+
+    ModbusMaster* Modbus() {
+        return modbus_.get();
+    }
+
+private:
+    UartSysfs* uart_device_;
+    std::unique_ptr<UartFramer> framer_;
+    std::unique_ptr<ModbusMaster> modbus_;
+};
+
+class UartManager {
+public:
+    ~UartManager();
+
+    // Get the singleton.
+    static UartManager* GetManager();
+    static void ResetManager();
+
+    // Used by the BSP to tell PMan of an sysfs uart_device.
+    bool RegisterUartDevice(const std::string& name, const std::string& path);
+    bool SetPinMux(const std::string& name, const std::string& mux);
+
+    std::vector<std::string> GetDevicesList();
+    bool HasUartDevice(const std::string& name);
+    // True while any client has the device open.
+    bool IsUartDeviceInUse(const std::string& name);
+
+    // Registers the USB serial devices in /dev and returns an inotify fd
+    // that turns readable when one is plugged or unplugged, or -1 if /dev
+    // cannot be watched. HandleHotplug() then updates the registry.
+    int StartHotplugWatch();
+    std::vector<UartHotplugEvent> HandleHotplug();
+
+    bool RegisterDriver(std::unique_ptr<UartDriverInfoBase> driver_info);
+
+    std::unique_ptr<UartDevice> OpenUartDevice(const std::string& name, bool canonical = false);
+
+private:
+    UartManager();
+
+    void AddHotplugDevice(const std::string& name, std::vector<UartHotplugEvent>* events);
+    void RemoveHotplugDevice(const std::string& name, std::vector<UartHotplugEvent>* events);
+    void ScanHotplugDevices(std::vector<UartHotplugEvent>* events);
+
+    std::map<std::string, std::unique_ptr<UartDriverInfoBase>> driver_infos_;
+    std::map<std::string, UartSysfs> uart_devices_;
+    // Devices registered from /dev rather than by the BSP.
+    std::set<std::string> hotplug_devices_;
+    int hotplug_fd_;
+
+};
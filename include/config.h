@@ -1,3 +1,5 @@
-#define PROJECT_NAME "peripheralmanager"
-#define SERVICE_NAME "com.webos.service.peripheralmanager"
-#define BUILD_TESTS  ""
+#define PROJECT_NAME "peripheralmanager"
+#define SERVICE_NAME "com.webos.service.peripheralmanager"
+#define BUILD_TESTS  ""
+#define I2C_SCAN_CACHE_TTL_MS 5000
+#define STREAM_SOCKET_DIR "/var/run/peripheralmanager"
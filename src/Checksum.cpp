@@ -0,0 +1,121 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Checksum.h"
+
+// All three CRCs are table driven, one lookup per byte.
+
+namespace {
+
+struct Tables {
+    uint16_t crc16_modbus[256];
+    uint16_t crc16_ccitt[256];
+    uint32_t crc32[256];
+
+    Tables() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint16_t modbus = i;
+            uint16_t ccitt = i << 8;
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; bit++) {
+                modbus = (modbus & 1) ? (modbus >> 1) ^ 0xa001 : modbus >> 1;
+                ccitt = (ccitt & 0x8000) ? (ccitt << 1) ^ 0x1021 : ccitt << 1;
+                crc = (crc & 1) ? (crc >> 1) ^ 0xedb88320 : crc >> 1;
+            }
+            crc16_modbus[i] = modbus;
+            crc16_ccitt[i] = ccitt;
+            crc32[i] = crc;
+        }
+    }
+};
+
+const Tables& tables() {
+    static const Tables instance;
+    return instance;
+}
+
+uint32_t checksumOf(const std::string& checksum, const uint8_t* data, size_t size) {
+    if (checksum == kChecksumCrc16Modbus)
+        return Crc16Modbus(data, size);
+    if (checksum == kChecksumCrc16Ccitt)
+        return Crc16Ccitt(data, size);
+    return Crc32(data, size);
+}
+
+// Byte |i| of |crc| as it goes on the wire; CCITT is the only big endian one.
+uint8_t checksumByte(const std::string& checksum, uint32_t crc, size_t size, size_t i) {
+    size_t shift = checksum == kChecksumCrc16Ccitt ? (size - 1 - i) * 8 : i * 8;
+    return (crc >> shift) & 0xff;
+}
+
+}  // namespace
+
+uint16_t Crc16Modbus(const uint8_t* data, size_t size) {
+    const uint16_t* table = tables().crc16_modbus;
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < size; i++)
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xff];
+    return crc;
+}
+
+uint16_t Crc16Ccitt(const uint8_t* data, size_t size) {
+    const uint16_t* table = tables().crc16_ccitt;
+    uint16_t crc = 0xffff;
+    for (size_t i = 0; i < size; i++)
+        crc = (crc << 8) ^ table[((crc >> 8) ^ data[i]) & 0xff];
+    return crc;
+}
+
+uint32_t Crc32(const uint8_t* data, size_t size) {
+    const uint32_t* table = tables().crc32;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++)
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xff];
+    return ~crc;
+}
+
+bool IsChecksum(const std::string& checksum) {
+    return ChecksumSize(checksum) != 0;
+}
+
+size_t ChecksumSize(const std::string& checksum) {
+    if (checksum == kChecksumCrc16Modbus || checksum == kChecksumCrc16Ccitt)
+        return 2;
+    if (checksum == kChecksumCrc32)
+        return 4;
+    return 0;
+}
+
+void AppendChecksum(const std::string& checksum, std::vector<uint8_t>* data) {
+    size_t size = ChecksumSize(checksum);
+    uint32_t crc = checksumOf(checksum, data->data(), data->size());
+    for (size_t i = 0; i < size; i++)
+        data->push_back(checksumByte(checksum, crc, size, i));
+}
+
+bool VerifyChecksum(const std::string& checksum, std::vector<uint8_t>* frame) {
+    size_t size = ChecksumSize(checksum);
+    if (!size || frame->size() < size)
+        return false;
+    size_t payload = frame->size() - size;
+    uint32_t crc = checksumOf(checksum, frame->data(), payload);
+    for (size_t i = 0; i < size; i++) {
+        if ((*frame)[payload + i] != checksumByte(checksum, crc, size, i))
+            return false;
+    }
+    frame->resize(payload);
+    return true;
+}
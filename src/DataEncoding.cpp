@@ -0,0 +1,162 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DataEncoding.h"
+#include <ctype.h>
+#include <string.h>
+
+// Both codecs work on whole groups through lookup tables: base64 turns
+// each 3-byte group into two 12-bit table hits, and decoding folds the
+// validity check of a 4-character group into one compare.
+
+namespace {
+
+const char kBase64Chars[] =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char kHexChars[] = "0123456789abcdef";
+const uint8_t kInvalid = 0xff;
+
+struct Tables {
+    // Two base64 characters for every 12-bit value.
+    char base64_pair[4096][2];
+    // Two hex characters for every byte.
+    char hex_pair[256][2];
+    // Character to 6-bit / 4-bit value, kInvalid otherwise.
+    uint8_t base64_value[256];
+    uint8_t hex_value[256];
+
+    Tables() {
+        for (int i = 0; i < 4096; i++) {
+            base64_pair[i][0] = kBase64Chars[i >> 6];
+            base64_pair[i][1] = kBase64Chars[i & 0x3f];
+        }
+        for (int i = 0; i < 256; i++) {
+            hex_pair[i][0] = kHexChars[i >> 4];
+            hex_pair[i][1] = kHexChars[i & 0xf];
+            base64_value[i] = kInvalid;
+            hex_value[i] = kInvalid;
+        }
+        for (int i = 0; i < 64; i++)
+            base64_value[static_cast<uint8_t>(kBase64Chars[i])] = i;
+        for (int i = 0; i < 16; i++) {
+            hex_value[static_cast<uint8_t>(kHexChars[i])] = i;
+            hex_value[static_cast<uint8_t>(toupper(kHexChars[i]))] = i;
+        }
+    }
+};
+
+const Tables& GetTables() {
+    static const Tables tables;
+    return tables;
+}
+
+std::string EncodeBase64(const uint8_t* data, size_t size) {
+    const Tables& t = GetTables();
+    std::string out((size + 2) / 3 * 4, '=');
+    char* dst = &out[0];
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3, dst += 4) {
+        uint32_t group = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        memcpy(dst, t.base64_pair[group >> 12], 2);
+        memcpy(dst + 2, t.base64_pair[group & 0xfff], 2);
+    }
+    if (i < size) {
+        uint32_t group = data[i] << 16;
+        if (i + 1 < size)
+            group |= data[i + 1] << 8;
+        memcpy(dst, t.base64_pair[group >> 12], 2);
+        if (i + 1 < size)
+            dst[2] = t.base64_pair[group & 0xfff][0];
+    }
+    return out;
+}
+
+bool DecodeBase64(const std::string& text, std::vector<uint8_t>* data) {
+    const Tables& t = GetTables();
+    size_t size = text.size();
+    if (size % 4)
+        return false;
+    size_t pad = 0;
+    if (size && text[size - 1] == '=')
+        pad = (text[size - 2] == '=') ? 2 : 1;
+
+    data->resize(size / 4 * 3);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(text.data());
+    uint8_t* dst = data->data();
+    for (size_t i = 0; i < size; i += 4, dst += 3) {
+        bool last = (i + 4 == size);
+        uint8_t a = t.base64_value[src[i]];
+        uint8_t b = t.base64_value[src[i + 1]];
+        uint8_t c = (last && pad == 2) ? 0 : t.base64_value[src[i + 2]];
+        uint8_t d = (last && pad) ? 0 : t.base64_value[src[i + 3]];
+        if ((a | b | c | d) & 0xc0)
+            return false;
+        uint32_t group = (a << 18) | (b << 12) | (c << 6) | d;
+        dst[0] = group >> 16;
+        dst[1] = group >> 8;
+        dst[2] = group;
+    }
+    data->resize(data->size() - pad);
+    return true;
+}
+
+std::string EncodeHex(const uint8_t* data, size_t size) {
+    const Tables& t = GetTables();
+    std::string out(size * 2, '0');
+    char* dst = &out[0];
+    for (size_t i = 0; i < size; i++, dst += 2)
+        memcpy(dst, t.hex_pair[data[i]], 2);
+    return out;
+}
+
+bool DecodeHex(const std::string& text, std::vector<uint8_t>* data) {
+    const Tables& t = GetTables();
+    if (text.size() % 2)
+        return false;
+
+    data->resize(text.size() / 2);
+    const uint8_t* src = reinterpret_cast<const uint8_t*>(text.data());
+    for (size_t i = 0; i < data->size(); i++) {
+        uint8_t high = t.hex_value[src[2 * i]];
+        uint8_t low = t.hex_value[src[2 * i + 1]];
+        if ((high | low) & 0xf0)
+            return false;
+        (*data)[i] = (high << 4) | low;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool IsDataEncoding(const std::string& encoding) {
+    return encoding == kEncodingBase64 || encoding == kEncodingHex;
+}
+
+std::string EncodeData(const uint8_t* data, size_t size,
+        const std::string& encoding) {
+    if (encoding == kEncodingHex)
+        return EncodeHex(data, size);
+    return EncodeBase64(data, size);
+}
+
+bool DecodeData(const std::string& text, const std::string& encoding,
+        std::vector<uint8_t>* data) {
+    if (encoding == kEncodingHex)
+        return DecodeHex(text, data);
+    if (encoding == kEncodingBase64)
+        return DecodeBase64(text, data);
+    return false;
+}
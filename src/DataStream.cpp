@@ -0,0 +1,196 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "DataStream.h"
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+static bool fillAddress(const std::string& path, struct sockaddr_un* addr) {
+    if (path.empty() || path.size() >= sizeof(addr->sun_path))
+        return false;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    memcpy(addr->sun_path, path.c_str(), path.size());
+    return true;
+}
+
+std::unique_ptr<DataStream> DataStream::Listen(const std::string& path) {
+    struct sockaddr_un addr;
+    if (!fillAddress(path, &addr))
+        return nullptr;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return nullptr;
+    unlink(path.c_str());
+    // Only the service user and its group may connect. Linux creates the
+    // socket file with the mode of the socket's inode, so setting it before
+    // bind() leaves no moment where others could connect.
+    if (fchmod(fd, 0660) < 0 ||
+        bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(fd, 1) < 0) {
+        close(fd);
+        unlink(path.c_str());
+        return nullptr;
+    }
+    return std::unique_ptr<DataStream>(new DataStream(fd, -1, path));
+}
+
+std::unique_ptr<DataStream> DataStream::Connect(const std::string& path) {
+    struct sockaddr_un addr;
+    if (!fillAddress(path, &addr))
+        return nullptr;
+    int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return nullptr;
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return nullptr;
+    }
+    return std::unique_ptr<DataStream>(new DataStream(-1, fd, path));
+}
+
+DataStream::DataStream(int listen_fd, int peer_fd, const std::string& path)
+    : listen_fd_(listen_fd), peer_fd_(peer_fd), peer_pid_(-1), peer_uid_(-1), path_(path),
+      dropped_(0) {}
+
+DataStream::~DataStream() {
+    Disconnect();
+    if (listen_fd_ >= 0) {
+        close(listen_fd_);
+        unlink(path_.c_str());
+    }
+}
+
+bool DataStream::Accept() {
+    // Non-blocking, so that Send() never waits for a slow peer.
+    int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+    if (fd < 0)
+        return false;
+    struct ucred cred;
+    socklen_t cred_size = sizeof(cred);
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (peer_fd_ >= 0 || getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_size) < 0) {
+        close(fd);
+        return false;
+    }
+    peer_fd_ = fd;
+    peer_pid_ = cred.pid;
+    peer_uid_ = cred.uid;
+    return true;
+}
+
+void DataStream::Disconnect() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (peer_fd_ >= 0)
+        close(peer_fd_);
+    peer_fd_ = -1;
+    peer_pid_ = -1;
+    peer_uid_ = -1;
+}
+
+bool DataStream::Send(uint16_t type, uint32_t sequence, const uint8_t* data, size_t size,
+        const std::vector<int>& fds) {
+    if (size > kStreamMaxPayload || fds.size() > kStreamMaxFds)
+        return false;
+    StreamFrameHeader header = {type, 0, sequence, static_cast<uint32_t>(size)};
+    struct iovec iov[2] = {
+        {&header, sizeof(header)},
+        {const_cast<uint8_t*>(data), size},
+    };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = size ? 2 : 1;
+    char control[CMSG_SPACE(sizeof(int) * kStreamMaxFds)];
+    if (!fds.empty()) {
+        memset(control, 0, sizeof(control));
+        msg.msg_control = control;
+        msg.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+        struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+        cmsg->cmsg_level = SOL_SOCKET;
+        cmsg->cmsg_type = SCM_RIGHTS;
+        cmsg->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+        memcpy(CMSG_DATA(cmsg), fds.data(), sizeof(int) * fds.size());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (peer_fd_ < 0)
+        return false;
+    ssize_t sent;
+    do {
+        sent = sendmsg(peer_fd_, &msg, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+    if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        dropped_++;
+        return false;
+    }
+    return sent == static_cast<ssize_t>(sizeof(header) + size);
+}
+
+bool DataStream::Receive(StreamFrameHeader* header, std::vector<uint8_t>* payload,
+        std::vector<int>* fds) {
+    payload->resize(kStreamMaxPayload);
+    struct iovec iov[2] = {
+        {header, sizeof(*header)},
+        {payload->data(), payload->size()},
+    };
+    char control[CMSG_SPACE(sizeof(int) * kStreamMaxFds)];
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received;
+    do {
+        received = recvmsg(peer_fd_, &msg, MSG_CMSG_CLOEXEC);
+    } while (received < 0 && errno == EINTR);
+
+    std::vector<int> passed;
+    if (received > 0) {
+        for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+            passed.insert(passed.end(), data, data + count);
+        }
+    }
+    // SEQPACKET keeps frame boundaries, so a short or truncated packet
+    // means the peer does not speak the protocol.
+    bool valid = received >= static_cast<ssize_t>(sizeof(*header)) &&
+            !(msg.msg_flags & (MSG_TRUNC | MSG_CTRUNC)) &&
+            header->length == received - sizeof(*header);
+    if (!valid || !fds) {
+        for (int fd : passed)
+            close(fd);
+        passed.clear();
+    }
+    if (fds)
+        fds->swap(passed);
+    if (!valid) {
+        payload->clear();
+        return false;
+    }
+    payload->resize(header->length);
+    return true;
+}
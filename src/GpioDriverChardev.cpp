@@ -0,0 +1,267 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "GpioDriverChardev.h"
+#include <fcntl.h>
+#include <linux/gpio.h>
+#include <poll.h>
+#include <string.h>
+#include <string>
+
+// Path to the gpio character devices.
+const char kGpioChipPath[] = "/dev/gpiochip";
+
+// Consumer label shown by the kernel for lines we hold.
+const char kGpioConsumer[] = "peripheralmanager";
+
+// Direction values, matching the sysfs driver.
+const char kChardevDirIn[] = "in";
+const char kChardevDirOut[] = "out";
+
+GpioDriverChardev::GpioDriverChardev(CharDeviceFactory* char_device_factory)
+: fd_(-1), line_fd_(-1), offset_(0), num_lines_(0), edge_type_(kEdgeNone),
+  char_device_factory_(char_device_factory) {}
+
+GpioDriverChardev::~GpioDriverChardev() {
+    if (char_interface_ == nullptr)
+        return;
+    if (line_fd_ >= 0) {
+        char_interface_->Close(line_fd_);
+    }
+    if (fd_ >= 0) {
+        char_interface_->Close(fd_);
+    }
+}
+
+bool GpioDriverChardev::Init(uint32_t chip, uint32_t index) {
+    return InitLines(chip, std::vector<uint32_t>(1, index));
+}
+
+bool GpioDriverChardev::InitLines(uint32_t chip,
+        const std::vector<uint32_t>& lines) {
+    if (lines.empty() || lines.size() > GPIO_V2_LINES_MAX) {
+        return false;
+    }
+    if (fd_ >= 0) {
+        return false;
+    }
+    // Get a char device. If char_device_factory_ is set
+    // then this is a unittest and the char device is provided
+    // by the test. Otherwise create a normal CharDevice.
+    if (!char_device_factory_) {
+        char_interface_.reset(new CharDevice());
+    } else {
+        char_interface_ = char_device_factory_->NewCharDevice();
+    }
+
+    std::string path = kGpioChipPath + std::to_string(chip);
+    int fd = char_interface_->Open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        AppLogError() << "GpioDriverChardev: Failed to open " << path;
+        return false;
+    }
+
+    // Request the lines without any direction flag so that their current
+    // configuration is kept, as exporting them through sysfs would.
+    struct gpio_v2_line_request req;
+    memset(&req, 0, sizeof(req));
+    for (size_t i = 0; i < lines.size(); i++)
+        req.offsets[i] = lines[i];
+    req.num_lines = lines.size();
+    strncpy(req.consumer, kGpioConsumer, sizeof(req.consumer) - 1);
+    if (char_interface_->Ioctl(fd, GPIO_V2_GET_LINE_IOCTL, &req) < 0) {
+        AppLogError() << "GpioDriverChardev: Failed to request line " << lines[0]
+                << " on " << path;
+        char_interface_->Close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    line_fd_ = req.fd;
+    offset_ = lines[0];
+    num_lines_ = lines.size();
+    return true;
+}
+
+bool GpioDriverChardev::SetValues(uint64_t bits, uint64_t mask) {
+    struct gpio_v2_line_values values;
+    values.bits = bits;
+    values.mask = mask;
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "GpioDriverChardev: Failed to set values";
+        return false;
+    }
+    return true;
+}
+
+bool GpioDriverChardev::GetValues(uint64_t* bits, uint64_t mask) {
+    struct gpio_v2_line_values values;
+    values.bits = 0;
+    values.mask = mask;
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+        return false;
+    }
+    *bits = values.bits & mask;
+    return true;
+}
+
+bool GpioDriverChardev::SetValue(bool val) {
+    struct gpio_v2_line_values values;
+    values.bits = val ? 1 : 0;
+    values.mask = 1;
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_SET_VALUES_IOCTL, &values) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed to set the value of the GPIO. Is it configured as "
+                << "output?";
+        return false;
+    }
+    return true;
+}
+
+bool GpioDriverChardev::GetValue(bool* val) {
+    struct gpio_v2_line_values values;
+    values.bits = 0;
+    values.mask = 1;
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+        return false;
+    }
+    *val = values.bits & 1;
+    return true;
+}
+
+bool GpioDriverChardev::SetDirection(GpioDirection direction) {
+    struct gpio_v2_line_config config;
+    memset(&config, 0, sizeof(config));
+
+    switch (direction) {
+    case kDirectionIn:
+        config.flags = GPIO_V2_LINE_FLAG_INPUT;
+        break;
+    case kDirectionOutInitiallyHigh:
+    case kDirectionOutInitiallyLow:
+        config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+        config.num_attrs = 1;
+        // The config applies to every line of the request.
+        config.attrs[0].mask = (num_lines_ >= 64) ? ~0ULL
+                : ((1ULL << num_lines_) - 1);
+        config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+        config.attrs[0].attr.values =
+                (direction == kDirectionOutInitiallyHigh)
+                ? config.attrs[0].mask : 0;
+        break;
+    default:
+        return false;
+    }
+
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0) {
+        AppLogError() << "GpioDriverChardev: Failed to set direction";
+        return false;
+    }
+    return true;
+}
+
+bool GpioDriverChardev::getDirection(std::string& direction) {
+    struct gpio_v2_line_info info;
+    memset(&info, 0, sizeof(info));
+    info.offset = offset_;
+    if (char_interface_->Ioctl(fd_, GPIO_V2_GET_LINEINFO_IOCTL, &info) < 0) {
+        return false;
+    }
+
+    direction = (info.flags & GPIO_V2_LINE_FLAG_OUTPUT) ? kChardevDirOut
+            : kChardevDirIn;
+    return true;
+}
+
+int  GpioDriverChardev::GetPollingFd(int * fd) {
+    // A duplicate, so that the caller owns it like the sysfs value fd and
+    // closing it leaves the line request alone. It stays valid, but goes
+    // stale, if InitLines() requests the lines again.
+    *fd = char_interface_->Dup(line_fd_);
+    return *fd;
+}
+
+bool GpioDriverChardev::SetEdgeType(GpioEdgeType type) {
+    struct gpio_v2_line_config config;
+    memset(&config, 0, sizeof(config));
+
+    // Edge detection requires the line to be an input.
+    switch (type) {
+    case kEdgeNone: {
+        struct gpio_v2_line_info info;
+        memset(&info, 0, sizeof(info));
+        info.offset = offset_;
+        if (char_interface_->Ioctl(fd_, GPIO_V2_GET_LINEINFO_IOCTL, &info) < 0) {
+            return false;
+        }
+        config.flags = info.flags &
+                (GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_OUTPUT);
+        if (config.flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+            // Without an output value the kernel drives the lines low, so
+            // keep what they output now, as SetDirection does.
+            struct gpio_v2_line_values values;
+            values.bits = 0;
+            values.mask = (num_lines_ >= 64) ? ~0ULL : ((1ULL << num_lines_) - 1);
+            if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_GET_VALUES_IOCTL, &values) < 0) {
+                return false;
+            }
+            config.num_attrs = 1;
+            config.attrs[0].mask = values.mask;
+            config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+            config.attrs[0].attr.values = values.bits & values.mask;
+        }
+        break;
+    }
+    case kEdgeRising:
+        config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+        break;
+    case kEdgeFalling:
+        config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        break;
+    case kEdgeBoth:
+        config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING |
+                GPIO_V2_LINE_FLAG_EDGE_FALLING;
+        break;
+    default:
+        return false;
+    }
+
+    if (char_interface_->Ioctl(line_fd_, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0) {
+        AppLogError() << "GpioDriverChardev: Failed to set edge";
+        return false;
+    }
+    edge_type_ = type;
+    return true;
+}
+
+bool GpioDriverChardev::GetEdgeFd(int* fd, short* events) {
+    if (line_fd_ < 0 || edge_type_ == kEdgeNone)
+        return false;
+    // Edge events are queued on the line request fd.
+    *fd = line_fd_;
+    *events = POLLIN;
+    return true;
+}
+
+bool GpioDriverChardev::ReadEdgeEvent(bool* value, uint64_t* timestamp_ns) {
+    struct gpio_v2_line_event event;
+    ssize_t bytes = char_interface_->Read(line_fd_, &event, sizeof(event));
+    if (bytes != sizeof(event))
+        return false;
+    // The kernel stamps the event in the interrupt handler.
+    *value = (event.id == GPIO_V2_LINE_EVENT_RISING_EDGE);
+    *timestamp_ns = event.timestamp_ns;
+    return true;
+}
@@ -1,217 +1,295 @@
-// Copyright (c) 2021-2024 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#include <fcntl.h>
-#include <string>
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <unistd.h>
-#include <string.h>
-#include "GpioDriverSysfs.h"
-
-// Path to sysfd gpio.
-const char kSysfsGpioPathPrefix[] = "/sys/class/gpio/gpio";
-
-// Path to export file.
-const char kSysfsGpioExportPath[] = "/sys/class/gpio/export";
-
-// Direction filename.
-const char kDirection[] = "direction";
-
-// Value filename.
-const char kValue[] = "value";
-
-// Active low filename.
-const char kActiveLowFile[] = "active_low";
-
-// Edge filename.
-const char kEdge[] = "edge";
-
-// Edge values.
-const char kEdgeNoneValue[] = "none";
-const char kEdgeRisingValue[] = "rising";
-const char kEdgeFallingValue[] = "falling";
-const char kEdgeBothValue[] = "both";
-
-// Direction values
-const char kDirHigh[] = "high";
-const char kDirLow[] = "low";
-const char kDirIn[] = "in";
-
-// Value values.
-const char kValueHigh[] = "1";
-const char kValueLow[] = "0";
-
-GpioDriverSysfs::GpioDriverSysfs(void* arg) : fd_(-1) {}
-
-GpioDriverSysfs::~GpioDriverSysfs() {
-    if (fd_ >= 0) {
-        close(fd_);
-    }
-}
-
-bool GpioDriverSysfs::Init(uint32_t index) {
-    if (!ExportGpio(index)) {
-        AppLogError() <<  "GpioDriverSysfs: Failed to export " << index;
-        return false;
-    }
-    std::string path = kSysfsGpioPathPrefix + std::to_string(index);
-
-    int fd = open(path.c_str(), O_RDONLY);
-    if (fd < 0) {
-        AppLogError()  << "Failed to open " << std::move(path);
-        return false;
-    }
-
-    fd_ = fd;
-    return true;
-}
-
-bool GpioDriverSysfs::SetValue(bool val) {
-    bool success = val ? Enable() : Disable();
-    if (!success) {
-        AppLogError() << "Failed to set the value of the GPIO. Is it configured as "
-                << "output?";
-    }
-    return success;
-}
-
-bool GpioDriverSysfs::GetValue(bool* val) {
-    std::string read_val;
-    if (!ReadFromFile(kValue, &read_val))
-        return false;
-    if (read_val.size() < 1) {
-        return false;
-    }
-    // Remove any whitespace.
-    read_val = read_val[0];
-    if (read_val == kValueHigh)
-        *val = true;
-    else
-        *val = false;
-    return true;
-}
-
-bool GpioDriverSysfs::SetDirection(GpioDirection direction) {
-    switch (direction) {
-    case kDirectionIn:
-        return WriteToFile(kDirection, kDirIn);
-    case kDirectionOutInitiallyHigh:
-        return WriteToFile(kDirection, kDirHigh);
-    case kDirectionOutInitiallyLow:
-        return WriteToFile(kDirection, kDirLow);
-    }
-    return false;
-}
-
-bool GpioDriverSysfs::getDirection(std::string& direction) {
-    std::string read_direction;
-    if (!ReadFromFileDirection(kDirection, &read_direction))
-        return false;
-
-    if (read_direction.empty())
-        return false;
-
-    direction = std::move(read_direction);
-
-    return true;
-}
-
-int  GpioDriverSysfs::GetPollingFd(int * fd) {
-    int f = openat(fd_, kValue, O_RDWR);
-    if (f < 0)
-        return false;
-    *fd =f;
-    return *fd;
-}
-
-bool GpioDriverSysfs::Enable() {
-    return WriteToFile(kValue, kValueHigh);
-}
-
-bool GpioDriverSysfs::Disable() {
-    return WriteToFile(kValue, kValueLow);
-}
-
-bool GpioDriverSysfs::WriteToFile(const std::string& file,
-        const std::string& value) {
-    int fd = openat(fd_, file.c_str(), O_RDWR);
-    if (fd < 0)
-        return false;
-
-    ssize_t bytes = write(fd, value.c_str(), value.size());
-    close(fd);
-    if (bytes < 0)
-        return false;
-    if ((size_t)bytes != value.size())
-        return false;
-    return true;
-}
-
-bool GpioDriverSysfs::ReadFromFile(const std::string& file,
-        std::string* value) {
-    int fd = openat(fd_, file.c_str(), O_RDONLY);
-    if (fd < 0)
-        return false;
-    char tmp_buf[16] = "";
-    ssize_t bytes = read(fd, tmp_buf, sizeof(tmp_buf));
-    close(fd);
-    if (bytes < 0)
-        return false;
-    value->assign(tmp_buf, bytes);
-
-    return true;
-}
-
-bool GpioDriverSysfs::ReadFromFileDirection(const std::string& file,
-        std::string* value) {
-    int fd = openat(fd_, file.c_str(), O_RDONLY);
-    if (fd < 0)
-        return false;
-    char tmp_buf[16] = "";
-    ssize_t bytes = read(fd, tmp_buf, sizeof(tmp_buf));
-    close(fd);
-    if (bytes < 0)
-        return false;
-    value->assign(tmp_buf, bytes);
-    return true;
-}
-
-bool GpioDriverSysfs::ExportGpio(uint32_t index) {
-    // Check if the pin is already exported.
-    // It will fail otherwise.
-    std::string path = kSysfsGpioPathPrefix + std::to_string(index);
-    struct stat stat_buf;
-    if (!stat(path.c_str(), &stat_buf)) {
-        return true;
-    }
-    int fd = open(kSysfsGpioExportPath, O_WRONLY);
-    if (fd < 0) {
-        AppLogError() <<  "Failed to open " << kSysfsGpioExportPath;
-        return false;
-    }
-    std::string value = std::to_string(index);
-    ssize_t bytes = write(fd, value.c_str(), value.size());
-    close(fd);
-    if (bytes < 0) {
-        AppLogError()  << "Failed to write " << bytes;
-        return false;
-    }
-    if ((size_t)bytes != value.size()) {
-        return false;
-    }
-    return true;
-}
+// Copyright (c) 2021-2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <fcntl.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <string.h>
+#include <poll.h>
+#include <time.h>
+#include "GpioDriverSysfs.h"
+
+// Path to sysfs gpio.
+const char kSysfsGpioRoot[] = "/sys/class/gpio";
+
+// Pin directory prefix, below the root.
+const char kSysfsGpioPathPrefix[] = "/gpio";
+
+// Export file, below the root.
+const char kSysfsGpioExport[] = "/export";
+
+// Direction filename.
+const char kDirection[] = "direction";
+
+// Value filename.
+const char kValue[] = "value";
+
+// Active low filename.
+const char kActiveLowFile[] = "active_low";
+
+// Edge filename.
+const char kEdge[] = "edge";
+
+// Edge values.
+const char kEdgeNoneValue[] = "none";
+const char kEdgeRisingValue[] = "rising";
+const char kEdgeFallingValue[] = "falling";
+const char kEdgeBothValue[] = "both";
+
+// Direction values
+const char kDirHigh[] = "high";
+const char kDirLow[] = "low";
+const char kDirIn[] = "in";
+
+// Value values.
+const char kValueHigh[] = "1";
+const char kValueLow[] = "0";
+
+GpioDriverSysfs::GpioDriverSysfs(void* arg)
+: GpioDriverSysfs(arg, kSysfsGpioRoot) {}
+
+GpioDriverSysfs::GpioDriverSysfs(void* arg, const std::string& sysfs_root)
+: sysfs_root_(sysfs_root), fd_(-1), value_fd_(-1), direction_fd_(-1),
+  edge_type_(kEdgeNone) {}
+
+GpioDriverSysfs::~GpioDriverSysfs() {
+    if (value_fd_ >= 0) {
+        close(value_fd_);
+    }
+    if (direction_fd_ >= 0) {
+        close(direction_fd_);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+bool GpioDriverSysfs::Init(uint32_t chip, uint32_t index) {
+    std::string path = sysfs_root_ + kSysfsGpioPathPrefix + std::to_string(index);
+
+    // Only export when the pin directory is not there yet.
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (!ExportGpio(index)) {
+            AppLogError() <<  "GpioDriverSysfs: Failed to export " << index;
+            return false;
+        }
+        fd = open(path.c_str(), O_RDONLY);
+    }
+    if (fd < 0) {
+        AppLogError()  << "Failed to open " << std::move(path);
+        return false;
+    }
+
+    fd_ = fd;
+
+    // Keep the hot attributes open so that a toggle is a single pwrite()
+    // instead of openat()/write()/close(). The direction attribute does not
+    // exist for pins whose direction is fixed, so failing here is not fatal.
+    value_fd_ = openat(fd_, kValue, O_RDWR);
+    direction_fd_ = openat(fd_, kDirection, O_RDWR);
+    return true;
+}
+
+bool GpioDriverSysfs::SetValue(bool val) {
+    bool success = val ? Enable() : Disable();
+    if (!success) {
+        AppLogHotRateLimited(Error, 1000) << "Failed to set the value of the GPIO. Is it configured as "
+                << "output?";
+    }
+    return success;
+}
+
+bool GpioDriverSysfs::GetValue(bool* val) {
+    std::string read_val;
+    if (!ReadAttribute(value_fd_, kValue, &read_val))
+        return false;
+    if (read_val.size() < 1) {
+        return false;
+    }
+    // Remove any whitespace.
+    read_val = read_val[0];
+    if (read_val == kValueHigh)
+        *val = true;
+    else
+        *val = false;
+    return true;
+}
+
+bool GpioDriverSysfs::SetDirection(GpioDirection direction) {
+    switch (direction) {
+    case kDirectionIn:
+        return WriteAttribute(direction_fd_, kDirection, kDirIn, sizeof(kDirIn) - 1);
+    case kDirectionOutInitiallyHigh:
+        return WriteAttribute(direction_fd_, kDirection, kDirHigh, sizeof(kDirHigh) - 1);
+    case kDirectionOutInitiallyLow:
+        return WriteAttribute(direction_fd_, kDirection, kDirLow, sizeof(kDirLow) - 1);
+    }
+    return false;
+}
+
+bool GpioDriverSysfs::getDirection(std::string& direction) {
+    std::string read_direction;
+    if (!ReadAttribute(direction_fd_, kDirection, &read_direction))
+        return false;
+
+    if (read_direction.empty())
+        return false;
+
+    direction = std::move(read_direction);
+
+    return true;
+}
+
+int  GpioDriverSysfs::GetPollingFd(int * fd) {
+    int f = openat(fd_, kValue, O_RDWR);
+    if (f < 0)
+        return false;
+    *fd =f;
+    return *fd;
+}
+
+bool GpioDriverSysfs::SetEdgeType(GpioEdgeType type) {
+    const char* value = nullptr;
+    switch (type) {
+    case kEdgeNone:
+        value = kEdgeNoneValue;
+        break;
+    case kEdgeRising:
+        value = kEdgeRisingValue;
+        break;
+    case kEdgeFalling:
+        value = kEdgeFallingValue;
+        break;
+    case kEdgeBoth:
+        value = kEdgeBothValue;
+        break;
+    }
+    if (!value || !WriteToFile(kEdge, value))
+        return false;
+    edge_type_ = type;
+    return true;
+}
+
+bool GpioDriverSysfs::GetEdgeFd(int* fd, short* events) {
+    if (value_fd_ < 0 || edge_type_ == kEdgeNone)
+        return false;
+    // sysfs_notify() on the value attribute raises POLLPRI.
+    *fd = value_fd_;
+    *events = POLLPRI;
+    return true;
+}
+
+bool GpioDriverSysfs::ReadEdgeEvent(bool* value, uint64_t* timestamp_ns) {
+    // Reading the value from offset 0 re-arms POLLPRI. sysfs does not
+    // report when the edge happened, so stamp it when it is consumed.
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    if (!GetValue(value))
+        return false;
+    *timestamp_ns = (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+    return true;
+}
+
+bool GpioDriverSysfs::Enable() {
+    return WriteAttribute(value_fd_, kValue, kValueHigh, sizeof(kValueHigh) - 1);
+}
+
+bool GpioDriverSysfs::Disable() {
+    return WriteAttribute(value_fd_, kValue, kValueLow, sizeof(kValueLow) - 1);
+}
+
+bool GpioDriverSysfs::WriteAttribute(int fd,
+        const std::string& file,
+        const char* value,
+        size_t size) {
+    if (fd < 0)
+        return WriteToFile(file, std::string(value, size));
+
+    ssize_t bytes = pwrite(fd, value, size, 0);
+    if (bytes < 0)
+        return false;
+    if ((size_t)bytes != size)
+        return false;
+    return true;
+}
+
+bool GpioDriverSysfs::ReadAttribute(int fd,
+        const std::string& file,
+        std::string* value) {
+    if (fd < 0)
+        return ReadFromFile(file, value);
+
+    // sysfs attributes are regenerated on every read from offset 0.
+    char tmp_buf[16] = "";
+    ssize_t bytes = pread(fd, tmp_buf, sizeof(tmp_buf), 0);
+    if (bytes < 0)
+        return false;
+    value->assign(tmp_buf, bytes);
+    return true;
+}
+
+bool GpioDriverSysfs::WriteToFile(const std::string& file,
+        const std::string& value) {
+    int fd = openat(fd_, file.c_str(), O_RDWR);
+    if (fd < 0)
+        return false;
+
+    ssize_t bytes = write(fd, value.c_str(), value.size());
+    close(fd);
+    if (bytes < 0)
+        return false;
+    if ((size_t)bytes != value.size())
+        return false;
+    return true;
+}
+
+bool GpioDriverSysfs::ReadFromFile(const std::string& file,
+        std::string* value) {
+    int fd = openat(fd_, file.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    char tmp_buf[16] = "";
+    ssize_t bytes = read(fd, tmp_buf, sizeof(tmp_buf));
+    close(fd);
+    if (bytes < 0)
+        return false;
+    value->assign(tmp_buf, bytes);
+
+    return true;
+}
+
+bool GpioDriverSysfs::ExportGpio(uint32_t index) {
+    std::string export_path = sysfs_root_ + kSysfsGpioExport;
+    int fd = open(export_path.c_str(), O_WRONLY);
+    if (fd < 0) {
+        AppLogError() <<  "Failed to open " << export_path;
+        return false;
+    }
+    std::string value = std::to_string(index);
+    ssize_t bytes = write(fd, value.c_str(), value.size());
+    close(fd);
+    if (bytes < 0) {
+        AppLogError()  << "Failed to write " << bytes;
+        return false;
+    }
+    if ((size_t)bytes != value.size()) {
+        return false;
+    }
+    return true;
+}
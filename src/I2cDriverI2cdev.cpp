@@ -1,206 +1,406 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#include "I2cDriverI2cdev.h"
-#include <fcntl.h>
-#include <linux/i2c.h>
-#include <linux/i2c-dev.h>
-#include <sys/ioctl.h>
-#include <string>
-#include <memory.h>
-
-const char kI2cDevPath[] = "/dev/i2c-";
-
-I2cDriverI2cDev::I2cDriverI2cDev(CharDeviceFactory* char_device_factory)
-: fd_(-1), char_device_factory_(char_device_factory) {}
-
-I2cDriverI2cDev::~I2cDriverI2cDev() {
-    if (fd_ >= 0 && char_interface_ != nullptr) {
-        char_interface_->Close(fd_);
-    }
-}
-
-bool I2cDriverI2cDev::Init(uint32_t bus_id, uint32_t address) {
-    if (fd_ >= 0) {
-        return false;
-    }
-    // Get a char device. If char_device_factory_ is set
-    // then this is a unittest and the char device is provided
-    // by the test. Otherwise create a normal CharDevice.
-    if (!char_device_factory_) {
-        char_interface_.reset(new CharDevice());
-    } else {
-        char_interface_ = char_device_factory_->NewCharDevice();
-    }
-
-    std::string path = kI2cDevPath + std::to_string(bus_id);
-
-    int fd = char_interface_->Open(path.c_str(), O_RDWR);
-    if (fd < 0) {
-        return false;
-    }
-    uintptr_t tmp_addr = address;
-    if (char_interface_->Ioctl(fd, I2C_SLAVE, reinterpret_cast<void*>(tmp_addr)) < 0) {
-        AppLogError() << "Failed to set I2C slave";
-        char_interface_->Close(fd);
-        return false;
-    }
-
-    fd_ = fd;
-    return true;
-}
-
-int32_t I2cDriverI2cDev::Read(void* data, uint32_t size, uint32_t* bytes_read) {
-    *bytes_read = char_interface_->Read(fd_, data, size);
-    return *bytes_read == size ? 0 : EIO;
-}
-
-int32_t I2cDriverI2cDev::ReadRegByte(uint8_t reg, uint8_t* val) {
-    union i2c_smbus_data read_data;
-    struct i2c_smbus_ioctl_data smbus_args {
-        .read_write = I2C_SMBUS_READ, .command = reg, .size = I2C_SMBUS_BYTE_DATA,
-                .data = &read_data,
-    };
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        AppLogError() << "Failed I2C_SMBUS";
-        return EIO;
-    }
-    *val = read_data.byte;
-    return 0;
-}
-
-
-int32_t I2cDriverI2cDev::ReadRegWord(uint8_t reg, uint16_t* val) {
-    union i2c_smbus_data read_data;
-    struct i2c_smbus_ioctl_data smbus_args {
-        .read_write = I2C_SMBUS_READ, .command = reg,  .size = I2C_SMBUS_WORD_DATA,
-                .data = &read_data,
-    };
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        AppLogError() << "Failed I2C_SMBUS";
-        return EIO;
-    }
-
-    *val = read_data.word;
-    return 0;
-}
-
-int32_t I2cDriverI2cDev::ReadRegBuffer(uint8_t reg,
-        uint8_t* data,
-        uint32_t size,
-        uint32_t* bytes_read) {
-    *bytes_read = 0;
-    if (size > I2C_SMBUS_BLOCK_MAX) {
-        AppLogError() << "Can't read more than 32 bytes at a time.";
-        return EINVAL;
-    }
-
-    union i2c_smbus_data read_data;
-    read_data.block[0] = size;
-
-    struct i2c_smbus_ioctl_data smbus_args;
-    smbus_args.command = reg;
-    smbus_args.read_write = I2C_SMBUS_READ;
-    smbus_args.size = I2C_SMBUS_I2C_BLOCK_DATA;
-    smbus_args.data = &read_data;
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        AppLogError() << "Failed I2C_SMBUS";
-        return EIO;
-    }
-
-    memcpy(data, &read_data.block[1], size);
-    for(int i = 0; i < size; i++) {
-        AppLogError() << __func__ << ":" << __LINE__ << " read_data.block[" << i << "] = " << read_data.block[1+i] ;
-    }
-
-    *bytes_read = size;
-    return 0;
-}
-
-int32_t I2cDriverI2cDev::Write(const void* data,
-        uint32_t size,
-        uint32_t* bytes_written) {
-    *bytes_written = char_interface_->Write(fd_, data, size);
-    return *bytes_written == size ? 0 : EIO;
-}
-
-int32_t I2cDriverI2cDev::WriteRegByte(uint8_t reg, uint8_t val) {
-    union i2c_smbus_data write_data;
-    write_data.byte = val;
-    struct i2c_smbus_ioctl_data smbus_args;
-    smbus_args.command = reg;
-    smbus_args.read_write = I2C_SMBUS_WRITE;
-    smbus_args.size = I2C_SMBUS_BYTE_DATA;
-    smbus_args.data = &write_data;
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        return EIO;
-    }
-    return 0;
-}
-
-int32_t I2cDriverI2cDev::WriteRegWord(uint8_t reg, uint16_t val) {
-    union i2c_smbus_data write_data;
-    write_data.word = val;
-    struct i2c_smbus_ioctl_data smbus_args;
-    smbus_args.command = reg;
-    smbus_args.read_write = I2C_SMBUS_WRITE;
-    smbus_args.size = I2C_SMBUS_WORD_DATA;
-    smbus_args.data = &write_data;
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        return EIO;
-    }
-    return 0;
-}
-
-int32_t I2cDriverI2cDev::WriteRegBuffer(uint8_t reg,
-        const uint8_t* data,
-        uint32_t size,
-        uint32_t* bytes_written) {
-    *bytes_written = 0;
-    if (size > I2C_SMBUS_BLOCK_MAX) {
-        AppLogError() << "Can't write more than 32 bytes at a time.";
-        return EINVAL;
-    }
-
-    union i2c_smbus_data write_data;
-    write_data.block[0] = size;
-    memcpy(&write_data.block[1], data, size);
-
-    struct i2c_smbus_ioctl_data smbus_args;
-    smbus_args.command = reg;
-    smbus_args.read_write = I2C_SMBUS_WRITE;
-    smbus_args.size = I2C_SMBUS_I2C_BLOCK_DATA;
-    smbus_args.data = &write_data;
-
-    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
-        AppLogError() << "Failed I2C_SMBUS";
-        return EIO;
-    }
-
-    *bytes_written = size;
-
-    return 0;
-}
-int  I2cDriverI2cDev::GetPollingFd(int * fd) {
-    *fd = fd_;
-    return fd_;
-}
-
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "I2cDriverI2cdev.h"
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <algorithm>
+#include <string>
+#include <memory.h>
+
+const char kI2cDevPath[] = "/dev/i2c-";
+
+// Address range probed by a scan, as i2cdetect does by default.
+const uint32_t kI2cScanFirst = 0x03;
+const uint32_t kI2cScanLast = 0x77;
+
+I2cDriverI2cDev::I2cDriverI2cDev(CharDeviceFactory* char_device_factory)
+: fd_(-1), address_(0), funcs_(0), char_device_factory_(char_device_factory) {}
+
+I2cDriverI2cDev::~I2cDriverI2cDev() {
+    if (fd_ >= 0 && char_interface_ != nullptr) {
+        char_interface_->Close(fd_);
+    }
+}
+
+bool I2cDriverI2cDev::Init(uint32_t bus_id, uint32_t address) {
+    if (fd_ >= 0) {
+        return false;
+    }
+    // Get a char device. If char_device_factory_ is set
+    // then this is a unittest and the char device is provided
+    // by the test. Otherwise create a normal CharDevice.
+    if (!char_device_factory_) {
+        char_interface_.reset(new CharDevice());
+    } else {
+        char_interface_ = char_device_factory_->NewCharDevice();
+    }
+
+    std::string path = kI2cDevPath + std::to_string(bus_id);
+
+    int fd = char_interface_->Open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        return false;
+    }
+    uintptr_t tmp_addr = address;
+    if (char_interface_->Ioctl(fd, I2C_SLAVE, reinterpret_cast<void*>(tmp_addr)) < 0) {
+        AppLogError() << "Failed to set I2C slave";
+        char_interface_->Close(fd);
+        return false;
+    }
+
+    // Without I2C_FUNCS, large register buffers fall back to SMBus blocks.
+    if (char_interface_->Ioctl(fd, I2C_FUNCS, &funcs_) < 0) {
+        funcs_ = 0;
+    }
+
+    fd_ = fd;
+    address_ = address;
+    return true;
+}
+
+int32_t I2cDriverI2cDev::Read(void* data, uint32_t size, uint32_t* bytes_read) {
+    *bytes_read = char_interface_->Read(fd_, data, size);
+    return *bytes_read == size ? 0 : EIO;
+}
+
+int32_t I2cDriverI2cDev::ReadRegByte(uint8_t reg, uint8_t* val) {
+    union i2c_smbus_data read_data;
+    struct i2c_smbus_ioctl_data smbus_args {
+        .read_write = I2C_SMBUS_READ, .command = reg, .size = I2C_SMBUS_BYTE_DATA,
+                .data = &read_data,
+    };
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed I2C_SMBUS";
+        return EIO;
+    }
+    *val = read_data.byte;
+    return 0;
+}
+
+
+int32_t I2cDriverI2cDev::ReadRegWord(uint8_t reg, uint16_t* val) {
+    union i2c_smbus_data read_data;
+    struct i2c_smbus_ioctl_data smbus_args {
+        .read_write = I2C_SMBUS_READ, .command = reg,  .size = I2C_SMBUS_WORD_DATA,
+                .data = &read_data,
+    };
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed I2C_SMBUS";
+        return EIO;
+    }
+
+    *val = read_data.word;
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::ReadRegBuffer(uint8_t reg,
+        uint8_t* data,
+        uint32_t size,
+        uint32_t* bytes_read) {
+    *bytes_read = 0;
+    if (size <= I2C_SMBUS_BLOCK_MAX) {
+        return ReadRegBlock(reg, data, size, bytes_read);
+    }
+
+    // Plain I2C adapters read the whole buffer after one repeated start.
+    if (funcs_ & I2C_FUNC_I2C) {
+        if (size > UINT16_MAX) {
+            return EINVAL;
+        }
+        struct i2c_msg msgs[2];
+        msgs[0].addr = address_;
+        msgs[0].flags = 0;
+        msgs[0].len = 1;
+        msgs[0].buf = &reg;
+        msgs[1].addr = address_;
+        msgs[1].flags = I2C_M_RD;
+        msgs[1].len = size;
+        msgs[1].buf = data;
+
+        struct i2c_rdwr_ioctl_data rdwr_args;
+        rdwr_args.msgs = msgs;
+        rdwr_args.nmsgs = 2;
+        if (char_interface_->Ioctl(fd_, I2C_RDWR, &rdwr_args) < 0) {
+            AppLogHotRateLimited(Error, 1000) << "Failed I2C_RDWR";
+            return EIO;
+        }
+        *bytes_read = size;
+        return 0;
+    }
+
+    // Otherwise read SMBus blocks, relying on the device to auto-increment
+    // its register address.
+    if (reg + size > 0x100) {
+        AppLogError() << "Register range past 0xff without I2C_RDWR.";
+        return EINVAL;
+    }
+    for (uint32_t offset = 0; offset < size; offset += I2C_SMBUS_BLOCK_MAX) {
+        uint32_t chunk = std::min<uint32_t>(size - offset, I2C_SMBUS_BLOCK_MAX);
+        uint32_t nread = 0;
+        int32_t ret = ReadRegBlock(reg + offset, data + offset, chunk, &nread);
+        *bytes_read += nread;
+        if (ret) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::ReadRegBlock(uint8_t reg,
+        uint8_t* data,
+        uint32_t size,
+        uint32_t* bytes_read) {
+    *bytes_read = 0;
+
+    union i2c_smbus_data read_data;
+    read_data.block[0] = size;
+
+    struct i2c_smbus_ioctl_data smbus_args;
+    smbus_args.command = reg;
+    smbus_args.read_write = I2C_SMBUS_READ;
+    smbus_args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    smbus_args.data = &read_data;
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed I2C_SMBUS";
+        return EIO;
+    }
+
+    memcpy(data, &read_data.block[1], size);
+    AppLogHot(Debug) << "I2C block read of " << size << " bytes at reg " << int(reg);
+
+    *bytes_read = size;
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::Write(const void* data,
+        uint32_t size,
+        uint32_t* bytes_written) {
+    *bytes_written = char_interface_->Write(fd_, data, size);
+    return *bytes_written == size ? 0 : EIO;
+}
+
+int32_t I2cDriverI2cDev::WriteRegByte(uint8_t reg, uint8_t val) {
+    union i2c_smbus_data write_data;
+    write_data.byte = val;
+    struct i2c_smbus_ioctl_data smbus_args;
+    smbus_args.command = reg;
+    smbus_args.read_write = I2C_SMBUS_WRITE;
+    smbus_args.size = I2C_SMBUS_BYTE_DATA;
+    smbus_args.data = &write_data;
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        return EIO;
+    }
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::WriteRegWord(uint8_t reg, uint16_t val) {
+    union i2c_smbus_data write_data;
+    write_data.word = val;
+    struct i2c_smbus_ioctl_data smbus_args;
+    smbus_args.command = reg;
+    smbus_args.read_write = I2C_SMBUS_WRITE;
+    smbus_args.size = I2C_SMBUS_WORD_DATA;
+    smbus_args.data = &write_data;
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        return EIO;
+    }
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::WriteRegBuffer(uint8_t reg,
+        const uint8_t* data,
+        uint32_t size,
+        uint32_t* bytes_written) {
+    *bytes_written = 0;
+    if (size <= I2C_SMBUS_BLOCK_MAX) {
+        return WriteRegBlock(reg, data, size, bytes_written);
+    }
+
+    // Plain I2C adapters take the register and the data as one message.
+    if (funcs_ & I2C_FUNC_I2C) {
+        if (size >= UINT16_MAX) {
+            return EINVAL;
+        }
+        std::vector<uint8_t> buffer(size + 1);
+        buffer[0] = reg;
+        memcpy(&buffer[1], data, size);
+
+        struct i2c_msg msg;
+        msg.addr = address_;
+        msg.flags = 0;
+        msg.len = buffer.size();
+        msg.buf = buffer.data();
+
+        struct i2c_rdwr_ioctl_data rdwr_args;
+        rdwr_args.msgs = &msg;
+        rdwr_args.nmsgs = 1;
+        if (char_interface_->Ioctl(fd_, I2C_RDWR, &rdwr_args) < 0) {
+            AppLogHotRateLimited(Error, 1000) << "Failed I2C_RDWR";
+            return EIO;
+        }
+        *bytes_written = size;
+        return 0;
+    }
+
+    // Otherwise write SMBus blocks, relying on the device to auto-increment
+    // its register address.
+    if (reg + size > 0x100) {
+        AppLogError() << "Register range past 0xff without I2C_RDWR.";
+        return EINVAL;
+    }
+    for (uint32_t offset = 0; offset < size; offset += I2C_SMBUS_BLOCK_MAX) {
+        uint32_t chunk = std::min<uint32_t>(size - offset, I2C_SMBUS_BLOCK_MAX);
+        uint32_t nwritten = 0;
+        int32_t ret = WriteRegBlock(reg + offset, data + offset, chunk, &nwritten);
+        *bytes_written += nwritten;
+        if (ret) {
+            return ret;
+        }
+    }
+    return 0;
+}
+
+int32_t I2cDriverI2cDev::WriteRegBlock(uint8_t reg,
+        const uint8_t* data,
+        uint32_t size,
+        uint32_t* bytes_written) {
+    *bytes_written = 0;
+
+    union i2c_smbus_data write_data;
+    write_data.block[0] = size;
+    memcpy(&write_data.block[1], data, size);
+
+    struct i2c_smbus_ioctl_data smbus_args;
+    smbus_args.command = reg;
+    smbus_args.read_write = I2C_SMBUS_WRITE;
+    smbus_args.size = I2C_SMBUS_I2C_BLOCK_DATA;
+    smbus_args.data = &write_data;
+
+    if (char_interface_->Ioctl(fd_, I2C_SMBUS, &smbus_args) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed I2C_SMBUS";
+        return EIO;
+    }
+
+    *bytes_written = size;
+
+    return 0;
+}
+int  I2cDriverI2cDev::GetPollingFd(int * fd) {
+    *fd = fd_;
+    return fd_;
+}
+
+int32_t I2cDriverI2cDev::Transfer(std::vector<I2cMessage>* msgs) {
+    if (msgs->empty() || msgs->size() > I2C_RDWR_IOCTL_MAX_MSGS) {
+        return EINVAL;
+    }
+
+    std::vector<struct i2c_msg> i2c_msgs(msgs->size());
+    for (size_t i = 0; i < msgs->size(); i++) {
+        I2cMessage& msg = (*msgs)[i];
+        if (msg.data.empty() || msg.data.size() > UINT16_MAX) {
+            return EINVAL;
+        }
+        i2c_msgs[i].addr = address_;
+        i2c_msgs[i].flags = msg.read ? I2C_M_RD : 0;
+        i2c_msgs[i].len = msg.data.size();
+        i2c_msgs[i].buf = msg.data.data();
+    }
+
+    struct i2c_rdwr_ioctl_data rdwr_args;
+    rdwr_args.msgs = i2c_msgs.data();
+    rdwr_args.nmsgs = i2c_msgs.size();
+    if (char_interface_->Ioctl(fd_, I2C_RDWR, &rdwr_args) < 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed I2C_RDWR";
+        return EIO;
+    }
+    return 0;
+}
+
+bool I2cDriverI2cDev::ProbeAddress(int fd, uint32_t address, unsigned long funcs) {
+    union i2c_smbus_data data;
+    struct i2c_smbus_ioctl_data smbus_args;
+    smbus_args.command = 0;
+    smbus_args.data = nullptr;
+
+    // Quick write can corrupt some EEPROMs and lock some sensors, so read
+    // a byte there instead; elsewhere prefer quick write when available.
+    bool use_read = ((address >= 0x30 && address <= 0x37) ||
+            (address >= 0x50 && address <= 0x5f) ||
+            !(funcs & I2C_FUNC_SMBUS_QUICK)) &&
+            (funcs & I2C_FUNC_SMBUS_READ_BYTE);
+    if (use_read) {
+        smbus_args.read_write = I2C_SMBUS_READ;
+        smbus_args.size = I2C_SMBUS_BYTE;
+        smbus_args.data = &data;
+    } else if (funcs & I2C_FUNC_SMBUS_QUICK) {
+        smbus_args.read_write = I2C_SMBUS_WRITE;
+        smbus_args.size = I2C_SMBUS_QUICK;
+    } else {
+        return false;
+    }
+    return char_interface_->Ioctl(fd, I2C_SMBUS, &smbus_args) >= 0;
+}
+
+int32_t I2cDriverI2cDev::Scan(uint32_t bus_id, std::vector<uint32_t>* addresses) {
+    if (!char_device_factory_) {
+        char_interface_.reset(new CharDevice());
+    } else {
+        char_interface_ = char_device_factory_->NewCharDevice();
+    }
+
+    std::string path = kI2cDevPath + std::to_string(bus_id);
+    int fd = char_interface_->Open(path.c_str(), O_RDWR);
+    if (fd < 0) {
+        return ENODEV;
+    }
+
+    unsigned long funcs = 0;
+    if (char_interface_->Ioctl(fd, I2C_FUNCS, &funcs) < 0) {
+        AppLogError() << "Failed I2C_FUNCS on " << path;
+        char_interface_->Close(fd);
+        return EIO;
+    }
+    if (!(funcs & (I2C_FUNC_SMBUS_QUICK | I2C_FUNC_SMBUS_READ_BYTE))) {
+        AppLogError() << "No probe command supported on " << path;
+        char_interface_->Close(fd);
+        return ENOTSUP;
+    }
+
+    addresses->clear();
+    for (uint32_t address = kI2cScanFirst; address <= kI2cScanLast; address++) {
+        uintptr_t tmp_addr = address;
+        if (char_interface_->Ioctl(fd, I2C_SLAVE, reinterpret_cast<void*>(tmp_addr)) < 0) {
+            // Claimed by a kernel driver, so a device is there.
+            if (errno == EBUSY)
+                addresses->push_back(address);
+            continue;
+        }
+        if (ProbeAddress(fd, address, funcs))
+            addresses->push_back(address);
+    }
+
+    char_interface_->Close(fd);
+    return 0;
+}
@@ -1,23 +1,44 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-/** * Global Loggers */
-
-#include "Logger.h"
-#include "PmLog.h"
-#include "config.h"
-
-pmlog::PmLog appLog(PROJECT_NAME);
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+/** * Global Loggers */
+
+#include "Logger.h"
+#include "PmLog.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+
+pmlog::PmLog appLog(PROJECT_NAME);
+
+// Runtime level for AppLogHot, taken from PERIPHERALMANAGER_LOG_LEVEL
+// (debug, info, warning, error or critical). Defaults to info.
+static int AppLogLevelFromEnv() {
+    const char* env = getenv("PERIPHERALMANAGER_LOG_LEVEL");
+    if (env == nullptr)
+        return APP_LOG_LEVEL_Info;
+    if (!strcmp(env, "debug"))
+        return APP_LOG_LEVEL_Debug;
+    if (!strcmp(env, "warning"))
+        return APP_LOG_LEVEL_Warning;
+    if (!strcmp(env, "error"))
+        return APP_LOG_LEVEL_Error;
+    if (!strcmp(env, "critical"))
+        return APP_LOG_LEVEL_Critical;
+    return APP_LOG_LEVEL_Info;
+}
+
+int appLogLevel = AppLogLevelFromEnv();
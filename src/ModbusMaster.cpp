@@ -0,0 +1,373 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ModbusMaster.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include "Checksum.h"
+#include "Logger.h"
+
+namespace {
+
+const uint8_t kReadHoldingRegisters = 0x03;
+const uint8_t kWriteSingleRegister = 0x06;
+const uint8_t kWriteMultipleRegisters = 0x10;
+const uint8_t kExceptionFlag = 0x80;
+
+// Unit, function and CRC around every reply.
+const size_t kReplyOverhead = 4;
+const size_t kExceptionReplySize = 5;
+
+// An RTU character is 11 bits: start, 8 data, parity or a second stop bit
+// and the stop bit.
+const uint32_t kBitsPerChar = 11;
+// Above 19200 baud the inter-frame gap is fixed rather than scaled.
+const uint32_t kFixedGapBaudrate = 19200;
+const std::chrono::microseconds kFixedFrameGap(1750);
+const uint32_t kDefaultBaudrate = 9600;
+
+void putWord(std::vector<uint8_t>* frame, uint16_t value) {
+    frame->push_back(value >> 8);
+    frame->push_back(value & 0xff);
+}
+
+uint16_t getWord(const uint8_t* data) {
+    return (data[0] << 8) | data[1];
+}
+
+}  // namespace
+
+const char* ModbusErrorText(ModbusError error) {
+    switch (error) {
+    case ModbusError::kNone:
+        return "No error";
+    case ModbusError::kTimeout:
+        return "Modbus reply timed out";
+    case ModbusError::kCrc:
+        return "Modbus reply failed its CRC";
+    case ModbusError::kInvalidReply:
+        return "Invalid Modbus reply";
+    case ModbusError::kException:
+        return "Modbus exception";
+    case ModbusError::kIo:
+        return "UART I/O error";
+    case ModbusError::kStopped:
+        return "Modbus master stopped";
+    }
+    return "Unknown Error";
+}
+
+ModbusMaster::ModbusMaster(UartDriverInterface* driver, int response_timeout_ms)
+: driver_(driver), response_timeout_(response_timeout_ms), char_time_(0),
+  frame_gap_(0), bus_idle_(Clock::now()), next_poll_id_(1), stop_(false),
+  stopping_(false), stop_fd_(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)),
+  thread_(&ModbusMaster::Run, this) {
+    if (stop_fd_ < 0)
+        AppLogError() << "Failed to create the Modbus stop eventfd: errno " << errno;
+}
+
+ModbusMaster::~ModbusMaster() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    stopping_ = true;
+    if (stop_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ret = write(stop_fd_, &one, sizeof(one));
+        (void)ret;
+    }
+    cond_.notify_one();
+    thread_.join();
+    if (stop_fd_ >= 0)
+        close(stop_fd_);
+
+    ModbusResult result{ModbusError::kStopped, 0, {}};
+    for (const Request& request : requests_)
+        request.done(result);
+}
+
+ModbusMaster::Request ModbusMaster::ReadRequest(uint8_t unit, uint16_t address,
+        uint16_t count) {
+    Request request{unit, kReadHoldingRegisters, {unit, kReadHoldingRegisters},
+            kReplyOverhead + 1 + 2u * count, nullptr};
+    putWord(&request.frame, address);
+    putWord(&request.frame, count);
+    return request;
+}
+
+void ModbusMaster::ReadHoldingRegisters(uint8_t unit, uint16_t address,
+        uint16_t count, Callback done) {
+    Request request = ReadRequest(unit, address, count);
+    request.done = std::move(done);
+    Queue(std::move(request));
+}
+
+void ModbusMaster::WriteRegisters(uint8_t unit, uint16_t address,
+        const std::vector<uint16_t>& values, Callback done) {
+    uint8_t function = values.size() == 1 ? kWriteSingleRegister : kWriteMultipleRegisters;
+    // Both replies echo the address and the value or count.
+    Request request{unit, function, {unit, function}, kReplyOverhead + 4, std::move(done)};
+    putWord(&request.frame, address);
+    if (function == kWriteMultipleRegisters) {
+        putWord(&request.frame, values.size());
+        request.frame.push_back(2 * values.size());
+    }
+    for (uint16_t value : values)
+        putWord(&request.frame, value);
+    Queue(std::move(request));
+}
+
+void ModbusMaster::Queue(Request request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        requests_.push_back(std::move(request));
+    }
+    cond_.notify_one();
+}
+
+uint32_t ModbusMaster::AddPoll(uint8_t unit, uint16_t address, uint16_t count,
+        uint32_t interval_ms) {
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        id = next_poll_id_++;
+        polls_[id] = Poll{unit, address, count, std::chrono::milliseconds(interval_ms),
+                Clock::now(), false, Clock::time_point(), {}};
+    }
+    cond_.notify_one();
+    return id;
+}
+
+bool ModbusMaster::RemovePoll(uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return polls_.erase(id) != 0;
+}
+
+bool ModbusMaster::GetCachedRegisters(uint8_t unit, uint16_t address,
+        uint16_t count, std::vector<uint16_t>* values, uint64_t* age_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Poll* freshest = nullptr;
+    for (const auto& entry : polls_) {
+        const Poll& poll = entry.second;
+        if (!poll.valid || poll.unit != unit || address < poll.address ||
+                address + count > poll.address + poll.count)
+            continue;
+        if (!freshest || poll.updated > freshest->updated)
+            freshest = &poll;
+    }
+    if (!freshest)
+        return false;
+
+    auto first = freshest->registers.begin() + (address - freshest->address);
+    values->assign(first, first + count);
+    *age_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+            Clock::now() - freshest->updated).count();
+    return true;
+}
+
+void ModbusMaster::Run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_) {
+        // Requests go ahead of the polls.
+        if (!requests_.empty()) {
+            Request request = std::move(requests_.front());
+            requests_.pop_front();
+            lock.unlock();
+            ModbusResult result = Transact(request);
+            request.done(result);
+            lock.lock();
+            continue;
+        }
+
+        auto next = polls_.end();
+        for (auto it = polls_.begin(); it != polls_.end(); ++it) {
+            if (next == polls_.end() || it->second.due < next->second.due)
+                next = it;
+        }
+        if (next == polls_.end()) {
+            cond_.wait(lock);
+            continue;
+        }
+        Clock::time_point now = Clock::now();
+        if (now < next->second.due) {
+            cond_.wait_until(lock, next->second.due);
+            continue;
+        }
+
+        uint32_t id = next->first;
+        Poll& poll = next->second;
+        Request request = ReadRequest(poll.unit, poll.address, poll.count);
+        // A poll that fell behind skips the missed rounds.
+        poll.due += poll.interval;
+        if (poll.due < now)
+            poll.due = now + poll.interval;
+        lock.unlock();
+        ModbusResult result = Transact(request);
+        lock.lock();
+
+        auto polled = polls_.find(id);
+        if (polled == polls_.end())
+            continue;
+        if (result.error != ModbusError::kNone) {
+            AppLogHotRateLimited(Warning, 1000) << "Modbus poll of unit " << int(request.unit)
+                    << " failed: " << ModbusErrorText(result.error);
+            continue;
+        }
+        polled->second.registers = std::move(result.registers);
+        polled->second.valid = true;
+        polled->second.updated = Clock::now();
+    }
+}
+
+// The rate may change between requests, so the timing follows it.
+void ModbusMaster::UpdateTiming() {
+    uint32_t baudrate = 0;
+    driver_->getBaudrate(&baudrate);
+    if (!baudrate)
+        baudrate = kDefaultBaudrate;
+    char_time_ = std::chrono::microseconds((kBitsPerChar * 1000000 + baudrate - 1) / baudrate);
+    frame_gap_ = baudrate > kFixedGapBaudrate ? kFixedFrameGap : char_time_ * 7 / 2;
+}
+
+ModbusResult ModbusMaster::Transact(const Request& request) {
+    UpdateTiming();
+
+    // The bus has to stay silent for 3.5 characters between frames.
+    Wait(-1, bus_idle_);
+    if (stopping_)
+        return ModbusResult{ModbusError::kStopped, 0, {}};
+
+    // Whatever arrived since, like the end of a late reply, is not ours.
+    if (driver_->FlushInput() != 0) {
+        bus_idle_ = Clock::now() + frame_gap_;
+        return ModbusResult{ModbusError::kIo, 0, {}};
+    }
+
+    std::vector<uint8_t> frame = request.frame;
+    AppendChecksum(kChecksumCrc16Modbus, &frame);
+    uint32_t bytes_written = 0;
+    if (driver_->Write(frame, &bytes_written) != 0 || bytes_written != frame.size()) {
+        bus_idle_ = Clock::now() + frame_gap_;
+        return ModbusResult{ModbusError::kIo, 0, {}};
+    }
+
+    std::vector<uint8_t> reply;
+    bool ok = ReceiveReply(request, &reply);
+    if (stopping_)
+        return ModbusResult{ModbusError::kStopped, 0, {}};
+    if (!ok)
+        return ModbusResult{ModbusError::kIo, 0, {}};
+    return ParseReply(request, &reply);
+}
+
+// Collects the reply until it is complete or the line goes quiet for 3.5
+// characters. Returns false if the UART failed.
+bool ModbusMaster::ReceiveReply(const Request& request, std::vector<uint8_t>* reply) {
+    int fd = -1;
+    driver_->GetuPollingFd(&fd);
+    // Write returns once the frame is queued; it leaves the wire a
+    // character time per byte later.
+    Clock::time_point last = Clock::now() + char_time_ * (request.frame.size() + 2);
+    Clock::time_point deadline = last + response_timeout_;
+
+    bool ok = true;
+    while (reply->size() < request.reply_size) {
+        Clock::time_point until = reply->empty() ? deadline : last + frame_gap_;
+        if (!Wait(fd, until))
+            break;
+        std::vector<uint8_t> data;
+        uint32_t bytes_read = 0;
+        int ret = driver_->Read(&data, request.reply_size - reply->size(), &bytes_read);
+        if (ret != 0 && ret != EAGAIN) {
+            ok = false;
+            break;
+        }
+        if (!bytes_read)
+            continue;
+        last = Clock::now();
+        reply->insert(reply->end(), data.begin(), data.end());
+        if (reply->size() == kExceptionReplySize && ((*reply)[1] & kExceptionFlag))
+            break;
+    }
+    bus_idle_ = std::max(last, Clock::now()) + frame_gap_;
+    return ok;
+}
+
+// ppoll() rather than poll(), whose milliseconds are too coarse for the
+// gaps at higher rates.
+bool ModbusMaster::Wait(int fd, Clock::time_point until) {
+    struct pollfd pfds[2] = {{fd, POLLIN, 0}, {stop_fd_, POLLIN, 0}};
+    int ret;
+    do {
+        if (stopping_)
+            return false;
+        int64_t us = std::max<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+                until - Clock::now()).count(), 0);
+        struct timespec ts = {static_cast<time_t>(us / 1000000), static_cast<long>(us % 1000000) * 1000};
+        ret = ppoll(pfds, 2, &ts, nullptr);
+    } while (ret < 0 && errno == EINTR);
+    return ret > 0 && !stopping_ && (pfds[0].revents & (POLLIN | POLLERR | POLLHUP));
+}
+
+ModbusResult ModbusMaster::ParseReply(const Request& request, std::vector<uint8_t>* reply) {
+    ModbusResult result{ModbusError::kNone, 0, {}};
+    if (reply->empty()) {
+        result.error = ModbusError::kTimeout;
+        return result;
+    }
+    if (reply->size() < kExceptionReplySize) {
+        result.error = ModbusError::kInvalidReply;
+        return result;
+    }
+    if (!VerifyChecksum(kChecksumCrc16Modbus, reply)) {
+        result.error = ModbusError::kCrc;
+        return result;
+    }
+
+    // |reply| is down to unit, function and data now.
+    const std::vector<uint8_t>& pdu = *reply;
+    if (pdu[0] != request.unit || (pdu[1] & ~kExceptionFlag) != request.function) {
+        result.error = ModbusError::kInvalidReply;
+        return result;
+    }
+    if (pdu[1] & kExceptionFlag) {
+        result.error = ModbusError::kException;
+        result.exception_code = pdu[2];
+        return result;
+    }
+    if (pdu.size() + 2 != request.reply_size) {
+        result.error = ModbusError::kInvalidReply;
+        return result;
+    }
+
+    if (request.function == kReadHoldingRegisters) {
+        if (pdu[2] != pdu.size() - 3) {
+            result.error = ModbusError::kInvalidReply;
+            return result;
+        }
+        for (size_t i = 3; i < pdu.size(); i += 2)
+            result.registers.push_back(getWord(&pdu[i]));
+    } else if (!std::equal(pdu.begin(), pdu.end(), request.frame.begin())) {
+        // Writes echo the request's address and value or count.
+        result.error = ModbusError::kInvalidReply;
+    }
+    return result;
+}
@@ -1,112 +1,112 @@
-/* @@@LICENSE
- *
- *      Copyright (c) 2021 LG Electronics, Inc.
- *
- * Confidential computer software. Valid license from LG required for
- * possession, use or copying. Consistent with FAR 12.211 and 12.212,
- * Commercial Computer Software, Computer Software Documentation, and
- * Technical Data for Commercial Items are licensed to the U.S. Government
- * under vendor's standard commercial license.
- *
- * LICENSE@@@ */
-
-#include <sys/stat.h>
-#include <sys/types.h>
-#include <fcntl.h>
-#include <stdio.h>
-#include <stdlib.h>
-#include <termios.h>
-#include <unistd.h>
-#include <pthread.h>
-
-#define IN  0
-#define OUT 1
-
-#define LOW  0
-#define HIGH 1
-//#define P_S0 23
-//#define P_S1 24
-
-static int GPIOExport(int pin) {
-#define BUFFER_MAX 3
-    char buffer[BUFFER_MAX];
-    ssize_t bytes_written;
-    int fd;
-
-    fd = open("/sys/class/gpio/export", O_WRONLY);
-    if (-1 == fd) {
-        fprintf(stderr, "Failed to open export for writing!\n");
-        return (-1);
-    }
-
-    bytes_written = snprintf(buffer, BUFFER_MAX, "%d", pin);
-    int ret = write(fd, buffer, bytes_written);
-    (void) ret;
-    close(fd);
-    return (0);
-}
-
-static int GPIOUnexport(int pin) {
-    char buffer[BUFFER_MAX];
-    ssize_t bytes_written;
-    int fd;
-
-    fd = open("/sys/class/gpio/unexport", O_WRONLY);
-    if (-1 == fd) {
-        fprintf(stderr, "Failed to open unexport for writing!\n");
-        return (-1);
-    }
-
-    bytes_written = snprintf(buffer, BUFFER_MAX, "%d", pin);
-    int ret = write(fd, buffer, bytes_written);
-    (void) ret;
-    close(fd);
-    return (0);
-}
-
-static int GPIODirection(int pin, int dir) {
-    static const char s_directions_str[] = "in\0out";
-
-#define DIRECTION_MAX 35
-    char path[DIRECTION_MAX];
-    int fd;
-
-    snprintf(path, DIRECTION_MAX, "/sys/class/gpio/gpio%d/direction", pin);
-    fd = open(path, O_WRONLY);
-    if (-1 == fd) {
-        fprintf(stderr, "Failed to open gpio direction for writing!\n");
-        return (-1);
-    }
-
-    if (-1 == write(fd, &s_directions_str[IN == dir ? 0 : 3],
-            IN == dir ? 2 : 3)) {
-        fprintf(stderr, "Failed to set direction!\n");
-        return (-1);
-    }
-
-    close(fd);
-    return (0);
-}
-
-static int GPIOWrite(int pin, int value) {
-    static const char s_values_str[] = "01";
-#define VALUE_MAX 30
-    char path[VALUE_MAX];
-    int fd;
-
-    snprintf(path, VALUE_MAX, "/sys/class/gpio/gpio%d/value", pin);
-    fd = open(path, O_WRONLY);
-    if (-1 == fd) {
-        fprintf(stderr, "Failed to open gpio value for writing!\n");
-        return (-1);
-    }
-
-    if (1 != write(fd, &s_values_str[LOW == value ? 0 : 1], 1)) {
-        fprintf(stderr, "Failed to write value!\n");
-        return (-1);
-    }
-
-    close(fd);
-    return (0);
-}
-
+/* @@@LICENSE
+ *
+ *      Copyright (c) 2021 LG Electronics, Inc.
+ *
+ * Confidential computer software. Valid license from LG required for
+ * possession, use or copying. Consistent with FAR 12.211 and 12.212,
+ * Commercial Computer Software, Computer Software Documentation, and
+ * Technical Data for Commercial Items are licensed to the U.S. Government
+ * under vendor's standard commercial license.
+ *
+ * LICENSE@@@ */
+
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#define IN  0
+#define OUT 1
+
+#define LOW  0
+#define HIGH 1
+//#define P_S0 23
+//#define P_S1 24
+
+static int GPIOExport(int pin) {
+#define BUFFER_MAX 3
+    char buffer[BUFFER_MAX];
+    ssize_t bytes_written;
+    int fd;
+
+    fd = open("/sys/class/gpio/export", O_WRONLY);
+    if (-1 == fd) {
+        fprintf(stderr, "Failed to open export for writing!\n");
+        return (-1);
+    }
+
+    bytes_written = snprintf(buffer, BUFFER_MAX, "%d", pin);
+    int ret = write(fd, buffer, bytes_written);
+    (void) ret;
+    close(fd);
+    return (0);
+}
+
+static int GPIOUnexport(int pin) {
+    char buffer[BUFFER_MAX];
+    ssize_t bytes_written;
+    int fd;
+
+    fd = open("/sys/class/gpio/unexport", O_WRONLY);
+    if (-1 == fd) {
+        fprintf(stderr, "Failed to open unexport for writing!\n");
+        return (-1);
+    }
+
+    bytes_written = snprintf(buffer, BUFFER_MAX, "%d", pin);
+    int ret = write(fd, buffer, bytes_written);
+    (void) ret;
+    close(fd);
+    return (0);
+}
+
+static int GPIODirection(int pin, int dir) {
+    static const char s_directions_str[] = "in\0out";
+
+#define DIRECTION_MAX 35
+    char path[DIRECTION_MAX];
+    int fd;
+
+    snprintf(path, DIRECTION_MAX, "/sys/class/gpio/gpio%d/direction", pin);
+    fd = open(path, O_WRONLY);
+    if (-1 == fd) {
+        fprintf(stderr, "Failed to open gpio direction for writing!\n");
+        return (-1);
+    }
+
+    if (-1 == write(fd, &s_directions_str[IN == dir ? 0 : 3],
+            IN == dir ? 2 : 3)) {
+        fprintf(stderr, "Failed to set direction!\n");
+        return (-1);
+    }
+
+    close(fd);
+    return (0);
+}
+
+static int GPIOWrite(int pin, int value) {
+    static const char s_values_str[] = "01";
+#define VALUE_MAX 30
+    char path[VALUE_MAX];
+    int fd;
+
+    snprintf(path, VALUE_MAX, "/sys/class/gpio/gpio%d/value", pin);
+    fd = open(path, O_WRONLY);
+    if (-1 == fd) {
+        fprintf(stderr, "Failed to open gpio value for writing!\n");
+        return (-1);
+    }
+
+    if (1 != write(fd, &s_values_str[LOW == value ? 0 : 1], 1)) {
+        fprintf(stderr, "Failed to write value!\n");
+        return (-1);
+    }
+
+    close(fd);
+    return (0);
+}
+
@@ -1,2674 +1,5422 @@
-// Copyright (c) 2021-2022 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#include "Logger.h"
-#include <unistd.h>
-#include <string>
-#include <locale>
-#include <stdio.h>
-#include <algorithm>
-#include <iostream>
-#include <iterator>
-#include <regex>
-#include <stdlib.h>
-#include <time.h>
-#include <sys/time.h>
-#include "PeripheralManagerAPI.h"
-#include "PeripheralManagerException.h"
-
-PeripheralManagerService::PeripheralManagerService(LS::Handle *ls_handle)
-: main_loop_ptr(g_main_loop_new(nullptr, false), g_main_loop_unref),
-  luna_handle(ls_handle)
-{
-    peripheral_manager_client = new PeripheralManagerClient ;
-    luna_handle->attachToLoop(main_loop_ptr.get());
-}
-
-PeripheralManagerService::~PeripheralManagerService() {
-    delete peripheral_manager_client;
-}
-
-void PeripheralManagerService::run() {
-    // attach to main loop and start running
-    g_main_loop_run(main_loop_ptr.get());
-}
-
-void PeripheralManagerService::stop() { g_main_loop_quit(main_loop_ptr.get()); }
-
-bool PeripheralManagerService::receiveCallback(LSHandle *sh, LSMessage *pMessage, void *pCtx)
-{
-    return true;
-}
-
-
-bool PeripheralManagerService::ListGpio(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "subscribe")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        else {
-            try {
-            std::vector<DevicesPinInfo> gpios;
-            peripheral_manager_client->ListGpio(gpios);
-            pbnjson::JValue gpioList = pbnjson::JArray();
-            for (const auto& gpio : gpios) {
-                pbnjson::JValue gpioJson  = pbnjson::JObject{{"pin", gpio.name},{"status", gpio.status}};
-                gpioList << gpioJson;
-            }
-            subscription = parsed["subscribe"].asBool();
-            response_json =
-                    pbnjson::JObject{
-                {"returnValue", true},
-                {"subscribed", subscription},
-                {"gpioList", gpioList}};
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::OpenGpio(LSMessage &ls_message) {
-    bool ret = false;
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    std::string pin ;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("pin"))
-        {
-            try {
-                ret = peripheral_manager_client->OpenGpio(pin);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-
-bool PeripheralManagerService::ReleaseGpio(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool ret = false;
-    std::string pin;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("pin"))
-        {
-            try {
-                ret = peripheral_manager_client->ReleaseGpio(pin);
-
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::SetGpioDirection(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool ret = false;
-    int direction =0;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        std::string dir = parsed["direction"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin" || ii.first.asString() == "direction" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if(parsed.hasKey("pin") &&  parsed.hasKey("direction"))
-        {
-            if(dir == "in") direction = 0;
-            else if(dir == "outHigh") direction = 1;
-            else if(dir == "outLow") direction = 2;
-            else {
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", dir+ " value not allowed"}};
-                request.respond(response_json.stringify().c_str());
-                return true;
-            }
-            try {
-                ret = peripheral_manager_client->SetGpioDirection(pin, direction);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin/direction  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SetGpioValue(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool ret = false;
-    bool value = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        std::string val = parsed["value"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin" || ii.first.asString() == "value" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("pin") && parsed.hasKey("value"))
-        {
-            if(val == "high") value = true;
-            else if(val == "low") value = false;
-            else {
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", val+ " value not allowed"}};
-                request.respond(response_json.stringify().c_str());
-                return true;
-            }
-            try {
-                ret = peripheral_manager_client->SetGpioValue(pin, value);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin/value is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::GetGpioValue(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    bool ret = false;
-    bool value = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        subscription = parsed["subscribe"].asBool();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("pin"))
-        {
-            try {
-                ret = peripheral_manager_client->GetGpioValue(pin, &value);
-                std::string val = value ? "high" : "low";
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"subscribed", subscription},
-                    {"value", val}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else{
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::GetGpioPollingFd(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    int fd = 0 ;
-    int ret;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }
-    else {
-        std::string pin = parsed["id"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "id")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("id"))
-        {
-            try {
-                ret = peripheral_manager_client->GetGpioPollingFd(pin, &fd);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"fd", fd}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "id is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::ListUartDevices(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "subscribe")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }else {
-            subscription = parsed["subscribe"].asBool();
-            std::vector<DevicesPinInfo> devices;
-            try {
-                peripheral_manager_client->ListUartDevices(devices);
-                pbnjson::JValue device_list = pbnjson::JArray();
-                for (const auto& device : devices) {
-                    pbnjson::JValue uartJson  = pbnjson::JObject{{"interfaceId", device.name},{"status", device.status}};
-                    device_list << uartJson;
-                }
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"uartList", device_list}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::OpenUartDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "interfaceId" || ii.first.asString() == "config" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId"))
-        {
-            const std::string interfaceId = parsed["interfaceId"].asString();
-            bool canonical = false;
-            if(parsed.hasKey("config"))
-            {
-                canonical = parsed["config"]["canonical"].asBool();
-            }
-            try {
-                peripheral_manager_client->OpenUartDevice(interfaceId, canonical);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-
-bool PeripheralManagerService::ReleaseUartDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "interfaceId")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId"))
-        {
-            const std::string interfaceId = parsed["interfaceId"].asString();
-            try {
-                peripheral_manager_client->ReleaseUartDevice(interfaceId);
-
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::SetUartDeviceBaudrate(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "baudrate" || ii.first.asString() == "interfaceId")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId") && parsed.hasKey("baudrate"))
-        {
-            const std::string interfaceId = parsed["interfaceId"].asString();
-            int32_t baudrate = parsed["baudrate"].asNumber<int>();
-            try {
-                ret = peripheral_manager_client->SetUartDeviceBaudrate(interfaceId, baudrate);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/baudrate is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::UartDeviceWrite(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "data" || ii.first.asString() == "interfaceId" || ii.first.asString() == "dataType" || ii.first.asString() == "size")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId") && parsed.hasKey("data") && parsed.hasKey("dataType") && parsed.hasKey("size"))
-        {
-            const std::string interfaceId = parsed["interfaceId"].asString();
-
-            std::string dataType = parsed["dataType"].asString();
-            int size = parsed["size"].asNumber<int>();
-            std::vector<uint8_t> data;
-
-            if(dataType == "text") {
-                std::string strData = parsed["data"].asString();
-                const char * cptr = strData.data();
-                int size = strData.size();
-                for(int i = 0; i < size; i++) {
-                    data.push_back(cptr[i]);
-                }
-            }
-            else {
-                pbnjson::JValue jsonData = parsed["data"];
-                int jsonDataSize = jsonData.arraySize();
-                for (int i = 0; i < jsonDataSize; i++) {
-                    uint8_t dataTemp = jsonData[i].asNumber<int>();
-                    data.push_back(dataTemp);
-                }
-            }
-
-            int bytes_written = 0;
-
-            try {
-                ret = peripheral_manager_client->UartDeviceWrite(interfaceId, data, &bytes_written);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"size", bytes_written}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/data/dataType/size is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::UartDeviceRead(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "size" || ii.first.asString() == "interfaceId" || ii.first.asString() == "dataType")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId"))
-        {
-            const std::string interfaceId = parsed["interfaceId"].asString();
-            int size = 1024;
-            if (parsed.hasKey("size"))
-            {
-                size = parsed["size"].asNumber<int>();
-            }
-            std::string dataType = "byte";
-            if (parsed.hasKey("dataType"))
-            {
-                if(parsed["dataType"].asString() == "text")
-                    dataType = "text";
-            }
-
-            std::vector<uint8_t> data;
-            data.resize(size);
-            int bytes_read = data.size();
-
-            try {
-                ret = peripheral_manager_client->UartDeviceRead(interfaceId, &data, data.size(), &bytes_read);
-
-                response_json = pbnjson::JObject {
-                    {"returnValue", true},
-                    {"dataType", dataType}
-                };
-
-                if(dataType == "text") {
-                    std::string data_str;
-                    std::locale loc;
-                    for(int i = 0; i < bytes_read; i++) {
-                        int check = isprint(data[i]);
-                        if(check > 0)
-                            data_str.push_back(data[i]);
-                    }
-                    response_json.put("data", data_str);
-                }
-                else {
-                    pbnjson::JValue data_array = pbnjson::JArray();
-                    for(int i = 0; i < bytes_read; i++) {
-                        data_array << data[i];
-                    }
-
-                    response_json.put("data", data_array);
-                    response_json.put("bytes_read", bytes_read);
-                }
-            }
-
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::getBaudrate(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    uint32_t baudrate = 0;
-    int ret;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string interfaceId = parsed["interfaceId"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "interfaceId" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("interfaceId"))
-        {
-            try {
-            ret = peripheral_manager_client->getBaudrate(interfaceId, &baudrate);
-            response_json =
-                    pbnjson::JObject{
-                {"returnValue", true},
-                {"baudrate", (int)baudrate}
-            };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else{
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::getDirection(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    bool ret;
-    std::string direction;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string pin = parsed["pin"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "pin")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("pin"))
-        {
-            try {
-                ret = peripheral_manager_client->getDirection(pin, direction);
-
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"direction", direction}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::GetuartPollingFd(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    int fd  ;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }
-    else {
-        std::string id = parsed["id"].asString();
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "id")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("id"))
-        {
-            try {
-                peripheral_manager_client->GetuartPollingFd(id, &fd);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"fd", fd}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "id is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::ListI2cBuses(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    bool verbose = false;
-
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "subscribe" || ii.first.asString() == "verbose")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        else{
-            try {
-                verbose = parsed["verbose"].asBool();
-                pbnjson::JValue list = pbnjson::JArray();
-                peripheral_manager_client->ListI2cBuses(list, verbose);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"i2cBusList", list}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::OpenI2cDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if(parsed.hasKey("name") && parsed.hasKey("address"))
-        {
-            try {
-                std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                peripheral_manager_client->OpenI2cDevice(name, address);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::ReleaseI2cDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if(parsed.hasKey("name") && parsed.hasKey("address"))
-        {
-            try {
-                std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                peripheral_manager_client->ReleaseI2cDevice(name, address);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-bool PeripheralManagerService::I2cRead(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue data_array = pbnjson::JArray();
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "size" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int address = parsed["address"].asNumber<int>();
-                std::vector<uint8_t> data;
-                int size = parsed["size"].asNumber<int>();
-                size =  size ? size : 8;
-                data.resize(size);
-                int bytes_read = 0;
-                peripheral_manager_client->I2cRead(name, address, &data, size, &bytes_read);
-                for(int i = 0; i < bytes_read; i++) {
-                    data_array << data[i];
-                }
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"data", data_array},
-                    {"size", bytes_read}
-
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-
-bool PeripheralManagerService::I2cReadRegByte(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("reg"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address =  parsed["address"].asNumber<int>();
-                int32_t reg =  parsed["reg"].asNumber<int>();
-                int32_t val =  0;
-                peripheral_manager_client->I2cReadRegByte(name, address, reg, &val);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"data", val}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::I2cReadRegWord(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("reg"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                int32_t reg = parsed["reg"].asNumber<int>();
-                int32_t val = 0;
-                peripheral_manager_client->I2cReadRegWord(name, address, reg, &val);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"data", val}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else{
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::I2cReadRegBuffer(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    pbnjson::JValue data_array = pbnjson::JArray();
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg" || ii.first.asString() == "size" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("reg"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                int32_t reg = parsed["reg"].asNumber<int>();
-                std::vector<uint8_t> data;
-                int32_t size = parsed["size"].asNumber<int>();
-                size = size ? size : 8;
-                int32_t bytes_read = 0;
-                peripheral_manager_client->I2cReadRegBuffer(name, address, reg, &data, size, &bytes_read);
-                for (int i = 0; i < bytes_read ; i++)
-                {
-                    data_array <<  data[i];
-                }
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"size", bytes_read},
-                    {"data", data_array}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-bool PeripheralManagerService::I2cWrite(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "data" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("data"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address  = parsed["address"].asNumber<int>();
-                pbnjson::JValue jsonData = parsed["data"];
-                int jsonDataSize = jsonData.arraySize();
-                std::vector<uint8_t> data;
-                for (int i = 0; i < jsonDataSize; i++) {
-                    uint8_t dataTemp = jsonData[i].asNumber<int>();
-                    data.push_back(dataTemp);
-                }
-
-                int bytes_written = 0;
-                peripheral_manager_client->I2cWrite( name, address, data, &bytes_written);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"size", bytes_written}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-
-bool PeripheralManagerService::I2cWriteRegByte(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg" || ii.first.asString() == "data" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("data") && parsed.hasKey("reg"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                int32_t reg = parsed["reg"].asNumber<int>();
-                int8_t data = parsed["data"].asNumber<int>();
-                peripheral_manager_client->I2cWriteRegByte( name, address, reg, data);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg/data  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-
-bool PeripheralManagerService::I2cWriteRegWord(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg" || ii.first.asString() == "data" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("reg") && parsed.hasKey("data"))
-        {
-            try {
-                const std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                int32_t reg = parsed["reg"].asNumber<int>();
-                int32_t data = parsed["data"].asNumber<int>();
-                peripheral_manager_client->I2cWriteRegWord(name, address, reg, data);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else{
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data/reg  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-
-bool PeripheralManagerService::I2cWriteRegBuffer(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address" || ii.first.asString() == "reg"  || ii.first.asString() == "data" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address") && parsed.hasKey("reg") && parsed.hasKey("data"))
-        {
-            try {
-                int32_t bytes_written = 0;
-                const std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                int32_t reg = parsed["reg"].asNumber<int>();
-                pbnjson::JValue jsonData = parsed["data"];
-                int jsonDataSize = jsonData.arraySize();
-                std::vector<uint8_t> data;
-                for (int i = 0; i < jsonDataSize; i++) {
-                    uint8_t dataTemp = jsonData[i].asNumber<int>();
-                    data.push_back(dataTemp);
-                }
-
-                peripheral_manager_client->I2cWriteRegBuffer(name, address, reg, data, &bytes_written);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"size" , bytes_written}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data/reg  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::ListSpiBuses(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "subscribe")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }else {
-            subscription = parsed["subscribe"].asBool();
-            std::vector<std::string> buses;
-            try {
-                peripheral_manager_client->ListSpiBuses(&buses);
-                pbnjson::JValue bus_list = pbnjson::JArray();
-                for (std::string device : buses) {
-                    bus_list << device;
-                }
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"list", bus_list}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::OpenSpiDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name"))
-        {
-            const std::string name = parsed["name"].asString();
-            try {
-                peripheral_manager_client->OpenSpiDevice(name);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::ReleaseSpiDevice(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name"))
-        {
-            const std::string name = parsed["name"].asString();
-            try {
-                peripheral_manager_client->ReleaseSpiDevice(name);
-
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceSetMode(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "mode" || ii.first.asString() == "name")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("mode"))
-        {
-            const std::string name = parsed["name"].asString();
-            int mode = parsed["mode"].asNumber<int>();
-            try {
-                peripheral_manager_client->SpiDeviceSetMode(name, mode);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/mode is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceSetFrequency(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "frequency" || ii.first.asString() == "name")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("frequency"))
-        {
-            const std::string name = parsed["name"].asString();
-            long int frequency = parsed["frequency"].asNumber<int>();
-            try {
-                peripheral_manager_client->SpiDeviceSetFrequency(name, frequency);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/frequency is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceSetBitJustification(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    bool lsb_first;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "lsb_first")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("lsb_first"))
-        {
-            const std::string name = parsed["name"].asString();
-            bool lsb_first = parsed["lsb_first"].asBool();
-            try {
-                peripheral_manager_client->SpiDeviceSetBitJustification(name, lsb_first);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/lsb_first is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceSetBitsPerWord(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    int nbits;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "nbits" || ii.first.asString() == "name")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("nbits"))
-        {
-            const std::string name = parsed["name"].asString();
-            int nbits = parsed["nbits"].asNumber<int>();
-            try {
-                peripheral_manager_client->SpiDeviceSetBitsPerWord(name, nbits);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/nbits is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceTransfer(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    bool ret = false;
-    int size;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "size" || ii.first.asString() == "name" || ii.first.asString() == "data" )
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("size"))
-        {
-            const std::string name = parsed["name"].asString();
-            int size = parsed["size"].asNumber<int>();
-            pbnjson::JValue jsonData = parsed["data"];
-            int jsonDataSize = jsonData.arraySize();
-            std::vector<uint8_t> data;
-            for (int i = 0; i < jsonDataSize; i++) {
-                uint8_t dataTemp = jsonData[i].asNumber<int>();
-                data.push_back(dataTemp);
-            }
-
-            std::vector<uint8_t> recv_data;
-            recv_data.resize(size);
-            try {
-                peripheral_manager_client->SpiDeviceTransfer(name,data,&recv_data,size);
-
-                int tx_size = data.size();
-                int rx_size = recv_data.size();
-                pbnjson::JValue data_array = pbnjson::JArray();
-                for (int i = 0; i < recv_data.size() ; i++)
-                {
-                    data_array <<  data[i];
-                }
-
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue" , true},
-                    {"tx_size" , tx_size},
-                    {"rx_size" , rx_size},
-                    {"rx_data" , data_array}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/size is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-bool PeripheralManagerService::SpiDeviceWriteByte(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "data")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("data"))
-        {
-            std::string name = parsed["name"].asString();
-            int8_t data = parsed["data"].asNumber<int>();
-            try {
-                peripheral_manager_client->SpiDeviceWriteByte(name,data);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/data  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceWriteBuffer(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "data")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("data"))
-        {
-            std::string name = parsed["name"].asString();
-
-            pbnjson::JValue jsonData = parsed["data"];
-            int jsonDataSize = jsonData.arraySize();
-            std::vector<uint8_t> data;
-            for (int i = 0; i < jsonDataSize; i++) {
-                uint8_t dataTemp = jsonData[i].asNumber<int>();
-                data.push_back(dataTemp);
-            }
-
-            try {
-                peripheral_manager_client->SpiDeviceWriteBuffer(name,data);
-                int size  = data.size();
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"size", size}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/buffer  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::SpiDeviceSetDelay(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    bool subscription = false;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    } else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "delay_usecs")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+" property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("delay_usecs"))
-        {
-            std::string name = parsed["name"].asString();
-            int delay_usecs = parsed["delay_usecs"].asNumber<int>();
-            try {
-                peripheral_manager_client->SpiDeviceSetDelay(name,delay_usecs);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/delay_usecs  is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-bool PeripheralManagerService::Geti2cPollingFd(LSMessage &ls_message) {
-    LS::Message request(&ls_message);
-    int fd  ;
-    pbnjson::JValue response_json;
-    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
-    if (parsed.isError()) {
-        response_json =
-                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
-        request.respond(response_json.stringify().c_str());
-        return false;
-    }
-    else {
-        std::string temp;
-        bool extra_property = false;
-        for(auto ii:parsed)
-        {
-            if(ii.first.asString() == "name" || ii.first.asString() == "address")
-            {
-                continue;
-            }
-            else
-            {
-                extra_property = true;
-                temp = ii.first.asString();
-                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp+ " property not allowed"}};
-            }
-        }
-        if(extra_property == true)
-        {
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-        if (parsed.hasKey("name") && parsed.hasKey("address"))
-        {
-            try {
-                std::string name = parsed["name"].asString();
-                int32_t address = parsed["address"].asNumber<int>();
-                peripheral_manager_client->Geti2cPollingFd(name, address, &fd);
-                response_json =
-                        pbnjson::JObject{
-                    {"returnValue", true},
-                    {"fd", fd}
-                };
-            }
-            catch (LS::Error &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
-            } catch (PeripheralManagerException &err) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorCode", err.getErrorCode()}, {"errorText", error_text.at(err.getErrorCode())}};
-            } catch (...) {
-                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
-            }
-            request.respond(response_json.stringify().c_str());
-
-        }
-        else {
-            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
-            request.respond(response_json.stringify().c_str());
-            return true;
-        }
-    }
-    return true;
-}
-
-// Private Methods
-void PeripheralManagerService::registerMethodsToLsHub() {
-    static const LSMethod gpio[] = {
-        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListGpio>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenGpio>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseGpio>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setDirection", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioDirection>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setValue", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioValue>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getValue", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetGpioValue>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetGpioPollingFd>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getDirection", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::getDirection>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {nullptr, nullptr}};
-
-    luna_handle->registerCategory("/gpio", gpio, nullptr, nullptr);
-    luna_handle->setCategoryData("/gpio", this);
-
-    static const LSMethod uart[] = {
-        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListUartDevices>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenUartDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseUartDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setBaudrate", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetUartDeviceBaudrate>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"write", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::UartDeviceWrite>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"read", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::UartDeviceRead>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetuartPollingFd>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getBaudrate", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::getBaudrate>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {nullptr, nullptr}};
-
-    luna_handle->registerCategory("/uart", uart, nullptr, nullptr);
-    luna_handle->setCategoryData("/uart", this);
-
-    static const LSMethod i2c[] = {
-        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListI2cBuses>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenI2cDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseI2cDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"read", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cRead>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"readRegByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegByte>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"readRegWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegWord>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"readRegBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegBuffer>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"write", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWrite>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"writeRegByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegByte>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"writeRegWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegWord>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"writeRegBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegBuffer>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::Geti2cPollingFd>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {nullptr, nullptr}};
-
-    luna_handle->registerCategory("/i2c", i2c, nullptr, nullptr);
-    luna_handle->setCategoryData("/i2c", this);
-
-        static const LSMethod spi[] = {
-        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListSpiBuses>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenSpiDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseSpiDevice>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setMode", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetMode>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setFrequency", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetFrequency>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setBitJustification", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetBitJustification>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setBitsPerWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetBitsPerWord>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"transfer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceTransfer>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"writeByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceWriteByte>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"writeBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceWriteBuffer>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {"setDelay", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetDelay>,
-        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
-        {nullptr, nullptr}};
-
-    luna_handle->registerCategory("/spi", spi, nullptr, nullptr);
-    luna_handle->setCategoryData("/spi", this);
-}
+// Copyright (c) 2021-2022 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "Logger.h"
+#include <atomic>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <locale>
+#include <stdio.h>
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <regex>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+#include "PeripheralManagerAPI.h"
+#include "DataEncoding.h"
+#include "RequestValidator.h"
+#include "PeripheralManagerException.h"
+
+PeripheralManagerService::PeripheralManagerService(LS::Handle *ls_handle)
+: main_loop_ptr(g_main_loop_new(nullptr, false), g_main_loop_unref),
+  luna_handle(ls_handle)
+{
+    luna_handle->attachToLoop(main_loop_ptr.get());
+}
+
+PeripheralManagerService::~PeripheralManagerService() {
+    while (!streams.empty())
+        stopStream(streams.begin()->first);
+    // Let queued bus requests finish before their devices go away.
+    busWorkers.clear();
+    sessions.clear();
+}
+
+void PeripheralManagerService::run() {
+    // The BSP has registered its UARTs by now, so /dev cannot shadow them.
+    startUartHotplugWatch();
+    // attach to main loop and start running
+    g_main_loop_run(main_loop_ptr.get());
+}
+
+void PeripheralManagerService::stop() { g_main_loop_quit(main_loop_ptr.get()); }
+
+bool PeripheralManagerService::receiveCallback(LSHandle *sh, LSMessage *pMessage, void *pCtx)
+{
+    return true;
+}
+
+// Runs a handler body. Client errors come back as Status; this only keeps
+// an unexpected exception from ending the service without a reply.
+static pbnjson::JValue guardedResponse(const std::function<pbnjson::JValue()> &work)
+{
+    try {
+        return work();
+    }
+    catch (LS::Error &err) {
+        return pbnjson::JObject{{"returnValue", false}, {"errorText", err.what()}};
+    } catch (...) {
+        return pbnjson::JObject{{"returnValue", false}, {"errorText", "Unknown Error"}};
+    }
+}
+
+// Reply for a client call that failed with |status|.
+static pbnjson::JValue statusResponse(Status status)
+{
+    return pbnjson::JObject{{"returnValue", false}, {"errorCode", status}, {"errorText", error_text.at(status)}};
+}
+
+// Workers are keyed by bus number so that requests by name and by handle
+// for one bus are serialized together. Unknown names and handles share one
+// worker, where they fail with the usual error.
+static std::string i2cBusKey(const std::string &name)
+{
+    uint32_t bus = 0;
+    if (!I2cManager::GetI2cManager()->GetI2cDevBusNumber(name, &bus))
+        return "/i2c/";
+    return "/i2c/" + std::to_string(bus);
+}
+
+// Devices on the chip selects of one SPI controller share its worker.
+static std::string spiBusKey(const std::string &name)
+{
+    uint32_t bus = 0;
+    if (!SpiManager::GetSpiManager()->GetSpiDevBusNumber(name, &bus))
+        return "/spi/";
+    return "/spi/" + std::to_string(bus);
+}
+
+std::string PeripheralManagerService::i2cWorkerKey(PeripheralManagerClient *client, int32_t handle, const std::string &name)
+{
+    uint32_t bus = 0;
+    if (!handle)
+        return i2cBusKey(name);
+    if (!client->GetI2cHandleBus(handle, &bus))
+        return "/i2c/";
+    return "/i2c/" + std::to_string(bus);
+}
+
+std::string PeripheralManagerService::spiWorkerKey(PeripheralManagerClient *client, int32_t handle, const std::string &name)
+{
+    uint32_t bus = 0;
+    if (!handle)
+        return spiBusKey(name);
+    if (!client->GetSpiHandleBus(handle, &bus))
+        return "/spi/";
+    return "/spi/" + std::to_string(bus);
+}
+
+BusWorker *PeripheralManagerService::busWorker(const std::string &bus)
+{
+    std::unique_ptr<BusWorker> &worker = busWorkers[bus];
+    if (!worker)
+        worker.reset(new BusWorker());
+    return worker.get();
+}
+
+gboolean PeripheralManagerService::deferredReplyCallback(gpointer data)
+{
+    std::unique_ptr<DeferredReply> reply(static_cast<DeferredReply *>(data));
+    reply->request.respond(reply->payload.c_str());
+    return G_SOURCE_REMOVE;
+}
+
+void PeripheralManagerService::respondOnBus(const std::string &bus, LSMessage &ls_message,
+        std::function<pbnjson::JValue()> work)
+{
+    // The copied LS::Message keeps the request referenced until the reply.
+    LS::Message request(&ls_message);
+    busWorker(bus)->Post([request, work]() {
+        DeferredReply *reply = new DeferredReply{request, guardedResponse(work).stringify()};
+        g_idle_add(deferredReplyCallback, reply);
+    });
+}
+
+bool PeripheralManagerService::senderStatusCallback(LSHandle *sh, const char *service_name, bool connected, void *ctx)
+{
+    Session *session = static_cast<Session *>(ctx);
+    // An ended session waits in endSessionCallback for its status to be
+    // cancelled; the sender may have a new session by then.
+    auto it = session->service->sessions.find(session->sender);
+    if (!connected && it != session->service->sessions.end() && it->second.get() == session)
+        session->service->endSession(session->sender);
+    return true;
+}
+
+gboolean PeripheralManagerService::endSessionCallback(gpointer data)
+{
+    std::unique_ptr<Session> session(static_cast<Session *>(data));
+    LS::Error error;
+    if (session->status_cookie)
+        LSCancelServerStatus(session->service->luna_handle->get(), session->status_cookie, error.get());
+    return G_SOURCE_REMOVE;
+}
+
+gboolean PeripheralManagerService::deleteClientCallback(gpointer data)
+{
+    // The client's destructor closes the GPIOs and UARTs still open.
+    delete static_cast<PeripheralManagerClient *>(data);
+    return G_SOURCE_REMOVE;
+}
+
+// Returns the client of the request's sender, starting a session on its
+// first request.
+PeripheralManagerClient *PeripheralManagerService::session(LSMessage &ls_message)
+{
+    const char *name = LSMessageGetSenderServiceName(&ls_message);
+    if (!name)
+        name = LSMessageGetSender(&ls_message);
+    std::string sender = name ? name : "";
+
+    std::unique_ptr<Session> &session = sessions[sender];
+    if (!session) {
+        session.reset(new Session{this, sender, nullptr,
+                std::unique_ptr<PeripheralManagerClient>(new PeripheralManagerClient)});
+        LS::Error error;
+        if (!sender.empty() &&
+                !LSRegisterServerStatusEx(luna_handle->get(), sender.c_str(), &senderStatusCallback,
+                        session.get(), &session->status_cookie, error.get()))
+            AppLogError() << "Failed to watch " << sender << ", its devices stay open after it exits";
+    }
+    return session->client.get();
+}
+
+void PeripheralManagerService::endSession(const std::string &sender)
+{
+    auto it = sessions.find(sender);
+    if (it == sessions.end())
+        return;
+    PeripheralManagerClient *client = it->second->client.get();
+
+    std::vector<std::string> keys;
+    for (const auto &stream : streams) {
+        if (stream.second->client == client)
+            keys.push_back(stream.first);
+    }
+    for (const std::string &key : keys)
+        stopStream(key);
+    keys.clear();
+    for (const auto &watch : gpioEdgeWatches) {
+        if (watch.second->client == client)
+            keys.push_back(watch.first);
+    }
+    for (const std::string &pin : keys)
+        stopGpioEdgeWatch(pin);
+    keys.clear();
+    for (const auto &watch : uartReadWatches) {
+        if (watch.second->client == client)
+            keys.push_back(watch.first);
+    }
+    for (const std::string &interfaceId : keys)
+        stopUartReadWatch(interfaceId);
+    keys.clear();
+    for (const auto &transaction : uartTransactions) {
+        if (transaction.second->client == client)
+            keys.push_back(transaction.first);
+    }
+    for (const std::string &interfaceId : keys)
+        finishUartTransaction(interfaceId, statusResponse(PeripheralManagerErrors::kENODEV));
+
+    // I2C and SPI devices are only touched from their bus worker, and
+    // requests still queued there may use the client. Every worker holds
+    // the client until it got past them, and the last one hands it back
+    // to the main loop to be deleted, so nothing here waits for a bus.
+    std::shared_ptr<PeripheralManagerClient> owner(it->second->client.release(),
+            [](PeripheralManagerClient *ended) { g_idle_add(deleteClientCallback, ended); });
+    for (const auto &device : client->GetOpenI2cDevices()) {
+        busWorker(i2cBusKey(device.first))->Post([owner, device]() {
+            owner->ReleaseI2cDevice(device.first, device.second);
+        });
+    }
+    for (const std::string &name : client->GetOpenSpiDevices()) {
+        busWorker(spiBusKey(name))->Post([owner, name]() {
+            owner->ReleaseSpiDevice(name);
+        });
+    }
+    for (const auto &worker : busWorkers)
+        worker.second->Post([owner]() {});
+
+    // The status callback that got here runs with the session as its
+    // context, so cancel it and free the session from the main loop.
+    AppLogInfo() << "Releasing the devices of " << sender;
+    g_idle_add(endSessionCallback, it->second.release());
+    sessions.erase(it);
+}
+
+// Data streams are keyed and named by "uart", "spi" or "gpio" and the device.
+static std::string streamKey(const std::string &kind, const std::string &device)
+{
+    return "/" + kind + "/" + device;
+}
+
+static std::string gpioSubscriptionKey(const std::string &pin)
+{
+    return "/gpio/getValue/" + pin;
+}
+
+gboolean PeripheralManagerService::gpioEdgeCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    GpioEdgeWatch *watch = static_cast<GpioEdgeWatch *>(data);
+    return watch->service->onGpioEdge(watch) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+bool PeripheralManagerService::startGpioEdgeWatch(PeripheralManagerClient *client, const std::string &pin)
+{
+    if (gpioEdgeWatches.count(pin))
+        return true;
+
+    int fd = -1;
+    short events = 0;
+    if (client->GetGpioEdgeFd(pin, &fd, &events) != PeripheralManagerErrors::kNoError)
+        return false;
+
+    std::unique_ptr<GpioEdgeWatch> watch(new GpioEdgeWatch{this, client, pin, 0});
+    GIOChannel *channel = g_io_channel_unix_new(fd);
+    // GIOCondition values are the poll(2) flags.
+    watch->source_id = g_io_add_watch(channel, static_cast<GIOCondition>(events),
+            &PeripheralManagerService::gpioEdgeCallback, watch.get());
+    g_io_channel_unref(channel);
+    if (!watch->source_id)
+        return false;
+
+    gpioEdgeWatches[pin] = std::move(watch);
+    return true;
+}
+
+// Stops |client|'s edge watch on |pin|, leaving another session's alone.
+void PeripheralManagerService::stopGpioEdgeWatch(PeripheralManagerClient *client, const std::string &pin)
+{
+    auto it = gpioEdgeWatches.find(pin);
+    if (it != gpioEdgeWatches.end() && it->second->client == client)
+        stopGpioEdgeWatch(pin);
+}
+
+void PeripheralManagerService::stopGpioEdgeWatch(const std::string &pin)
+{
+    auto it = gpioEdgeWatches.find(pin);
+    if (it == gpioEdgeWatches.end())
+        return;
+    g_source_remove(it->second->source_id);
+    gpioEdgeWatches.erase(it);
+}
+
+// Runs on the main loop. It is the only producer of a gpio stream's ring,
+// and SharedRing::Push() drops rather than waits when the client lags, so
+// a slow client cannot stall the loop.
+bool PeripheralManagerService::onGpioEdge(GpioEdgeWatch *watch)
+{
+    std::string key = gpioSubscriptionKey(watch->pin);
+    auto stream = streams.find(streamKey("gpio", watch->pin));
+    bool value = false;
+    uint64_t timestamp_ns = 0;
+    if (!watch->client->ReadGpioEdgeEvent(watch->pin, &value, &timestamp_ns) ||
+            (stream == streams.end() &&
+             LSSubscriptionGetHandleSubscribersCount(luna_handle->get(), key.c_str()) == 0)) {
+        // Returning false removes the source, so only forget the watch here.
+        gpioEdgeWatches.erase(watch->pin);
+        return false;
+    }
+
+    if (stream != streams.end()) {
+        StreamGpioEdge edge = {timestamp_ns, value, 0};
+        stream->second->ring->Push(reinterpret_cast<const uint8_t *>(&edge), sizeof(edge));
+        if (LSSubscriptionGetHandleSubscribersCount(luna_handle->get(), key.c_str()) == 0)
+            return true;
+    }
+
+    pbnjson::JValue response_json = pbnjson::JObject{
+        {"returnValue", true},
+        {"subscribed", true},
+        {"pin", watch->pin},
+        {"value", value ? "high" : "low"},
+        {"timestamp", static_cast<int64_t>(timestamp_ns)}
+    };
+    LS::Error error;
+    LSSubscriptionReply(luna_handle->get(), key.c_str(), response_json.stringify().c_str(), error.get());
+    return true;
+}
+
+static const char kUartListSubscriptionKey[] = "/uart/list";
+
+gboolean PeripheralManagerService::uartHotplugCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    PeripheralManagerService *service = static_cast<PeripheralManagerService *>(data);
+    for (const UartHotplugEvent &event : UartManager::GetManager()->HandleHotplug()) {
+        if (!event.added) {
+            // The open handle was closed, so nothing may watch its fds.
+            service->stopUartReadWatch(event.name);
+            service->finishUartTransaction(event.name, statusResponse(PeripheralManagerErrors::kENODEV));
+            service->stopStream(streamKey("uart", event.name));
+        }
+        pbnjson::JValue response_json = pbnjson::JObject{
+            {"returnValue", true},
+            {"subscribed", true},
+            {"interfaceId", event.name},
+            {"event", event.added ? "added" : "removed"}
+        };
+        LS::Error error;
+        LSSubscriptionReply(service->luna_handle->get(), kUartListSubscriptionKey,
+                response_json.stringify().c_str(), error.get());
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+void PeripheralManagerService::startUartHotplugWatch()
+{
+    int fd = UartManager::GetManager()->StartHotplugWatch();
+    if (fd < 0)
+        return;
+    GIOChannel *channel = g_io_channel_unix_new(fd);
+    g_io_add_watch(channel, G_IO_IN, &PeripheralManagerService::uartHotplugCallback, this);
+    g_io_channel_unref(channel);
+}
+
+// Largest chunk read from a UART per readiness callback.
+static const int kUartReadChunk = 1024;
+
+// Default uart/read subscription coalescing window.
+static const guint kUartCoalesceMs = 20;
+
+static std::string uartSubscriptionKey(const std::string &interfaceId, const std::string &dataType)
+{
+    return "/uart/read/" + interfaceId + "/" + dataType;
+}
+
+// Returns false if the request names an unknown "encoding".
+static bool getDataEncoding(const pbnjson::JValue &parsed, std::string *encoding)
+{
+    if (!parsed.hasKey("encoding"))
+        return true;
+    *encoding = parsed["encoding"].asString();
+    return IsDataEncoding(*encoding);
+}
+
+static bool getDataEncoding(const Param<std::string> &param, std::string *encoding)
+{
+    if (!param.set)
+        return true;
+    *encoding = param.value;
+    return IsDataEncoding(*encoding);
+}
+
+// Reads binary data given as a byte array, or as a string in |encoding|.
+static bool getBinaryData(const pbnjson::JValue &value, const std::string &encoding,
+        std::vector<uint8_t> *data)
+{
+    if (!encoding.empty())
+        return value.isString() && DecodeData(value.asString(), encoding, data);
+    int size = value.arraySize();
+    for (int i = 0; i < size; i++)
+        data->push_back(value[i].asNumber<int>());
+    return true;
+}
+
+// Builds binary data as a byte array, or as a string in |encoding|.
+static pbnjson::JValue binaryDataJson(const uint8_t *data, size_t size, const std::string &encoding)
+{
+    if (!encoding.empty())
+        return pbnjson::JValue(EncodeData(data, size, encoding));
+    pbnjson::JValue data_array = pbnjson::JArray();
+    for (size_t i = 0; i < size; i++)
+        data_array << data[i];
+    return data_array;
+}
+
+// Subscription format of a uart/read request: "text", "byte" or an encoding.
+static std::string uartDataFormat(const std::string &dataType, const std::string &encoding)
+{
+    return (dataType == "text" || encoding.empty()) ? dataType : encoding;
+}
+
+// The printable characters of |data|, for the "text" data type.
+static std::string printableText(const uint8_t *data, int size)
+{
+    std::string data_str;
+    for(int i = 0; i < size; i++) {
+        int check = isprint(data[i]);
+        if(check > 0)
+            data_str.push_back(data[i]);
+    }
+    return data_str;
+}
+
+// Fills the uart/read "data" fields in the requested representation.
+static void putUartData(pbnjson::JValue &response_json, const uint8_t *data, int size,
+        const std::string &dataType, const std::string &encoding)
+{
+    if(dataType == "text") {
+        response_json.put("data", printableText(data, size));
+    }
+    else {
+        response_json.put("data", binaryDataJson(data, size, encoding));
+        response_json.put("bytes_read", size);
+        if (!encoding.empty())
+            response_json.put("encoding", encoding);
+    }
+}
+
+// Fills a uart/read response from the bytes just read. A framed device
+// feeds them to its framer and only returns the frames they completed,
+// as a "frames" array.
+static void putUartReadData(pbnjson::JValue &response_json, UartFramer *framer, const uint8_t *data,
+        int size, const std::string &dataType, const std::string &encoding)
+{
+    if (!framer) {
+        putUartData(response_json, data, size, dataType, encoding);
+        return;
+    }
+    UartFramer::Frames frames;
+    framer->Feed(data, size, &frames);
+    pbnjson::JValue frames_json = pbnjson::JArray();
+    for (const auto &frame : frames) {
+        if (dataType == "text")
+            frames_json << printableText(frame.data(), frame.size());
+        else
+            frames_json << binaryDataJson(frame.data(), frame.size(), encoding);
+    }
+    response_json.put("frames", frames_json);
+    if (dataType != "text" && !encoding.empty())
+        response_json.put("encoding", encoding);
+}
+
+// Builds the framer of a uart/open "framing" config, null without one.
+// Returns false if the config is not valid.
+static bool getUartFramer(const pbnjson::JValue &config, std::unique_ptr<UartFramer> *framer)
+{
+    if (!config.hasKey("framing"))
+        return true;
+    const pbnjson::JValue framing = config["framing"];
+    if (!framing.isObject() || !framing["type"].isString())
+        return false;
+
+    UartFramerConfig framer_config;
+    framer_config.type = framing["type"].asString();
+    if (framing.hasKey("delimiter")) {
+        int delimiter = framing["delimiter"].asNumber<int>();
+        if (delimiter < 0 || delimiter > 0xff)
+            return false;
+        framer_config.delimiter = delimiter;
+    }
+    if (framing.hasKey("keepDelimiter"))
+        framer_config.keep_delimiter = framing["keepDelimiter"].asBool();
+    if (framing.hasKey("lengthBytes"))
+        framer_config.length_bytes = framing["lengthBytes"].asNumber<int>();
+    if (framing.hasKey("byteOrder")) {
+        std::string byte_order = framing["byteOrder"].asString();
+        if (byte_order != "big" && byte_order != "little")
+            return false;
+        framer_config.big_endian = byte_order == "big";
+    }
+    if (framing.hasKey("maxLength")) {
+        int max_length = framing["maxLength"].asNumber<int>();
+        if (max_length <= 0)
+            return false;
+        framer_config.max_length = max_length;
+    }
+    if (framing.hasKey("checksum"))
+        framer_config.checksum = framing["checksum"].asString();
+    *framer = UartFramer::Create(framer_config);
+    return *framer != nullptr;
+}
+
+gboolean PeripheralManagerService::uartReadCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    UartReadWatch *watch = static_cast<UartReadWatch *>(data);
+    return watch->service->onUartReadable(watch, condition) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+gboolean PeripheralManagerService::uartFlushCallback(gpointer data)
+{
+    UartReadWatch *watch = static_cast<UartReadWatch *>(data);
+    PeripheralManagerService *service = watch->service;
+    // The timer is removed by returning G_SOURCE_REMOVE.
+    watch->timer_id = 0;
+    if (!service->flushUartRead(watch))
+        service->stopUartReadWatch(watch->interfaceId);
+    return G_SOURCE_REMOVE;
+}
+
+bool PeripheralManagerService::startUartReadWatch(PeripheralManagerClient *client, const std::string &interfaceId,
+        guint window_ms, size_t threshold)
+{
+    if (uartReadWatches.count(interfaceId))
+        return true;
+    // A data stream or a transaction already consumes what the device receives.
+    if (streams.count(streamKey("uart", interfaceId)) || uartTransactions.count(interfaceId))
+        return false;
+
+    int fd = -1;
+    client->GetuartPollingFd(interfaceId, &fd);
+    if (fd < 0)
+        return false;
+
+    std::unique_ptr<UartReadWatch> watch(
+            new UartReadWatch{this, client, interfaceId, 0, 0, window_ms, threshold, {}});
+    GIOChannel *channel = g_io_channel_unix_new(fd);
+    watch->source_id = g_io_add_watch(channel,
+            static_cast<GIOCondition>(G_IO_IN | G_IO_HUP | G_IO_ERR),
+            &PeripheralManagerService::uartReadCallback, watch.get());
+    g_io_channel_unref(channel);
+    if (!watch->source_id)
+        return false;
+
+    uartReadWatches[interfaceId] = std::move(watch);
+    return true;
+}
+
+void PeripheralManagerService::stopUartReadWatch(const std::string &interfaceId)
+{
+    auto it = uartReadWatches.find(interfaceId);
+    if (it == uartReadWatches.end())
+        return;
+    if (it->second->source_id)
+        g_source_remove(it->second->source_id);
+    if (it->second->timer_id)
+        g_source_remove(it->second->timer_id);
+    uartReadWatches.erase(it);
+}
+
+// Sends the pending bytes to every subscriber. Returns false once nobody
+// is subscribed to the device any more.
+bool PeripheralManagerService::flushUartRead(UartReadWatch *watch)
+{
+    bool subscribed = false;
+    for (const char *format : {"byte", "text", kEncodingBase64, kEncodingHex}) {
+        std::string key = uartSubscriptionKey(watch->interfaceId, format);
+        if (LSSubscriptionGetHandleSubscribersCount(luna_handle->get(), key.c_str()) == 0)
+            continue;
+        subscribed = true;
+        if (watch->pending.empty())
+            continue;
+
+        std::string dataType = strcmp(format, "text") ? "byte" : "text";
+        std::string encoding = IsDataEncoding(format) ? format : "";
+        pbnjson::JValue response_json = pbnjson::JObject{
+            {"returnValue", true},
+            {"subscribed", true},
+            {"interfaceId", watch->interfaceId},
+            {"dataType", dataType}
+        };
+        putUartData(response_json, watch->pending.data(), watch->pending.size(), dataType, encoding);
+        LS::Error error;
+        LSSubscriptionReply(luna_handle->get(), key.c_str(), response_json.stringify().c_str(), error.get());
+    }
+    watch->pending.clear();
+    return subscribed;
+}
+
+bool PeripheralManagerService::onUartReadable(UartReadWatch *watch, GIOCondition condition)
+{
+    bool alive = !(condition & (G_IO_HUP | G_IO_ERR | G_IO_NVAL));
+    if (condition & G_IO_IN) {
+        std::vector<uint8_t> data;
+        int bytes_read = 0;
+        if (watch->client->UartDeviceRead(watch->interfaceId, &data,
+                kUartReadChunk, &bytes_read) != PeripheralManagerErrors::kNoError)
+            alive = false;
+        UartFramer *framer = watch->client->GetUartFramer(watch->interfaceId);
+        if (framer) {
+            // Frames are not coalesced, each one is pushed on its own.
+            UartFramer::Frames frames;
+            framer->Feed(data.data(), data.size(), &frames);
+            for (auto &frame : frames) {
+                watch->pending = std::move(frame);
+                alive = flushUartRead(watch) && alive;
+            }
+        } else {
+            watch->pending.insert(watch->pending.end(), data.begin(), data.end());
+        }
+    }
+
+    if (!alive || watch->pending.size() >= watch->threshold) {
+        if (watch->timer_id) {
+            g_source_remove(watch->timer_id);
+            watch->timer_id = 0;
+        }
+        alive = flushUartRead(watch) && alive;
+    } else if (!watch->pending.empty() && !watch->timer_id) {
+        watch->timer_id = g_timeout_add(watch->window_ms,
+                &PeripheralManagerService::uartFlushCallback, watch);
+    }
+
+    if (!alive) {
+        // Returning false removes the io source, so drop it from the watch.
+        watch->source_id = 0;
+        stopUartReadWatch(watch->interfaceId);
+        return false;
+    }
+    return true;
+}
+
+gboolean PeripheralManagerService::uartTransactCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    UartTransaction *transaction = static_cast<UartTransaction *>(data);
+    return transaction->service->onUartTransactReadable(transaction, condition) ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+}
+
+gboolean PeripheralManagerService::uartTransactTimeoutCallback(gpointer data)
+{
+    UartTransaction *transaction = static_cast<UartTransaction *>(data);
+    PeripheralManagerService *service = transaction->service;
+    // The timer is removed by returning G_SOURCE_REMOVE.
+    transaction->timer_id = 0;
+    service->finishUartTransaction(transaction->interfaceId, service->uartTransactResponse(transaction, true));
+    return G_SOURCE_REMOVE;
+}
+
+bool PeripheralManagerService::startUartTransaction(std::unique_ptr<UartTransaction> transaction, guint timeout_ms)
+{
+    int fd = -1;
+    transaction->client->GetuartPollingFd(transaction->interfaceId, &fd);
+    if (fd < 0)
+        return false;
+
+    GIOChannel *channel = g_io_channel_unix_new(fd);
+    transaction->source_id = g_io_add_watch(channel,
+            static_cast<GIOCondition>(G_IO_IN | G_IO_HUP | G_IO_ERR),
+            &PeripheralManagerService::uartTransactCallback, transaction.get());
+    g_io_channel_unref(channel);
+    if (!transaction->source_id)
+        return false;
+    transaction->timer_id = g_timeout_add(timeout_ms,
+            &PeripheralManagerService::uartTransactTimeoutCallback, transaction.get());
+
+    std::string interfaceId = transaction->interfaceId;
+    uartTransactions[interfaceId] = std::move(transaction);
+    return true;
+}
+
+// Sends the one reply of the transaction on |interfaceId| and drops it.
+void PeripheralManagerService::finishUartTransaction(const std::string &interfaceId, const pbnjson::JValue &response)
+{
+    auto it = uartTransactions.find(interfaceId);
+    if (it == uartTransactions.end())
+        return;
+    if (it->second->source_id)
+        g_source_remove(it->second->source_id);
+    if (it->second->timer_id)
+        g_source_remove(it->second->timer_id);
+    it->second->request.respond(response.stringify().c_str());
+    uartTransactions.erase(it);
+}
+
+pbnjson::JValue PeripheralManagerService::uartTransactResponse(UartTransaction *transaction, bool timed_out)
+{
+    pbnjson::JValue response_json = pbnjson::JObject{
+        {"returnValue", true},
+        {"interfaceId", transaction->interfaceId},
+        {"timedOut", timed_out},
+        {"dataType", transaction->dataType},
+        {"discarded", static_cast<int64_t>(transaction->discarded)}
+    };
+    putUartData(response_json, transaction->reply.data(), transaction->reply.size(),
+            transaction->dataType, transaction->encoding);
+    return response_json;
+}
+
+bool PeripheralManagerService::onUartTransactReadable(UartTransaction *transaction, GIOCondition condition)
+{
+    Status status = PeripheralManagerErrors::kNoError;
+    bool complete = false;
+    if (condition & G_IO_IN) {
+        // Never read past the requested size, the rest is not ours.
+        size_t chunk = kUartReadChunk;
+        if (transaction->size)
+            chunk = std::min(chunk, transaction->size - transaction->reply.size());
+        std::vector<uint8_t> data;
+        int bytes_read = 0;
+        status = transaction->client->UartDeviceRead(transaction->interfaceId, &data, chunk, &bytes_read);
+
+        UartFramer *framer = transaction->client->GetUartFramer(transaction->interfaceId);
+        if (framer) {
+            // The first frame is the reply, later ones are dropped.
+            UartFramer::Frames frames;
+            framer->Feed(data.data(), data.size(), &frames);
+            if (!frames.empty()) {
+                transaction->reply = std::move(frames.front());
+                for (size_t i = 1; i < frames.size(); i++)
+                    transaction->discarded += frames[i].size();
+                complete = true;
+            }
+        } else {
+            size_t received = transaction->reply.size() + data.size();
+            complete = AppendUartReply(data.data(), data.size(), transaction->terminator,
+                    transaction->size, &transaction->reply);
+            transaction->discarded += received - transaction->reply.size();
+        }
+    }
+
+    bool failed = status != PeripheralManagerErrors::kNoError ||
+            (condition & (G_IO_HUP | G_IO_ERR | G_IO_NVAL));
+    if (!complete && !failed)
+        return true;
+    // Returning false removes the io source, so drop it from the transaction.
+    transaction->source_id = 0;
+    finishUartTransaction(transaction->interfaceId, complete ? uartTransactResponse(transaction, false)
+            : statusResponse(status != PeripheralManagerErrors::kNoError ? status : PeripheralManagerErrors::kENODEV));
+    return false;
+}
+
+static std::string streamSocketPath(const std::string &kind, const std::string &device)
+{
+    std::string name = kind + "-" + device;
+    std::replace(name.begin(), name.end(), '/', '_');
+    return std::string(STREAM_SOCKET_DIR) + "/" + name + ".sock";
+}
+
+// Returns the hex token the peer of a new stream has to send in its hello,
+// so only the client the openStream reply went to can use the stream.
+static std::string streamToken()
+{
+    uint8_t bytes[16];
+    int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+    bool filled = fd >= 0 && read(fd, bytes, sizeof(bytes)) == sizeof(bytes);
+    if (fd >= 0)
+        close(fd);
+    return filled ? EncodeData(bytes, sizeof(bytes), kEncodingHex) : std::string();
+}
+
+// Ring size of a "ring" transport stream unless the request sets ringSize.
+static const size_t kDefaultStreamRingSize = 65536;
+
+// Reads the "transport" and "ringSize" of an openStream request; a ring
+// size of 0 means the socket transport.
+static bool getStreamTransport(const Param<std::string> &transport_param, const Param<int64_t> &ring_size_param,
+        bool ring_only, size_t *ring_size, std::string *error)
+{
+    std::string transport = transport_param.set ? transport_param.value : (ring_only ? "ring" : "socket");
+    if (transport != "ring" && (ring_only || transport != "socket")) {
+        *error = "transport value not allowed";
+        return false;
+    }
+    *ring_size = 0;
+    if (transport == "ring") {
+        int64_t size = ring_size_param.set ? ring_size_param.value : kDefaultStreamRingSize;
+        if (size <= 0 || size > (1 << 24)) {
+            *error = "ringSize value not allowed";
+            return false;
+        }
+        *ring_size = size;
+    }
+    return true;
+}
+
+static guint addStreamWatch(int fd, GIOFunc callback, gpointer data)
+{
+    GIOChannel *channel = g_io_channel_unix_new(fd);
+    guint source_id = g_io_add_watch(channel,
+            static_cast<GIOCondition>(G_IO_IN | G_IO_HUP | G_IO_ERR), callback, data);
+    g_io_channel_unref(channel);
+    return source_id;
+}
+
+static void sendStreamError(DataStream &stream, uint32_t sequence, Status status)
+{
+    int32_t code = status;
+    stream.Send(kStreamFrameError, sequence, reinterpret_cast<const uint8_t *>(&code), sizeof(code));
+}
+
+gboolean PeripheralManagerService::streamAcceptCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    StreamWatch *watch = static_cast<StreamWatch *>(data);
+    // A second client is refused while one is connected; the peer only
+    // gets data once its hello was accepted.
+    if (!watch->stream->Accept())
+        return G_SOURCE_CONTINUE;
+    watch->authenticated = false;
+    watch->peer_id = addStreamWatch(watch->stream->PeerFd(),
+            &PeripheralManagerService::streamPeerCallback, watch);
+    return G_SOURCE_CONTINUE;
+}
+
+gboolean PeripheralManagerService::streamPeerCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    StreamWatch *watch = static_cast<StreamWatch *>(data);
+    if ((condition & G_IO_IN) && watch->service->onStreamFrame(watch))
+        return G_SOURCE_CONTINUE;
+    watch->service->dropStreamPeer(watch);
+    return G_SOURCE_REMOVE;
+}
+
+gboolean PeripheralManagerService::streamDeviceCallback(GIOChannel *channel, GIOCondition condition, gpointer data)
+{
+    StreamWatch *watch = static_cast<StreamWatch *>(data);
+    if (watch->service->onStreamDeviceReadable(watch, condition))
+        return G_SOURCE_CONTINUE;
+    // Returning false removes the io source, so drop it from the watch.
+    watch->device_id = 0;
+    watch->service->stopStream(watch->key);
+    return G_SOURCE_REMOVE;
+}
+
+bool PeripheralManagerService::startStream(PeripheralManagerClient *client, const std::string &kind,
+        const std::string &device, size_t ring_size, std::string *path, std::string *token)
+{
+    // A device has one owner, so its stream belongs to that session; a
+    // stream another session left behind is not handed out.
+    std::string key = streamKey(kind, device);
+    auto it = streams.find(key);
+    if (it != streams.end()) {
+        if (it->second->client != client)
+            return false;
+        *path = it->second->stream->Path();
+        *token = it->second->token;
+        return true;
+    }
+
+    // Without a ring the UART is drained from the main loop.
+    int fd = -1;
+    if (kind == "uart" && !ring_size) {
+        client->GetuartPollingFd(device, &fd);
+        if (fd < 0)
+            return false;
+    }
+
+    std::string stream_token = streamToken();
+    if (stream_token.empty())
+        return false;
+    g_mkdir_with_parents(STREAM_SOCKET_DIR, 0750);
+    std::shared_ptr<DataStream> stream(DataStream::Listen(streamSocketPath(kind, device)));
+    if (!stream)
+        return false;
+    std::shared_ptr<SharedRing> ring;
+    if (ring_size) {
+        ring.reset(SharedRing::Create(kind + "-" + device, ring_size).release());
+        if (!ring)
+            return false;
+    }
+
+    StreamWatch *watch = new StreamWatch{this, client, key, kind, device, stream, ring,
+            stream_token, false, static_cast<uid_t>(-1), 0, 0, 0, 0};
+    streams[key].reset(watch);
+    watch->listen_id = addStreamWatch(stream->ListenFd(),
+            &PeripheralManagerService::streamAcceptCallback, watch);
+    bool started = watch->listen_id != 0;
+    if (fd >= 0) {
+        watch->device_id = addStreamWatch(fd, &PeripheralManagerService::streamDeviceCallback, watch);
+        started = started && watch->device_id;
+    }
+    if (ring && kind == "uart")
+        started = started && client->SetUartReaderSink(device, ring) == PeripheralManagerErrors::kNoError;
+    if (kind == "gpio")
+        started = started && startGpioEdgeWatch(client, device);
+    if (!started) {
+        stopStream(key);
+        return false;
+    }
+    *path = stream->Path();
+    *token = stream_token;
+    return true;
+}
+
+// Stops the stream at |key| for |client|. Returns false, leaving it
+// running, if another session opened it.
+bool PeripheralManagerService::stopStream(PeripheralManagerClient *client, const std::string &key)
+{
+    auto it = streams.find(key);
+    if (it == streams.end())
+        return true;
+    if (it->second->client != client)
+        return false;
+    stopStream(key);
+    return true;
+}
+
+void PeripheralManagerService::stopStream(const std::string &key)
+{
+    auto it = streams.find(key);
+    if (it == streams.end())
+        return;
+    StreamWatch *watch = it->second.get();
+    for (guint source_id : {watch->listen_id, watch->peer_id, watch->device_id}) {
+        if (source_id)
+            g_source_remove(source_id);
+    }
+    if (watch->ring && watch->kind == "uart")
+        watch->client->SetUartReaderSink(watch->device, nullptr);
+    // Queued SPI frames still hold the stream; they find no peer to answer.
+    watch->stream->Disconnect();
+    streams.erase(it);
+}
+
+void PeripheralManagerService::dropStreamPeer(StreamWatch *watch)
+{
+    // The peer source is removed by the caller; the stream keeps listening
+    // so the client can connect again.
+    watch->peer_id = 0;
+    watch->authenticated = false;
+    watch->stream->Disconnect();
+}
+
+// Checks the hello a new peer opens with. The token proves the peer got
+// the openStream reply; once a peer was accepted, later ones must also run
+// as the same user. Returns false to drop the peer.
+bool PeripheralManagerService::acceptStreamPeer(StreamWatch *watch, const StreamFrameHeader &header,
+        const std::vector<uint8_t> &payload)
+{
+    uid_t uid = watch->stream->PeerUid();
+    if (header.type != kStreamFrameHello ||
+            std::string(payload.begin(), payload.end()) != watch->token ||
+            (watch->peer_uid != static_cast<uid_t>(-1) && uid != watch->peer_uid)) {
+        AppLogWarning() << "Refused pid " << watch->stream->PeerPid() << " on stream " << watch->key;
+        return false;
+    }
+    watch->peer_uid = uid;
+    watch->authenticated = true;
+    if (watch->ring) {
+        uint32_t capacity = watch->ring->Capacity();
+        return watch->stream->Send(kStreamFrameRing, 0, reinterpret_cast<const uint8_t *>(&capacity),
+                sizeof(capacity), {watch->ring->MemFd(), watch->ring->EventFd()});
+    }
+    return true;
+}
+
+// Handles one frame from the peer. Returns false if the peer has gone.
+bool PeripheralManagerService::onStreamFrame(StreamWatch *watch)
+{
+    StreamFrameHeader header;
+    std::vector<uint8_t> payload;
+    if (!watch->stream->Receive(&header, &payload))
+        return false;
+    if (!watch->authenticated)
+        return acceptStreamPeer(watch, header, payload);
+    if (header.type != kStreamFrameData || watch->kind == "gpio")
+        return true;
+
+    if (watch->kind == "uart") {
+        int bytes_written = 0;
+        Status status = watch->client->UartDeviceWrite(
+                watch->client->GetUartHandle(watch->device), payload, &bytes_written);
+        if (status != PeripheralManagerErrors::kNoError)
+            sendStreamError(*watch->stream, header.sequence, status);
+        return true;
+    }
+
+    PeripheralManagerClient *client = watch->client;
+    std::shared_ptr<DataStream> stream = watch->stream;
+    uint32_t sequence = header.sequence;
+    int32_t handle = client->GetSpiHandle(watch->device);
+    busWorker(spiWorkerKey(client, handle, watch->device))->Post([=]() mutable {
+        std::vector<uint8_t> rx_data(payload.size());
+        Status status = client->SpiDeviceTransfer(handle, payload, &rx_data, payload.size());
+        if (status != PeripheralManagerErrors::kNoError)
+            sendStreamError(*stream, sequence, status);
+        else
+            stream->Send(kStreamFrameData, sequence, rx_data.data(), rx_data.size());
+    });
+    return true;
+}
+
+// Forwards what the UART received, a data frame per frame on a framed
+// device. Bytes that arrive while no client is connected, or before its
+// hello was accepted, are dropped.
+bool PeripheralManagerService::onStreamDeviceReadable(StreamWatch *watch, GIOCondition condition)
+{
+    if (!(condition & G_IO_IN))
+        return false;
+    std::vector<uint8_t> data;
+    int bytes_read = 0;
+    if (watch->client->UartDeviceRead(watch->client->GetUartHandle(watch->device),
+            &data, kUartReadChunk, &bytes_read) != PeripheralManagerErrors::kNoError)
+        return false;
+    if (!watch->authenticated)
+        return true;
+    UartFramer *framer = watch->client->GetUartFramer(watch->device);
+    if (framer) {
+        UartFramer::Frames frames;
+        framer->Feed(data.data(), data.size(), &frames);
+        for (const auto &frame : frames)
+            watch->stream->Send(kStreamFrameData, watch->sequence++, frame.data(), frame.size());
+    } else if (!data.empty()) {
+        watch->stream->Send(kStreamFrameData, watch->sequence++, data.data(), data.size());
+    }
+    return true;
+}
+
+// Properties of the gpio/* requests. The table of each method names the
+// ones it accepts.
+struct GpioParams {
+    Param<bool> subscribe;
+    Param<std::string> pin;
+    Param<std::string> direction;
+    Param<int64_t> handle;
+    // "value"
+    Param<std::string> level;
+    Param<std::string> edge;
+    Param<std::string> group;
+    Param<pbnjson::JValue> pins;
+    Param<int64_t> values;
+    Param<int64_t> mask;
+    Param<std::string> id;
+    Param<std::string> transport;
+    Param<int64_t> ringSize;
+};
+
+static const ParamSpec<GpioParams> kListGpioParams[] = {
+    {"subscribe", &GpioParams::subscribe},
+};
+
+bool PeripheralManagerService::ListGpio(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kListGpioParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        else {
+            std::vector<DevicesPinInfo> gpios;
+            client->ListGpio(gpios);
+            pbnjson::JValue gpioList = pbnjson::JArray();
+            for (const auto& gpio : gpios) {
+                pbnjson::JValue gpioJson  = pbnjson::JObject{{"pin", gpio.name},{"status", gpio.status}};
+                gpioList << gpioJson;
+            }
+            subscription = params.subscribe.value;
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"subscribed", subscription},
+                {"gpioList", gpioList}};
+            request.respond(response_json.stringify().c_str());
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kOpenGpioParams[] = {
+    {"pin", &GpioParams::pin},
+};
+
+bool PeripheralManagerService::OpenGpio(LSMessage &ls_message) {
+    bool ret = false;
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    std::string pin ;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenGpioParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        if (params.pin.set)
+        {
+            int32_t handle = 0;
+            Status status = client->OpenGpio(pin, &handle);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"handle", handle}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+
+static const ParamSpec<GpioParams> kReleaseGpioParams[] = {
+    {"pin", &GpioParams::pin},
+};
+
+bool PeripheralManagerService::ReleaseGpio(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    std::string pin;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kReleaseGpioParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        if (params.pin.set)
+        {
+            // Only the session that opened the pin may stop its stream
+            // and edge watch.
+            if (client->GetGpioHandle(pin)) {
+                stopStream(client, streamKey("gpio", pin));
+                stopGpioEdgeWatch(client, pin);
+            }
+            Status status = client->ReleaseGpio(pin);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kSetGpioDirectionParams[] = {
+    {"pin", &GpioParams::pin},
+    {"direction", &GpioParams::direction},
+};
+
+bool PeripheralManagerService::SetGpioDirection(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    int direction =0;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSetGpioDirectionParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        std::string dir = params.direction.value;
+        if(params.pin.set &&  params.direction.set)
+        {
+            if(dir == "in") direction = 0;
+            else if(dir == "outHigh") direction = 1;
+            else if(dir == "outLow") direction = 2;
+            else {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", dir+ " value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            Status status = client->SetGpioDirection(pin, direction);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin/direction  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<GpioParams> kSetGpioValueParams[] = {
+    {"handle", &GpioParams::handle},
+    {"pin", &GpioParams::pin},
+    {"value", &GpioParams::level},
+};
+
+bool PeripheralManagerService::SetGpioValue(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    bool value = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSetGpioValueParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        std::string val = params.level.value;
+        if ((params.handle.set || params.pin.set) && params.level.set)
+        {
+            if(val == "high") value = true;
+            else if(val == "low") value = false;
+            else {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", val+ " value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            int32_t handle = params.handle.value;
+            if (!handle)
+                handle = client->GetGpioHandle(pin);
+            Status status = client->SetGpioValue(handle, value);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin/value is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kGetGpioValueParams[] = {
+    {"handle", &GpioParams::handle},
+    {"pin", &GpioParams::pin},
+    {"subscribe", &GpioParams::subscribe},
+};
+
+bool PeripheralManagerService::GetGpioValue(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    bool ret = false;
+    bool value = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGetGpioValueParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        subscription = params.subscribe.value;
+        if (params.handle.set || params.pin.set)
+        {
+            int32_t handle = params.handle.value;
+            if (!handle)
+                handle = client->GetGpioHandle(pin);
+            // Subscriptions are kept per pin, so a handle-only request
+            // subscribes under the pin it was opened for.
+            else if (pin.empty())
+                pin = client->GetGpioName(handle);
+            Status status = client->GetGpioValue(handle, &value);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            std::string val = value ? "high" : "low";
+            if (subscription) {
+                // Edges are pushed from the pin's edge fd, see gpio/setEdge.
+                LS::Error error;
+                subscription = LSMessageIsSubscription(&ls_message) &&
+                        startGpioEdgeWatch(client, pin) &&
+                        LSSubscriptionAdd(luna_handle->get(), gpioSubscriptionKey(pin).c_str(),
+                                &ls_message, error.get());
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"subscribed", subscription},
+                {"value", val}
+            };
+            // The pin needs an edge from gpio/setEdge to be watched.
+            if (params.subscribe.value && !subscription) {
+                response_json.put("returnValue", false);
+                response_json.put("errorText", "Failed to subscribe");
+            }
+            request.respond(response_json.stringify().c_str());
+        }
+        else{
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<GpioParams> kSetGpioEdgeParams[] = {
+    {"pin", &GpioParams::pin},
+    {"edge", &GpioParams::edge},
+};
+
+bool PeripheralManagerService::SetGpioEdge(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    int edge = 0;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSetGpioEdgeParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        std::string edge_type = params.edge.value;
+        if (params.pin.set && params.edge.set)
+        {
+            if(edge_type == "none") edge = kEdgeNone;
+            else if(edge_type == "rising") edge = kEdgeRising;
+            else if(edge_type == "falling") edge = kEdgeFalling;
+            else if(edge_type == "both") edge = kEdgeBoth;
+            else {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", edge_type+ " value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            Status status = client->SetGpioEdge(pin, edge);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin/edge is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static std::vector<std::string> gpioPinList(const pbnjson::JValue &pins)
+{
+    std::vector<std::string> names;
+    int size = pins.arraySize();
+    for (int i = 0; i < size; i++)
+        names.push_back(pins[i].asString());
+    return names;
+}
+
+static const ParamSpec<GpioParams> kOpenGpioGroupParams[] = {
+    {"group", &GpioParams::group},
+    {"pins", &GpioParams::pins, ParamType::kArray},
+    {"direction", &GpioParams::direction},
+};
+
+bool PeripheralManagerService::OpenGpioGroup(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    int direction = -1;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenGpioGroupParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string group = params.group.value;
+        if (params.group.set && params.pins.set)
+        {
+            if (params.direction.set) {
+                std::string dir = params.direction.value;
+                if(dir == "in") direction = 0;
+                else if(dir == "outHigh") direction = 1;
+                else if(dir == "outLow") direction = 2;
+                else {
+                    response_json = pbnjson::JObject{{"returnValue", false},{"errorText", dir+ " value not allowed"}};
+                    request.respond(response_json.stringify().c_str());
+                    return true;
+                }
+            }
+            Status status = client->OpenGpioGroup(group, gpioPinList(params.pins.value));
+            if (status == PeripheralManagerErrors::kNoError && direction >= 0) {
+                status = client->SetGpioGroupDirection(group, direction);
+                if (status != PeripheralManagerErrors::kNoError)
+                    client->ReleaseGpioGroup(group);
+            }
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "group/pins is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kReleaseGpioGroupParams[] = {
+    {"group", &GpioParams::group},
+};
+
+bool PeripheralManagerService::ReleaseGpioGroup(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kReleaseGpioGroupParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string group = params.group.value;
+        if (params.group.set)
+        {
+            Status status = client->ReleaseGpioGroup(group);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "group is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kSetGpioValuesParams[] = {
+    {"pins", &GpioParams::pins, ParamType::kArray},
+    {"group", &GpioParams::group},
+    {"values", &GpioParams::values},
+    {"mask", &GpioParams::mask},
+};
+
+bool PeripheralManagerService::SetGpioValues(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSetGpioValuesParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.pins.set != params.group.set) && params.values.set)
+        {
+            uint64_t values = params.values.value;
+            uint64_t mask = params.mask.set ? params.mask.value : ~0ULL;
+            Status status;
+            if (params.group.set)
+                status = client->SetGpioGroupValues(params.group.value, values, mask);
+            else
+                status = client->SetGpioValues(gpioPinList(params.pins.value), values, mask);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pins or group/values is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kGetGpioValuesParams[] = {
+    {"pins", &GpioParams::pins, ParamType::kArray},
+    {"group", &GpioParams::group},
+};
+
+bool PeripheralManagerService::GetGpioValues(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool ret = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGetGpioValuesParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.pins.set != params.group.set)
+        {
+            uint64_t values = 0;
+            Status status;
+            if (params.group.set)
+                status = client->GetGpioGroupValues(params.group.value, &values);
+            else
+                status = client->GetGpioValues(gpioPinList(params.pins.value), &values);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"values", static_cast<int64_t>(values)}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pins or group is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kGetGpioPollingFdParams[] = {
+    {"id", &GpioParams::id},
+};
+
+bool PeripheralManagerService::GetGpioPollingFd(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    int fd = 0 ;
+    int ret;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }
+    else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGetGpioPollingFdParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.id.value;
+        if (params.id.set)
+        {
+            Status status = client->GetGpioPollingFd(pin, &fd);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"fd", fd}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "id is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<GpioParams> kOpenGpioStreamParams[] = {
+    {"pin", &GpioParams::pin},
+    {"transport", &GpioParams::transport},
+    {"ringSize", &GpioParams::ringSize},
+};
+
+bool PeripheralManagerService::OpenGpioStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenGpioStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        size_t ring_size = 0;
+        if (!getStreamTransport(params.transport, params.ringSize, true, &ring_size, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.pin.set)
+        {
+            std::string pin = params.pin.value;
+            std::string path;
+            std::string token;
+            if (!client->GetGpioHandle(pin))
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            // Edges come from the pin's edge fd, so gpio/setEdge goes first.
+            else if (!startStream(client, "gpio", pin, ring_size, &path, &token))
+                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to open stream"}};
+            else
+                response_json = pbnjson::JObject{{"returnValue", true}, {"path", path}, {"token", token}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<GpioParams> kCloseGpioStreamParams[] = {
+    {"pin", &GpioParams::pin},
+};
+
+bool PeripheralManagerService::CloseGpioStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kCloseGpioStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.pin.set)
+        {
+            if (stopStream(client, streamKey("gpio", params.pin.value)))
+                response_json = pbnjson::JObject{{"returnValue", true}};
+            else
+                response_json = statusResponse(PeripheralManagerErrors::kEPERM);
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+// Properties of the uart/* requests.
+struct UartParams {
+    Param<bool> subscribe;
+    Param<std::string> interfaceId;
+    Param<pbnjson::JValue> config;
+    Param<int64_t> baudrate;
+    Param<int64_t> handle;
+    Param<pbnjson::JValue> data;
+    Param<std::string> dataType;
+    Param<int64_t> size;
+    Param<std::string> encoding;
+    Param<int64_t> coalesceMs;
+    Param<int64_t> coalesceBytes;
+    Param<pbnjson::JValue> terminator;
+    Param<int64_t> timeoutMs;
+    Param<std::string> transport;
+    Param<int64_t> ringSize;
+    Param<std::string> id;
+};
+
+// Gets the device of a request given by "handle" or "interfaceId" under
+// both: watches, transactions, streams and subscriptions are kept per
+// interface. Returns false if the client does not have it open.
+static bool getUartDevice(PeripheralManagerClient *client, const UartParams &params,
+        int32_t *handle, std::string *interfaceId)
+{
+    *handle = params.handle.value;
+    *interfaceId = params.interfaceId.value;
+    if (*handle)
+        *interfaceId = client->GetUartName(*handle);
+    else
+        *handle = client->GetUartHandle(*interfaceId);
+    return *handle && !interfaceId->empty();
+}
+
+static const ParamSpec<UartParams> kListUartDevicesParams[] = {
+    {"subscribe", &UartParams::subscribe},
+};
+
+bool PeripheralManagerService::ListUartDevices(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kListUartDevicesParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }else {
+            subscription = params.subscribe.value;
+            std::vector<DevicesPinInfo> devices;
+            client->ListUartDevices(devices);
+            if (subscription) {
+                LS::Error error;
+                subscription = LSMessageIsSubscription(&ls_message) &&
+                        LSSubscriptionAdd(luna_handle->get(), kUartListSubscriptionKey, &ls_message, error.get());
+            }
+            pbnjson::JValue device_list = pbnjson::JArray();
+            for (const auto& device : devices) {
+                pbnjson::JValue uartJson  = pbnjson::JObject{{"interfaceId", device.name},{"status", device.status}};
+                device_list << uartJson;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"subscribed", subscription},
+                {"uartList", device_list}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kOpenUartDeviceParams[] = {
+    {"interfaceId", &UartParams::interfaceId},
+    {"config", &UartParams::config, ParamType::kObject},
+};
+
+bool PeripheralManagerService::OpenUartDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenUartDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set)
+        {
+            const std::string interfaceId = params.interfaceId.value;
+            bool canonical = false;
+            int buffer_size = 0;
+            if(params.config.set)
+            {
+                canonical = params.config.value["canonical"].asBool();
+                // Buffer the device in the background, see uart/getStats.
+                if (params.config.value.hasKey("bufferSize"))
+                    buffer_size = params.config.value["bufferSize"].asNumber<int>();
+            }
+            if (buffer_size < 0) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "bufferSize value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            // Deliver complete frames instead of raw bytes, see UartFramer.
+            std::unique_ptr<UartFramer> framer;
+            if (params.config.set && !getUartFramer(params.config.value, &framer)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "framing value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            int32_t handle = 0;
+            Status status = client->OpenUartDevice(interfaceId, canonical, buffer_size, &handle);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            client->SetUartFramer(interfaceId, std::move(framer));
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"handle", handle}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+
+static const ParamSpec<UartParams> kReleaseUartDeviceParams[] = {
+    {"interfaceId", &UartParams::interfaceId},
+};
+
+bool PeripheralManagerService::ReleaseUartDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kReleaseUartDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set)
+        {
+            const std::string interfaceId = params.interfaceId.value;
+            stopUartReadWatch(interfaceId);
+            stopStream(client, streamKey("uart", interfaceId));
+            finishUartTransaction(interfaceId, statusResponse(PeripheralManagerErrors::kENODEV));
+            Status status = client->ReleaseUartDevice(interfaceId);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kSetUartDeviceBaudrateParams[] = {
+    {"baudrate", &UartParams::baudrate},
+    {"interfaceId", &UartParams::interfaceId},
+};
+
+bool PeripheralManagerService::SetUartDeviceBaudrate(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSetUartDeviceBaudrateParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set && params.baudrate.set)
+        {
+            const std::string interfaceId = params.interfaceId.value;
+            int32_t baudrate = params.baudrate.value;
+            Status status = client->SetUartDeviceBaudrate(interfaceId, baudrate);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/baudrate is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kUartDeviceWriteParams[] = {
+    {"handle", &UartParams::handle},
+    {"data", &UartParams::data, ParamType::kAny},
+    {"interfaceId", &UartParams::interfaceId},
+    {"dataType", &UartParams::dataType},
+    {"size", &UartParams::size},
+    {"encoding", &UartParams::encoding},
+};
+
+bool PeripheralManagerService::UartDeviceWrite(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kUartDeviceWriteParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.interfaceId.set) && params.data.set && params.dataType.set && params.size.set)
+        {
+            const std::string interfaceId = params.interfaceId.value;
+
+            std::string dataType = params.dataType.value;
+            int size = params.size.value;
+            std::vector<uint8_t> data;
+
+            if(dataType == "text") {
+                std::string strData = params.data.value.asString();
+                const char * cptr = strData.data();
+                int size = strData.size();
+                for(int i = 0; i < size; i++) {
+                    data.push_back(cptr[i]);
+                }
+            }
+            else if (!getBinaryData(params.data.value, encoding, &data)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+
+            int bytes_written = 0;
+
+            int32_t handle = params.handle.value;
+            if (!handle)
+                handle = client->GetUartHandle(interfaceId);
+            Status status = client->UartDeviceWrite(handle, data, &bytes_written);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"size", bytes_written}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/data/dataType/size is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kUartDeviceReadParams[] = {
+    {"handle", &UartParams::handle},
+    {"size", &UartParams::size},
+    {"interfaceId", &UartParams::interfaceId},
+    {"dataType", &UartParams::dataType},
+    {"subscribe", &UartParams::subscribe},
+    {"coalesceMs", &UartParams::coalesceMs},
+    {"coalesceBytes", &UartParams::coalesceBytes},
+    {"encoding", &UartParams::encoding},
+};
+
+bool PeripheralManagerService::UartDeviceRead(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kUartDeviceReadParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.handle.set || params.interfaceId.set)
+        {
+            int size = 1024;
+            if (params.size.set)
+            {
+                size = params.size.value;
+            }
+            std::string dataType = "byte";
+            if (params.dataType.set)
+            {
+                if(params.dataType.value == "text")
+                    dataType = "text";
+            }
+
+            // With subscribe, later data is pushed once coalesceBytes bytes
+            // arrived (default size) or coalesceMs passed (default 20).
+            subscription = params.subscribe.value;
+            guint window_ms = kUartCoalesceMs;
+            if (params.coalesceMs.set)
+                window_ms = params.coalesceMs.value;
+            int threshold = size;
+            if (params.coalesceBytes.set)
+                threshold = params.coalesceBytes.value;
+            if (size <= 0 || threshold <= 0) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "size value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+
+            // Resolved before reading, so that a subscription that cannot
+            // be kept is refused without consuming any input.
+            int32_t handle = 0;
+            std::string interfaceId;
+            if (!getUartDevice(client, params, &handle, &interfaceId)) {
+                request.respond(statusResponse(PeripheralManagerErrors::kEPERM).stringify().c_str());
+                return true;
+            }
+            if (subscription && LSMessageIsSubscription(&ls_message) && !uartReadWatches.count(interfaceId) &&
+                    (streams.count(streamKey("uart", interfaceId)) || uartTransactions.count(interfaceId))) {
+                request.respond(statusResponse(PeripheralManagerErrors::kEBUSY).stringify().c_str());
+                return true;
+            }
+
+            std::vector<uint8_t> data;
+            data.resize(size);
+            int bytes_read = data.size();
+
+            Status status = client->UartDeviceRead(handle, &data, data.size(), &bytes_read);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            if (subscription) {
+                LS::Error error;
+                subscription = LSMessageIsSubscription(&ls_message) &&
+                        startUartReadWatch(client, interfaceId, window_ms, threshold) &&
+                        LSSubscriptionAdd(luna_handle->get(), uartSubscriptionKey(interfaceId, uartDataFormat(dataType, encoding)).c_str(),
+                                &ls_message, error.get());
+            }
+
+            response_json = pbnjson::JObject {
+                {"returnValue", true},
+                {"subscribed", subscription},
+                {"dataType", dataType}
+            };
+            putUartReadData(response_json, client->GetUartFramer(handle), data.data(), bytes_read, dataType, encoding);
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<UartParams> kUartDeviceTransactParams[] = {
+    {"handle", &UartParams::handle},
+    {"interfaceId", &UartParams::interfaceId},
+    {"data", &UartParams::data, ParamType::kAny},
+    {"dataType", &UartParams::dataType},
+    {"encoding", &UartParams::encoding},
+    {"terminator", &UartParams::terminator, ParamType::kAny},
+    {"size", &UartParams::size},
+    {"timeoutMs", &UartParams::timeoutMs},
+};
+
+// Default uart/transact reply timeout.
+static const int kUartTransactTimeoutMs = 1000;
+
+// Reads uart/transact "data" or "terminator": a string with the "text"
+// data type, binary data otherwise.
+static bool getUartData(const pbnjson::JValue &value, const std::string &dataType,
+        const std::string &encoding, std::vector<uint8_t> *data)
+{
+    if (dataType != "text")
+        return getBinaryData(value, encoding, data);
+    if (!value.isString())
+        return false;
+    std::string text = value.asString();
+    data->assign(text.begin(), text.end());
+    return true;
+}
+
+// Writes "data" and replies once with what the device sent back: up to and
+// including "terminator", "size" bytes, the first frame on a framed device
+// or whatever arrived within "timeoutMs", flagged by "timedOut". Input
+// pending before the write is flushed first. Bytes that came in the same
+// read after the end of the reply are dropped and counted in "discarded".
+bool PeripheralManagerService::UartDeviceTransact(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kUartDeviceTransactParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.interfaceId.set) && params.data.set)
+        {
+            std::string dataType = params.dataType.value == "text" ? "text" : "byte";
+            std::vector<uint8_t> data;
+            std::vector<uint8_t> terminator;
+            int size = params.size.set ? params.size.value : 0;
+            int timeout_ms = params.timeoutMs.set ? params.timeoutMs.value : kUartTransactTimeoutMs;
+            if (!getUartData(params.data.value, dataType, encoding, &data))
+                invalid_params = "data value not allowed";
+            else if (params.terminator.set &&
+                    (!getUartData(params.terminator.value, dataType, encoding, &terminator) || terminator.empty()))
+                invalid_params = "terminator value not allowed";
+            else if (params.size.set && size <= 0)
+                invalid_params = "size value not allowed";
+            else if (timeout_ms <= 0)
+                invalid_params = "timeoutMs value not allowed";
+            if (!invalid_params.empty()) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+
+            int32_t handle = 0;
+            std::string interfaceId;
+            if (!getUartDevice(client, params, &handle, &interfaceId)) {
+                request.respond(statusResponse(PeripheralManagerErrors::kENODEV).stringify().c_str());
+                return true;
+            }
+            // Anything else reading the device would take part of the reply.
+            if (uartTransactions.count(interfaceId) || uartReadWatches.count(interfaceId) ||
+                    streams.count(streamKey("uart", interfaceId))) {
+                request.respond(statusResponse(PeripheralManagerErrors::kEBUSY).stringify().c_str());
+                return true;
+            }
+            // Stale input would otherwise start the reply.
+            Status status = client->UartDeviceFlushInput(handle);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            int bytes_written = 0;
+            status = client->UartDeviceWrite(handle, data, &bytes_written);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            std::unique_ptr<UartTransaction> transaction(new UartTransaction{
+                    this, client, interfaceId, request, terminator, static_cast<size_t>(size),
+                    dataType, encoding, 0, 0, {}, 0});
+            // The reply is sent once the transaction completes.
+            if (startUartTransaction(std::move(transaction), timeout_ms))
+                return true;
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to watch the device"}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/data is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kgetBaudrateParams[] = {
+    {"interfaceId", &UartParams::interfaceId},
+};
+
+bool PeripheralManagerService::getBaudrate(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    uint32_t baudrate = 0;
+    int ret;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kgetBaudrateParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string interfaceId = params.interfaceId.value;
+        if (params.interfaceId.set)
+        {
+            Status status = client->getBaudrate(interfaceId, &baudrate);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"baudrate", (int)baudrate}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else{
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<UartParams> kGetUartReaderStatsParams[] = {
+    {"interfaceId", &UartParams::interfaceId},
+};
+
+bool PeripheralManagerService::GetUartReaderStats(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGetUartReaderStatsParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string interfaceId = params.interfaceId.value;
+        if (params.interfaceId.set)
+        {
+            UartReaderStats stats;
+            Status status = client->GetUartReaderStats(interfaceId, &stats);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"bufferSize", static_cast<int64_t>(stats.capacity)},
+                {"buffered", static_cast<int64_t>(stats.buffered)},
+                {"received", static_cast<int64_t>(stats.received)},
+                {"overflow", static_cast<int64_t>(stats.overflow)}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else{
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<UartParams> kOpenUartStreamParams[] = {
+    {"handle", &UartParams::handle},
+    {"interfaceId", &UartParams::interfaceId},
+    {"transport", &UartParams::transport},
+    {"ringSize", &UartParams::ringSize},
+};
+
+bool PeripheralManagerService::OpenUartStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenUartStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        size_t ring_size = 0;
+        if (!getStreamTransport(params.transport, params.ringSize, false, &ring_size, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.handle.set || params.interfaceId.set)
+        {
+            int32_t handle = 0;
+            std::string interfaceId;
+            std::string path;
+            std::string token;
+            if (!getUartDevice(client, params, &handle, &interfaceId))
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            // uart/read subscribers, a transaction and a stream would split the input.
+            else if (uartReadWatches.count(interfaceId) || uartTransactions.count(interfaceId))
+                response_json = statusResponse(PeripheralManagerErrors::kEBUSY);
+            else if (!startStream(client, "uart", interfaceId, ring_size, &path, &token))
+                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to open stream"}};
+            else
+                response_json = pbnjson::JObject{{"returnValue", true}, {"path", path}, {"token", token}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kCloseUartStreamParams[] = {
+    {"handle", &UartParams::handle},
+    {"interfaceId", &UartParams::interfaceId},
+};
+
+bool PeripheralManagerService::CloseUartStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kCloseUartStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.handle.set || params.interfaceId.set)
+        {
+            int32_t handle = 0;
+            std::string interfaceId;
+            if (getUartDevice(client, params, &handle, &interfaceId) &&
+                    stopStream(client, streamKey("uart", interfaceId)))
+                response_json = pbnjson::JObject{{"returnValue", true}};
+            else
+                response_json = statusResponse(PeripheralManagerErrors::kEPERM);
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+// Highest Modbus unit address; 0 is broadcast, which gets no reply.
+static const int kModbusMaxUnit = 247;
+
+// Default time a Modbus slave gets to start its reply.
+static const int kModbusResponseTimeoutMs = 1000;
+// A stuck slave holds every queued request and poll for this long at most.
+static const int kModbusMaxResponseTimeoutMs = 10000;
+
+// Properties of the modbus/* requests.
+struct ModbusParams {
+    Param<std::string> interfaceId;
+    Param<int64_t> responseTimeoutMs;
+    Param<int64_t> unit;
+    Param<int64_t> address;
+    Param<int64_t> count;
+    Param<bool> cached;
+    Param<pbnjson::JValue> values;
+    Param<int64_t> intervalMs;
+    Param<int64_t> pollId;
+};
+
+// Reads the "unit" and "address" of a modbus/* request. Returns false if
+// either is out of range.
+static bool getModbusTarget(const ModbusParams &params, uint8_t *unit, uint16_t *address)
+{
+    int64_t unit_value = params.unit.value;
+    int64_t address_value = params.address.value;
+    if (unit_value < 1 || unit_value > kModbusMaxUnit || address_value < 0 || address_value > 0xffff)
+        return false;
+    *unit = unit_value;
+    *address = address_value;
+    return true;
+}
+
+// Reads the "count" of a modbus/* request, at most |max| registers that
+// fit in the address space from |address|.
+static bool getModbusCount(const ModbusParams &params, uint16_t address, int max, uint16_t *count)
+{
+    int64_t count_value = params.count.value;
+    if (count_value < 1 || count_value > max || address + count_value > 0x10000)
+        return false;
+    *count = count_value;
+    return true;
+}
+
+static pbnjson::JValue modbusResponse(const ModbusResult &result)
+{
+    if (result.error != ModbusError::kNone) {
+        pbnjson::JValue response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", ModbusErrorText(result.error)}};
+        if (result.error == ModbusError::kException)
+            response_json.put("exceptionCode", result.exception_code);
+        return response_json;
+    }
+    pbnjson::JValue response_json = pbnjson::JObject{{"returnValue", true}};
+    if (!result.registers.empty()) {
+        pbnjson::JValue registers = pbnjson::JArray();
+        for (uint16_t value : result.registers)
+            registers << value;
+        response_json.put("registers", registers);
+    }
+    return response_json;
+}
+
+ModbusMaster::Callback PeripheralManagerService::modbusReply(LSMessage &ls_message)
+{
+    // The copied LS::Message keeps the request referenced until the reply.
+    LS::Message request(&ls_message);
+    return [request](const ModbusResult &result) {
+        DeferredReply *reply = new DeferredReply{request, modbusResponse(result).stringify()};
+        g_idle_add(deferredReplyCallback, reply);
+    };
+}
+
+static const ParamSpec<ModbusParams> kOpenModbusParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+    {"responseTimeoutMs", &ModbusParams::responseTimeoutMs},
+};
+
+bool PeripheralManagerService::OpenModbus(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenModbusParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        int64_t timeout_ms = params.responseTimeoutMs.set ? params.responseTimeoutMs.value
+                : kModbusResponseTimeoutMs;
+        if (timeout_ms <= 0 || timeout_ms > kModbusMaxResponseTimeoutMs)
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "responseTimeoutMs value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set)
+        {
+            std::string interfaceId = params.interfaceId.value;
+            if (!client->GetUartHandle(interfaceId))
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            // The master owns the line, nothing else may read it.
+            else if (uartReadWatches.count(interfaceId) || uartTransactions.count(interfaceId) ||
+                    streams.count(streamKey("uart", interfaceId)))
+                response_json = statusResponse(PeripheralManagerErrors::kEBUSY);
+            else
+                response_json = statusResponse(client->StartUartModbus(interfaceId, timeout_ms));
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<ModbusParams> kCloseModbusParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+};
+
+bool PeripheralManagerService::CloseModbus(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kCloseModbusParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set)
+        {
+            // Requests still queued are answered as stopped.
+            response_json = statusResponse(client->StopUartModbus(params.interfaceId.value));
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<ModbusParams> kModbusReadHoldingRegistersParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+    {"unit", &ModbusParams::unit},
+    {"address", &ModbusParams::address},
+    {"count", &ModbusParams::count},
+    {"cached", &ModbusParams::cached},
+};
+
+// Answers from the cache of a poll holding the registers unless "cached"
+// is false, and from the bus otherwise.
+bool PeripheralManagerService::ModbusReadHoldingRegisters(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kModbusReadHoldingRegistersParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set && params.unit.set && params.address.set && params.count.set)
+        {
+            uint8_t unit = 0;
+            uint16_t address = 0;
+            uint16_t count = 0;
+            if (!getModbusTarget(params, &unit, &address) ||
+                    !getModbusCount(params, address, ModbusMaster::kMaxReadRegisters, &count)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "unit/address/count value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            ModbusMaster *master = client->GetUartModbus(params.interfaceId.value);
+            if (!master) {
+                request.respond(statusResponse(PeripheralManagerErrors::kENODEV).stringify().c_str());
+                return true;
+            }
+
+            std::vector<uint16_t> registers;
+            uint64_t age_ms = 0;
+            if ((!params.cached.set || params.cached.value) &&
+                    master->GetCachedRegisters(unit, address, count, &registers, &age_ms)) {
+                response_json = modbusResponse(ModbusResult{ModbusError::kNone, 0, registers});
+                response_json.put("cached", true);
+                response_json.put("ageMs", static_cast<int64_t>(age_ms));
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            master->ReadHoldingRegisters(unit, address, count, modbusReply(ls_message));
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/unit/address/count is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<ModbusParams> kModbusWriteRegistersParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+    {"unit", &ModbusParams::unit},
+    {"address", &ModbusParams::address},
+    {"values", &ModbusParams::values, ParamType::kArray},
+};
+
+bool PeripheralManagerService::ModbusWriteRegisters(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kModbusWriteRegistersParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set && params.unit.set && params.address.set && params.values.set)
+        {
+            uint8_t unit = 0;
+            uint16_t address = 0;
+            std::vector<uint16_t> values;
+            bool valid = getModbusTarget(params, &unit, &address);
+            int size = params.values.value.arraySize();
+            for (int i = 0; valid && i < size; i++) {
+                int value = params.values.value[i].asNumber<int>();
+                valid = value >= 0 && value <= 0xffff;
+                values.push_back(value);
+            }
+            if (!valid || values.empty() || values.size() > ModbusMaster::kMaxWriteRegisters ||
+                    address + values.size() > 0x10000) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "unit/address/values value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            ModbusMaster *master = client->GetUartModbus(params.interfaceId.value);
+            if (!master) {
+                request.respond(statusResponse(PeripheralManagerErrors::kENODEV).stringify().c_str());
+                return true;
+            }
+            master->WriteRegisters(unit, address, values, modbusReply(ls_message));
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/unit/address/values is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<ModbusParams> kAddModbusPollParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+    {"unit", &ModbusParams::unit},
+    {"address", &ModbusParams::address},
+    {"count", &ModbusParams::count},
+    {"intervalMs", &ModbusParams::intervalMs},
+};
+
+bool PeripheralManagerService::AddModbusPoll(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kAddModbusPollParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set && params.unit.set && params.address.set &&
+                params.count.set && params.intervalMs.set)
+        {
+            uint8_t unit = 0;
+            uint16_t address = 0;
+            uint16_t count = 0;
+            int interval_ms = params.intervalMs.value;
+            if (!getModbusTarget(params, &unit, &address) ||
+                    !getModbusCount(params, address, ModbusMaster::kMaxReadRegisters, &count) || interval_ms <= 0) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "unit/address/count/intervalMs value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            ModbusMaster *master = client->GetUartModbus(params.interfaceId.value);
+            if (!master)
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            else
+                response_json = pbnjson::JObject{{"returnValue", true},
+                        {"pollId", static_cast<int64_t>(master->AddPoll(unit, address, count, interval_ms))}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/unit/address/count/intervalMs is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<ModbusParams> kRemoveModbusPollParams[] = {
+    {"interfaceId", &ModbusParams::interfaceId},
+    {"pollId", &ModbusParams::pollId},
+};
+
+bool PeripheralManagerService::RemoveModbusPoll(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        ModbusParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kRemoveModbusPollParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.interfaceId.set && params.pollId.set)
+        {
+            ModbusMaster *master = client->GetUartModbus(params.interfaceId.value);
+            if (!master)
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            else if (!master->RemovePoll(params.pollId.value))
+                response_json = statusResponse(PeripheralManagerErrors::kEINVAL);
+            else
+                response_json = pbnjson::JObject{{"returnValue", true}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "interfaceId/pollId is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<GpioParams> kgetDirectionParams[] = {
+    {"pin", &GpioParams::pin},
+};
+
+bool PeripheralManagerService::getDirection(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    bool ret;
+    std::string direction;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        GpioParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kgetDirectionParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string pin = params.pin.value;
+        if (params.pin.set)
+        {
+            Status status = client->getDirection(pin, direction);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"direction", direction}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "pin is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<UartParams> kGetuartPollingFdParams[] = {
+    {"id", &UartParams::id},
+};
+
+bool PeripheralManagerService::GetuartPollingFd(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    int fd  ;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }
+    else {
+        UartParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGetuartPollingFdParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string id = params.id.value;
+        if (params.id.set)
+        {
+            Status status = client->GetuartPollingFd(id, &fd);
+            if (status != PeripheralManagerErrors::kNoError) {
+                request.respond(statusResponse(status).stringify().c_str());
+                return true;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"fd", fd}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "id is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+// Properties of the i2c/* requests.
+struct I2cParams {
+    Param<bool> subscribe;
+    Param<bool> verbose;
+    Param<std::string> name;
+    Param<int64_t> address;
+    Param<int64_t> handle;
+    Param<int64_t> size;
+    Param<std::string> encoding;
+    Param<int64_t> reg;
+    Param<pbnjson::JValue> data;
+    Param<pbnjson::JValue> messages;
+};
+
+static const ParamSpec<I2cParams> kListI2cBusesParams[] = {
+    {"subscribe", &I2cParams::subscribe},
+    {"verbose", &I2cParams::verbose},
+};
+
+bool PeripheralManagerService::ListI2cBuses(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    bool verbose = false;
+
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kListI2cBusesParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        else{
+            verbose = params.verbose.value;
+            std::vector<std::string> stale;
+            if (verbose)
+                stale = client->GetStaleI2cScans();
+            if (!stale.empty()) {
+                scanI2cBuses(client, stale, ls_message);
+                return true;
+            }
+            pbnjson::JValue list = pbnjson::JArray();
+            client->ListI2cBuses(list, verbose);
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"i2cBusList", list}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+    }
+    return true;
+}
+
+// Scans |names| side by side, each on its bus's worker so the probes keep
+// their order with the bus's transfers, and answers the verbose i2c/list
+// once the last scan is done.
+void PeripheralManagerService::scanI2cBuses(PeripheralManagerClient *client, const std::vector<std::string> &names,
+        LSMessage &ls_message)
+{
+    LS::Message request(&ls_message);
+    std::shared_ptr<std::atomic<size_t>> pending(new std::atomic<size_t>(names.size()));
+    for (const std::string &name : names) {
+        busWorker(i2cBusKey(name))->Post([client, name, pending, request]() {
+            // A bus that fails to scan is left out of the list.
+            client->ScanI2cBus(name);
+            if (--*pending)
+                return;
+            pbnjson::JValue response_json = guardedResponse([client]() -> pbnjson::JValue {
+                pbnjson::JValue list = pbnjson::JArray();
+                client->ListI2cBuses(list, true);
+                return pbnjson::JObject{{"returnValue", true}, {"i2cBusList", list}};
+            });
+            DeferredReply *reply = new DeferredReply{request, response_json.stringify()};
+            g_idle_add(deferredReplyCallback, reply);
+        });
+    }
+}
+
+static const ParamSpec<I2cParams> kOpenI2cDeviceParams[] = {
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+};
+
+bool PeripheralManagerService::OpenI2cDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenI2cDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if(params.name.set && params.address.set)
+        {
+            std::string name = params.name.value;
+            int32_t address = params.address.value;
+            respondOnBus(i2cBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                int32_t handle = 0;
+                Status status = client->OpenI2cDevice(name, address, &handle);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"handle", handle}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kReleaseI2cDeviceParams[] = {
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+};
+
+bool PeripheralManagerService::ReleaseI2cDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kReleaseI2cDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if(params.name.set && params.address.set)
+        {
+            std::string name = params.name.value;
+            int32_t address = params.address.value;
+            respondOnBus(i2cBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->ReleaseI2cDevice(name, address);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+static const ParamSpec<I2cParams> kI2cReadParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"size", &I2cParams::size},
+    {"encoding", &I2cParams::encoding},
+};
+
+bool PeripheralManagerService::I2cRead(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cReadParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.handle.set || (params.name.set && params.address.set))
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int address = params.address.value;
+            int size = params.size.value;
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                std::vector<uint8_t> data;
+                size =  size ? size : 8;
+                data.resize(size);
+                int bytes_read = 0;
+                Status status = client->I2cRead(handle, &data, size, &bytes_read);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"data", binaryDataJson(data.data(), bytes_read, encoding)},
+                    {"size", bytes_read}
+
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cReadRegByteParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+};
+
+bool PeripheralManagerService::I2cReadRegByte(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cReadRegByteParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.reg.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address =  params.address.value;
+            int32_t reg =  params.reg.value;
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                int32_t val =  0;
+                Status status = client->I2cReadRegByte(handle, reg, &val);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"data", val}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cReadRegWordParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+};
+
+bool PeripheralManagerService::I2cReadRegWord(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cReadRegWordParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.reg.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            int32_t reg = params.reg.value;
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                int32_t val = 0;
+                Status status = client->I2cReadRegWord(handle, reg, &val);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"data", val}
+                };
+                return response_json;
+            });
+        }
+        else{
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cReadRegBufferParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+    {"size", &I2cParams::size},
+    {"encoding", &I2cParams::encoding},
+};
+
+bool PeripheralManagerService::I2cReadRegBuffer(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cReadRegBufferParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.reg.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            int32_t reg = params.reg.value;
+            int32_t size = params.size.value;
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                std::vector<uint8_t> data;
+                size = size ? size : 8;
+                int32_t bytes_read = 0;
+                Status status = client->I2cReadRegBuffer(handle, reg, &data, size, &bytes_read);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"size", bytes_read},
+                    {"data", binaryDataJson(data.data(), bytes_read, encoding)}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+static const ParamSpec<I2cParams> kI2cWriteParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"data", &I2cParams::data, ParamType::kAny},
+    {"encoding", &I2cParams::encoding},
+};
+
+bool PeripheralManagerService::I2cWrite(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cWriteParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.data.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address  = params.address.value;
+            std::vector<uint8_t> data;
+            if (!getBinaryData(params.data.value, encoding, &data)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                int bytes_written = 0;
+                Status status = client->I2cWrite(handle, data, &bytes_written);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"size", bytes_written}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cWriteRegByteParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+    {"data", &I2cParams::data, ParamType::kAny},
+};
+
+bool PeripheralManagerService::I2cWriteRegByte(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cWriteRegByteParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.data.set && params.reg.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            int32_t reg = params.reg.value;
+            int8_t data = params.data.value.asNumber<int>();
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                Status status = client->I2cWriteRegByte(handle, reg, data);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/reg/data  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cWriteRegWordParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+    {"data", &I2cParams::data, ParamType::kAny},
+};
+
+bool PeripheralManagerService::I2cWriteRegWord(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cWriteRegWordParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.reg.set && params.data.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            int32_t reg = params.reg.value;
+            int32_t data = params.data.value.asNumber<int>();
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                Status status = client->I2cWriteRegWord(handle, reg, data);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else{
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data/reg  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+
+static const ParamSpec<I2cParams> kI2cWriteRegBufferParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"reg", &I2cParams::reg},
+    {"data", &I2cParams::data, ParamType::kAny},
+    {"encoding", &I2cParams::encoding},
+};
+
+bool PeripheralManagerService::I2cWriteRegBuffer(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cWriteRegBufferParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.reg.set && params.data.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            int32_t reg = params.reg.value;
+            std::vector<uint8_t> data;
+            if (!getBinaryData(params.data.value, encoding, &data)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                int32_t bytes_written = 0;
+
+                Status status = client->I2cWriteRegBuffer(handle, reg, data, &bytes_written);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"size" , bytes_written}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/data/reg  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<I2cParams> kI2cTransferParams[] = {
+    {"handle", &I2cParams::handle},
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+    {"messages", &I2cParams::messages, ParamType::kArray},
+    {"encoding", &I2cParams::encoding},
+};
+
+bool PeripheralManagerService::I2cTransfer(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+
+        return false;
+    } else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kI2cTransferParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || (params.name.set && params.address.set)) && params.messages.set)
+        {
+            // Each message is either {"write": [bytes]} or {"read": length}.
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int32_t address = params.address.value;
+            pbnjson::JValue jsonMessages = params.messages.value;
+            int jsonMessagesSize = jsonMessages.arraySize();
+            std::vector<I2cMessage> msgs(jsonMessagesSize);
+            for (int i = 0; i < jsonMessagesSize; i++) {
+                pbnjson::JValue jsonMessage = jsonMessages[i];
+                if (jsonMessage.hasKey("read") == jsonMessage.hasKey("write")) {
+                    response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "message needs one of read/write"}};
+                    request.respond(response_json.stringify().c_str());
+                    return true;
+                }
+                msgs[i].read = jsonMessage.hasKey("read");
+                if (msgs[i].read) {
+                    int size = jsonMessage["read"].asNumber<int>();
+                    msgs[i].data.resize(size > 0 ? size : 0);
+                } else if (!getBinaryData(jsonMessage["write"], encoding, &msgs[i].data)) {
+                    response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                    request.respond(response_json.stringify().c_str());
+                    return true;
+                }
+            }
+
+            respondOnBus(i2cWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetI2cHandle(name, address);
+                Status status = client->I2cTransfer(handle, &msgs);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                pbnjson::JValue read_list = pbnjson::JArray();
+                for (auto& msg : msgs) {
+                    if (!msg.read)
+                        continue;
+                    read_list << binaryDataJson(msg.data.data(), msg.data.size(), encoding);
+                }
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"data", read_list}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address/messages is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+// Properties of the spi/* requests.
+struct SpiParams {
+    Param<bool> subscribe;
+    Param<std::string> name;
+    Param<int64_t> mode;
+    Param<int64_t> frequency;
+    Param<bool> lsb_first;
+    Param<int64_t> nbits;
+    Param<int64_t> handle;
+    Param<int64_t> size;
+    Param<pbnjson::JValue> data;
+    Param<std::string> encoding;
+    Param<pbnjson::JValue> segments;
+    Param<int64_t> delay_usecs;
+};
+
+static const ParamSpec<SpiParams> kListSpiBusesParams[] = {
+    {"subscribe", &SpiParams::subscribe},
+};
+
+bool PeripheralManagerService::ListSpiBuses(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kListSpiBusesParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }else {
+            subscription = params.subscribe.value;
+            std::vector<std::string> buses;
+            client->ListSpiBuses(&buses);
+            pbnjson::JValue bus_list = pbnjson::JArray();
+            for (std::string device : buses) {
+                bus_list << device;
+            }
+            response_json =
+                    pbnjson::JObject{
+                {"returnValue", true},
+                {"list", bus_list}
+            };
+            request.respond(response_json.stringify().c_str());
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kOpenSpiDeviceParams[] = {
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::OpenSpiDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenSpiDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set)
+        {
+            const std::string name = params.name.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                int32_t handle = 0;
+                Status status = client->OpenSpiDevice(name, &handle);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"handle", handle}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kReleaseSpiDeviceParams[] = {
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::ReleaseSpiDevice(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kReleaseSpiDeviceParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set)
+        {
+            const std::string name = params.name.value;
+            stopStream(client, streamKey("spi", name));
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->ReleaseSpiDevice(name);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceSetModeParams[] = {
+    {"mode", &SpiParams::mode},
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::SpiDeviceSetMode(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceSetModeParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.mode.set)
+        {
+            const std::string name = params.name.value;
+            int mode = params.mode.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->SpiDeviceSetMode(name, mode);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/mode is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceSetFrequencyParams[] = {
+    {"frequency", &SpiParams::frequency},
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::SpiDeviceSetFrequency(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceSetFrequencyParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.frequency.set)
+        {
+            const std::string name = params.name.value;
+            long int frequency = params.frequency.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->SpiDeviceSetFrequency(name, frequency);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/frequency is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceSetBitJustificationParams[] = {
+    {"name", &SpiParams::name},
+    {"lsb_first", &SpiParams::lsb_first},
+};
+
+bool PeripheralManagerService::SpiDeviceSetBitJustification(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    bool lsb_first;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceSetBitJustificationParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.lsb_first.set)
+        {
+            const std::string name = params.name.value;
+            bool lsb_first = params.lsb_first.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->SpiDeviceSetBitJustification(name, lsb_first);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/lsb_first is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceSetBitsPerWordParams[] = {
+    {"nbits", &SpiParams::nbits},
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::SpiDeviceSetBitsPerWord(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    int nbits;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceSetBitsPerWordParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.nbits.set)
+        {
+            const std::string name = params.name.value;
+            int nbits = params.nbits.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->SpiDeviceSetBitsPerWord(name, nbits);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/nbits is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceTransferParams[] = {
+    {"handle", &SpiParams::handle},
+    {"size", &SpiParams::size},
+    {"name", &SpiParams::name},
+    {"data", &SpiParams::data, ParamType::kAny},
+    {"encoding", &SpiParams::encoding},
+};
+
+bool PeripheralManagerService::SpiDeviceTransfer(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    bool ret = false;
+    int size;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceTransferParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.name.set) && params.size.set)
+        {
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int size = params.size.value;
+            std::vector<uint8_t> data;
+            if (params.data.set && !getBinaryData(params.data.value, encoding, &data)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+
+            std::vector<uint8_t> recv_data;
+            recv_data.resize(size);
+            respondOnBus(spiWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetSpiHandle(name);
+                Status status = client->SpiDeviceTransfer(handle, data,&recv_data,size);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+
+                int tx_size = data.size();
+                int rx_size = recv_data.size();
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue" , true},
+                    {"tx_size" , tx_size},
+                    {"rx_size" , rx_size},
+                    {"rx_data" , binaryDataJson(recv_data.data(), recv_data.size(), encoding)}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/size is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<SpiParams> kSpiDeviceTransferMultiParams[] = {
+    {"handle", &SpiParams::handle},
+    {"name", &SpiParams::name},
+    {"segments", &SpiParams::segments, ParamType::kArray},
+    {"encoding", &SpiParams::encoding},
+};
+
+bool PeripheralManagerService::SpiDeviceTransferMulti(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceTransferMultiParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.name.set) && params.segments.set)
+        {
+            // Each segment carries "data" and/or "size", plus optional
+            // "cs_change", "delay_usecs", "speed_hz" and "bits_per_word".
+            const std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            pbnjson::JValue jsonSegments = params.segments.value;
+            int jsonSegmentsSize = jsonSegments.arraySize();
+            std::vector<SpiSegment> segments(jsonSegmentsSize);
+            for (int i = 0; i < jsonSegmentsSize; i++) {
+                pbnjson::JValue jsonSegment = jsonSegments[i];
+                SpiSegment& segment = segments[i];
+                if (jsonSegment.hasKey("data") && !getBinaryData(jsonSegment["data"], encoding, &segment.tx_data)) {
+                    response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                    request.respond(response_json.stringify().c_str());
+                    return true;
+                }
+                int size = jsonSegment.hasKey("size") ? jsonSegment["size"].asNumber<int>() : segment.tx_data.size();
+                segment.rx_data.resize(size > 0 ? size : 0);
+                segment.cs_change = jsonSegment.hasKey("cs_change") && jsonSegment["cs_change"].asBool();
+                // Without "delay_usecs" the segment keeps the delay set by spi/setDelay.
+                segment.delay_usecs = jsonSegment.hasKey("delay_usecs") ? jsonSegment["delay_usecs"].asNumber<int>() : -1;
+                if (jsonSegment.hasKey("delay_usecs") && (segment.delay_usecs < 0 || segment.delay_usecs > INT16_MAX)) {
+                    response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "delay_usecs value not allowed"}};
+                    request.respond(response_json.stringify().c_str());
+                    return true;
+                }
+                segment.speed_hz = jsonSegment.hasKey("speed_hz") ? jsonSegment["speed_hz"].asNumber<int>() : 0;
+                segment.bits_per_word = jsonSegment.hasKey("bits_per_word") ? jsonSegment["bits_per_word"].asNumber<int>() : 0;
+            }
+
+            respondOnBus(spiWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetSpiHandle(name);
+                Status status = client->SpiDeviceTransferMulti(handle, &segments);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+
+                pbnjson::JValue rx_list = pbnjson::JArray();
+                for (auto& segment : segments) {
+                    rx_list << binaryDataJson(segment.rx_data.data(), segment.rx_data.size(), encoding);
+                }
+
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue" , true},
+                    {"rx_data" , rx_list}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/segments is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<SpiParams> kSpiDeviceWriteByteParams[] = {
+    {"handle", &SpiParams::handle},
+    {"name", &SpiParams::name},
+    {"data", &SpiParams::data, ParamType::kAny},
+};
+
+bool PeripheralManagerService::SpiDeviceWriteByte(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceWriteByteParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.name.set) && params.data.set)
+        {
+            std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+            int8_t data = params.data.value.asNumber<int>();
+            respondOnBus(spiWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetSpiHandle(name);
+                Status status = client->SpiDeviceWriteByte(handle, data);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/data  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceWriteBufferParams[] = {
+    {"handle", &SpiParams::handle},
+    {"name", &SpiParams::name},
+    {"data", &SpiParams::data, ParamType::kAny},
+    {"encoding", &SpiParams::encoding},
+};
+
+bool PeripheralManagerService::SpiDeviceWriteBuffer(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceWriteBufferParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        std::string encoding;
+        if (!getDataEncoding(params.encoding, &encoding))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "encoding value not allowed"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if ((params.handle.set || params.name.set) && params.data.set)
+        {
+            std::string name = params.name.value;
+            int32_t handle = params.handle.value;
+
+            std::vector<uint8_t> data;
+            if (!getBinaryData(params.data.value, encoding, &data)) {
+                response_json = pbnjson::JObject{{"returnValue", false},{"errorText", "data value not allowed"}};
+                request.respond(response_json.stringify().c_str());
+                return true;
+            }
+
+            respondOnBus(spiWorkerKey(client, handle, name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                if (!handle)
+                    handle = client->GetSpiHandle(name);
+                Status status = client->SpiDeviceWriteBuffer(handle, data);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                int size  = data.size();
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"size", size}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/buffer  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kSpiDeviceSetDelayParams[] = {
+    {"name", &SpiParams::name},
+    {"delay_usecs", &SpiParams::delay_usecs},
+};
+
+bool PeripheralManagerService::SpiDeviceSetDelay(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    bool subscription = false;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kSpiDeviceSetDelayParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.delay_usecs.set)
+        {
+            std::string name = params.name.value;
+            int delay_usecs = params.delay_usecs.value;
+            respondOnBus(spiBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->SpiDeviceSetDelay(name,delay_usecs);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true}
+                };
+                return response_json;
+            });
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/delay_usecs  is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<SpiParams> kOpenSpiStreamParams[] = {
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::OpenSpiStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kOpenSpiStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set)
+        {
+            std::string name = params.name.value;
+            std::string path;
+            std::string token;
+            if (!client->GetSpiHandle(name))
+                response_json = statusResponse(PeripheralManagerErrors::kENODEV);
+            else if (!startStream(client, "spi", name, 0, &path, &token))
+                response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to open stream"}};
+            else
+                response_json = pbnjson::JObject{{"returnValue", true}, {"path", path}, {"token", token}};
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static const ParamSpec<SpiParams> kCloseSpiStreamParams[] = {
+    {"name", &SpiParams::name},
+};
+
+bool PeripheralManagerService::CloseSpiStream(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }else {
+        SpiParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kCloseSpiStreamParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set)
+        {
+            if (stopStream(client, streamKey("spi", params.name.value)))
+                response_json = pbnjson::JObject{{"returnValue", true}};
+            else
+                response_json = statusResponse(PeripheralManagerErrors::kEPERM);
+            request.respond(response_json.stringify().c_str());
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+static const ParamSpec<I2cParams> kGeti2cPollingFdParams[] = {
+    {"name", &I2cParams::name},
+    {"address", &I2cParams::address},
+};
+
+bool PeripheralManagerService::Geti2cPollingFd(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    int fd  ;
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    }
+    else {
+        I2cParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kGeti2cPollingFdParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.name.set && params.address.set)
+        {
+            std::string name = params.name.value;
+            int32_t address = params.address.value;
+            respondOnBus(i2cBusKey(name), ls_message, [=]() mutable -> pbnjson::JValue {
+                pbnjson::JValue response_json;
+                Status status = client->Geti2cPollingFd(name, address, &fd);
+                if (status != PeripheralManagerErrors::kNoError)
+                    return statusResponse(status);
+                response_json =
+                        pbnjson::JObject{
+                    {"returnValue", true},
+                    {"fd", fd}
+                };
+                return response_json;
+            });
+
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "name/address is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+static pbnjson::JValue batchError(const std::string &text)
+{
+    return pbnjson::JObject{{"returnValue", false}, {"errorText", text}};
+}
+
+// True if |params| has every key of a "name/address" style list. An entry
+// like "handle|name+address" is satisfied by either the handle or both the
+// name and the address.
+static bool hasBatchParams(const pbnjson::JValue &params, const std::string &required)
+{
+    size_t begin = 0;
+    while (begin < required.size()) {
+        size_t end = std::min(required.find('/', begin), required.size());
+        bool found = false;
+        while (begin < end && !found) {
+            size_t next = std::min(required.find('|', begin), end);
+            found = true;
+            while (begin < next) {
+                size_t key_end = std::min(required.find('+', begin), next);
+                found = found && params.hasKey(required.substr(begin, key_end - begin));
+                begin = key_end + 1;
+            }
+            begin = next + 1;
+        }
+        if (!found)
+            return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+// Device of a batch operation, by the handle from its open if given, else
+// by the name it was opened with.
+static int32_t batchGpioHandle(PeripheralManagerClient *client, const pbnjson::JValue &params)
+{
+    if (params.hasKey("handle"))
+        return params["handle"].asNumber<int>();
+    return client->GetGpioHandle(params["pin"].asString());
+}
+
+static int32_t batchI2cHandle(PeripheralManagerClient *client, const pbnjson::JValue &params)
+{
+    if (params.hasKey("handle"))
+        return params["handle"].asNumber<int>();
+    return client->GetI2cHandle(params["name"].asString(), params["address"].asNumber<int>());
+}
+
+static int32_t batchSpiHandle(PeripheralManagerClient *client, const pbnjson::JValue &params)
+{
+    if (params.hasKey("handle"))
+        return params["handle"].asNumber<int>();
+    return client->GetSpiHandle(params["name"].asString());
+}
+
+static int32_t batchUartHandle(PeripheralManagerClient *client, const pbnjson::JValue &params)
+{
+    if (params.hasKey("handle"))
+        return params["handle"].asNumber<int>();
+    return client->GetUartHandle(params["interfaceId"].asString());
+}
+
+// Operations /batch/execute accepts. Params use the same names as the
+// individual methods, and those taking an open device accept its handle
+// instead of the name; subscriptions are not available in a batch.
+const PeripheralManagerService::BatchOperation PeripheralManagerService::kBatchOperations[] = {
+    {"gpio/open", "pin", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        int32_t handle = 0;
+        Status status = client->OpenGpio(params["pin"].asString(), &handle);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"handle", handle}};
+    }},
+    {"gpio/close", "pin", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        if (client->GetGpioHandle(params["pin"].asString())) {
+            service->stopStream(client, streamKey("gpio", params["pin"].asString()));
+            service->stopGpioEdgeWatch(client, params["pin"].asString());
+        }
+        Status status = client->ReleaseGpio(params["pin"].asString());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"gpio/setDirection", "handle|pin/direction", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string dir = params["direction"].asString();
+        int direction;
+        if(dir == "in") direction = 0;
+        else if(dir == "outHigh") direction = 1;
+        else if(dir == "outLow") direction = 2;
+        else return batchError(dir + " value not allowed");
+        Status status = client->SetGpioDirection(batchGpioHandle(client, params), direction);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"gpio/setValue", "handle|pin/value", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string val = params["value"].asString();
+        if (val != "high" && val != "low")
+            return batchError(val + " value not allowed");
+        Status status = client->SetGpioValue(batchGpioHandle(client, params), val == "high");
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"gpio/getValue", "handle|pin", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        bool value = false;
+        Status status = client->GetGpioValue(batchGpioHandle(client, params), &value);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"value", value ? "high" : "low"}};
+    }},
+    {"i2c/open", "name/address", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        int32_t handle = 0;
+        Status status = client->OpenI2cDevice(params["name"].asString(), params["address"].asNumber<int>(), &handle);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"handle", handle}};
+    }},
+    {"i2c/close", "name/address", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->ReleaseI2cDevice(params["name"].asString(), params["address"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"i2c/read", "handle|name+address", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        int size = params["size"].asNumber<int>();
+        size = size ? size : 8;
+        std::vector<uint8_t> data(size);
+        int bytes_read = 0;
+        Status status = client->I2cRead(batchI2cHandle(client, params),
+                &data, size, &bytes_read);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"data", binaryDataJson(data.data(), bytes_read, encoding)},
+                {"size", bytes_read}};
+    }},
+    {"i2c/readRegByte", "handle|name+address/reg", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        int32_t val = 0;
+        Status status = client->I2cReadRegByte(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), &val);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"data", val}};
+    }},
+    {"i2c/readRegWord", "handle|name+address/reg", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        int32_t val = 0;
+        Status status = client->I2cReadRegWord(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), &val);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"data", val}};
+    }},
+    {"i2c/readRegBuffer", "handle|name+address/reg", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        int32_t size = params["size"].asNumber<int>();
+        size = size ? size : 8;
+        std::vector<uint8_t> data;
+        int32_t bytes_read = 0;
+        Status status = client->I2cReadRegBuffer(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), &data, size, &bytes_read);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"size", bytes_read},
+                {"data", binaryDataJson(data.data(), bytes_read, encoding)}};
+    }},
+    {"i2c/write", "handle|name+address/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        std::vector<uint8_t> data;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        if (!getBinaryData(params["data"], encoding, &data))
+            return batchError("data value not allowed");
+        int32_t bytes_written = 0;
+        Status status = client->I2cWrite(batchI2cHandle(client, params),
+                data, &bytes_written);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"size", bytes_written}};
+    }},
+    {"i2c/writeRegByte", "handle|name+address/reg/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->I2cWriteRegByte(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), params["data"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"i2c/writeRegWord", "handle|name+address/reg/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->I2cWriteRegWord(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), params["data"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"i2c/writeRegBuffer", "handle|name+address/reg/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        std::vector<uint8_t> data;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        if (!getBinaryData(params["data"], encoding, &data))
+            return batchError("data value not allowed");
+        int32_t bytes_written = 0;
+        Status status = client->I2cWriteRegBuffer(batchI2cHandle(client, params),
+                params["reg"].asNumber<int>(), data, &bytes_written);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"size", bytes_written}};
+    }},
+    {"spi/open", "name", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        int32_t handle = 0;
+        Status status = client->OpenSpiDevice(params["name"].asString(), &handle);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"handle", handle}};
+    }},
+    {"spi/close", "name", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->ReleaseSpiDevice(params["name"].asString());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/setMode", "name/mode", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceSetMode(params["name"].asString(), params["mode"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/setFrequency", "name/frequency", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceSetFrequency(params["name"].asString(), params["frequency"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/setBitJustification", "name/lsb_first", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceSetBitJustification(params["name"].asString(), params["lsb_first"].asBool());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/setBitsPerWord", "name/nbits", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceSetBitsPerWord(params["name"].asString(), params["nbits"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/setDelay", "name/delay_usecs", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceSetDelay(params["name"].asString(), params["delay_usecs"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/writeByte", "handle|name/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SpiDeviceWriteByte(batchSpiHandle(client, params), params["data"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"spi/writeBuffer", "handle|name/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        std::vector<uint8_t> data;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        if (!getBinaryData(params["data"], encoding, &data))
+            return batchError("data value not allowed");
+        Status status = client->SpiDeviceWriteBuffer(batchSpiHandle(client, params), data);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"size", (int)data.size()}};
+    }},
+    {"spi/transfer", "handle|name/size", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        std::vector<uint8_t> data;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        if (params.hasKey("data") && !getBinaryData(params["data"], encoding, &data))
+            return batchError("data value not allowed");
+        int size = params["size"].asNumber<int>();
+        std::vector<uint8_t> recv_data(size);
+        Status status = client->SpiDeviceTransfer(batchSpiHandle(client, params), data, &recv_data, size);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"tx_size", (int)data.size()}, {"rx_size", (int)recv_data.size()},
+                {"rx_data", binaryDataJson(recv_data.data(), recv_data.size(), encoding)}};
+    }},
+    {"uart/open", "interfaceId", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        bool canonical = params["config"]["canonical"].asBool();
+        int buffer_size = params["config"].hasKey("bufferSize") ? params["config"]["bufferSize"].asNumber<int>() : 0;
+        if (buffer_size < 0)
+            return batchError("bufferSize value not allowed");
+        std::unique_ptr<UartFramer> framer;
+        if (params.hasKey("config") && !getUartFramer(params["config"], &framer))
+            return batchError("framing value not allowed");
+        int32_t handle = 0;
+        Status status = client->OpenUartDevice(params["interfaceId"].asString(), canonical, buffer_size, &handle);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        client->SetUartFramer(params["interfaceId"].asString(), std::move(framer));
+        return pbnjson::JObject{{"returnValue", true}, {"handle", handle}};
+    }},
+    {"uart/close", "interfaceId", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        service->stopUartReadWatch(params["interfaceId"].asString());
+        service->stopStream(client, streamKey("uart", params["interfaceId"].asString()));
+        service->finishUartTransaction(params["interfaceId"].asString(), statusResponse(PeripheralManagerErrors::kENODEV));
+        Status status = client->ReleaseUartDevice(params["interfaceId"].asString());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"uart/setBaudrate", "interfaceId/baudrate", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        Status status = client->SetUartDeviceBaudrate(params["interfaceId"].asString(), params["baudrate"].asNumber<int>());
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}};
+    }},
+    {"uart/write", "handle|interfaceId/data", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        std::vector<uint8_t> data;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        if (params["dataType"].asString() == "text") {
+            std::string strData = params["data"].asString();
+            data.assign(strData.begin(), strData.end());
+        }
+        else if (!getBinaryData(params["data"], encoding, &data)) {
+            return batchError("data value not allowed");
+        }
+        int bytes_written = 0;
+        Status status = client->UartDeviceWrite(batchUartHandle(client, params), data, &bytes_written);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        return pbnjson::JObject{{"returnValue", true}, {"size", bytes_written}};
+    }},
+    {"uart/read", "handle|interfaceId", [](PeripheralManagerService *service, PeripheralManagerClient *client, const pbnjson::JValue &params) -> pbnjson::JValue {
+        std::string encoding;
+        if (!getDataEncoding(params, &encoding))
+            return batchError("encoding value not allowed");
+        int size = params.hasKey("size") ? params["size"].asNumber<int>() : 1024;
+        if (size <= 0)
+            return batchError("size value not allowed");
+        std::string dataType = params["dataType"].asString() == "text" ? "text" : "byte";
+        std::vector<uint8_t> data(size);
+        int bytes_read = 0;
+        int32_t handle = batchUartHandle(client, params);
+        Status status = client->UartDeviceRead(handle, &data, size, &bytes_read);
+        if (status != PeripheralManagerErrors::kNoError)
+            return statusResponse(status);
+        pbnjson::JValue result = pbnjson::JObject{{"returnValue", true}, {"dataType", dataType}};
+        putUartReadData(result, client->GetUartFramer(handle), data.data(), bytes_read,
+                dataType, encoding);
+        return result;
+    }},
+    {nullptr, nullptr, nullptr}
+};
+
+// Runs one {method, params} entry of a batch and returns its response.
+pbnjson::JValue PeripheralManagerService::runBatchOperation(PeripheralManagerClient *client, const pbnjson::JValue &operation)
+{
+    std::string method = operation["method"].asString();
+    pbnjson::JValue params = operation.hasKey("params") ? operation["params"] : pbnjson::JObject();
+    pbnjson::JValue result;
+
+    const BatchOperation *op = kBatchOperations;
+    while (op->method && method != op->method)
+        op++;
+    if (!op->method) {
+        result = batchError(method + " method not allowed");
+    }
+    else if (!hasBatchParams(params, op->required)) {
+        result = batchError(std::string(op->required) + " is missing");
+    }
+    else {
+        result = guardedResponse([this, client, op, &params]() { return op->run(this, client, params); });
+    }
+    result.put("method", method);
+    return result;
+}
+
+// Worker key of an I2C or SPI batch operation, or "" for the operations
+// that run on the main loop.
+std::string PeripheralManagerService::batchBusKey(PeripheralManagerClient *client, const pbnjson::JValue &operation)
+{
+    std::string method = operation["method"].asString();
+    if (!operation.hasKey("params"))
+        return "";
+    const pbnjson::JValue &params = operation["params"];
+    int32_t handle = params.hasKey("handle") ? params["handle"].asNumber<int>() : 0;
+    if (!handle && !params.hasKey("name"))
+        return "";
+    if (method.compare(0, 4, "i2c/") == 0)
+        return i2cWorkerKey(client, handle, params["name"].asString());
+    if (method.compare(0, 4, "spi/") == 0)
+        return spiWorkerKey(client, handle, params["name"].asString());
+    return "";
+}
+
+void PeripheralManagerService::addBatchResult(BatchRun *run, const pbnjson::JValue &result)
+{
+    run->results << result;
+    if (!result["returnValue"].asBool()) {
+        run->failed++;
+        run->stopped = run->stop_on_error;
+    }
+}
+
+gboolean PeripheralManagerService::batchContinueCallback(gpointer data)
+{
+    BatchRun *run = static_cast<BatchRun *>(data);
+    // The sender went away while a worker had the batch; nobody is left
+    // to answer.
+    bool alive = false;
+    for (const auto &session : run->service->sessions)
+        alive = alive || session.second->client.get() == run->client;
+    if (!alive)
+        delete run;
+    else
+        run->service->continueBatch(run);
+    return G_SOURCE_REMOVE;
+}
+
+// Runs the batch from its next operation until it is complete or hands
+// itself to a bus worker.
+void PeripheralManagerService::continueBatch(BatchRun *run)
+{
+    int size = run->operations.arraySize();
+    while (run->next < size && !run->stopped) {
+        std::string bus = batchBusKey(run->client, run->operations[run->next]);
+        if (bus.empty()) {
+            addBatchResult(run, runBatchOperation(run->client, run->operations[run->next++]));
+            continue;
+        }
+        // Streams belong to the main loop, so spi/close stops its own here
+        // and starts a run of its own, after the operations before it.
+        pbnjson::JValue first = run->operations[run->next];
+        if (first["method"].asString() == "spi/close")
+            stopStream(run->client, streamKey("spi", first["params"]["name"].asString()));
+        int end = run->next + 1;
+        while (end < size && batchBusKey(run->client, run->operations[end]) == bus &&
+                run->operations[end]["method"].asString() != "spi/close")
+            end++;
+        busWorker(bus)->Post([run, end]() {
+            while (run->next < end && !run->stopped)
+                addBatchResult(run, run->service->runBatchOperation(run->client, run->operations[run->next++]));
+            g_idle_add(batchContinueCallback, run);
+        });
+        return;
+    }
+
+    pbnjson::JValue response_json =
+            pbnjson::JObject{
+        {"returnValue", run->failed == 0},
+        {"failed", run->failed},
+        {"results", run->results}
+    };
+    if (run->failed)
+        response_json.put("errorText", "batch operation failed");
+    run->request.respond(response_json.stringify().c_str());
+    delete run;
+}
+
+struct BatchParams {
+    Param<pbnjson::JValue> operations;
+    Param<bool> stopOnError;
+};
+
+static const ParamSpec<BatchParams> kBatchParams[] = {
+    {"operations", &BatchParams::operations, ParamType::kArray},
+    {"stopOnError", &BatchParams::stopOnError},
+};
+
+bool PeripheralManagerService::Batch(LSMessage &ls_message) {
+    LS::Message request(&ls_message);
+    PeripheralManagerClient *client = session(ls_message);
+    pbnjson::JValue response_json;
+    pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.getPayload());
+    if (parsed.isError()) {
+        response_json =
+                pbnjson::JObject{{"returnValue", false}, {"errorText", "Failed to parse params"}, {"errorCode", 1}};
+        request.respond(response_json.stringify().c_str());
+        return false;
+    } else {
+        BatchParams params;
+        std::string invalid_params;
+        if (!ReadParams(parsed, kBatchParams, &params, &invalid_params))
+        {
+            response_json = pbnjson::JObject{{"returnValue", false},{"errorText", invalid_params}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+        if (params.operations.set)
+        {
+            // Operations run in order. With stopOnError the first failure
+            // ends the batch and later operations get no result entry.
+            continueBatch(new BatchRun{this, client, request, params.operations.value,
+                    params.stopOnError.value, 0, 0, false, pbnjson::JArray()});
+        }
+        else {
+            response_json = pbnjson::JObject{{"returnValue", false}, {"errorText", "operations is missing"}};
+            request.respond(response_json.stringify().c_str());
+            return true;
+        }
+    }
+    return true;
+}
+
+// Private Methods
+void PeripheralManagerService::registerMethodsToLsHub() {
+    static const LSMethod gpio[] = {
+        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListGpio>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenGpio>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseGpio>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setDirection", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioDirection>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setValue", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioValue>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getValue", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetGpioValue>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetGpioPollingFd>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getDirection", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::getDirection>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setEdge", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioEdge>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"openGroup", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenGpioGroup>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"closeGroup", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseGpioGroup>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setValues", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetGpioValues>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getValues", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetGpioValues>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"openStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenGpioStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"closeStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::CloseGpioStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/gpio", gpio, nullptr, nullptr);
+    luna_handle->setCategoryData("/gpio", this);
+
+    static const LSMethod uart[] = {
+        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListUartDevices>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenUartDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseUartDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setBaudrate", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SetUartDeviceBaudrate>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"write", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::UartDeviceWrite>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"read", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::UartDeviceRead>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"transact", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::UartDeviceTransact>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetuartPollingFd>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getBaudrate", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::getBaudrate>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getStats", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::GetUartReaderStats>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"openStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenUartStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"closeStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::CloseUartStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/uart", uart, nullptr, nullptr);
+    luna_handle->setCategoryData("/uart", this);
+
+    static const LSMethod i2c[] = {
+        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListI2cBuses>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenI2cDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseI2cDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"read", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cRead>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"readRegByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegByte>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"readRegWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegWord>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"readRegBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cReadRegBuffer>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"write", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWrite>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeRegByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegByte>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeRegWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegWord>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeRegBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cWriteRegBuffer>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"getPollingFd", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::Geti2cPollingFd>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"transfer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::I2cTransfer>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/i2c", i2c, nullptr, nullptr);
+    luna_handle->setCategoryData("/i2c", this);
+
+        static const LSMethod spi[] = {
+        {"list", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ListSpiBuses>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenSpiDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ReleaseSpiDevice>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setMode", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetMode>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setFrequency", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetFrequency>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setBitJustification", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetBitJustification>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setBitsPerWord", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetBitsPerWord>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"transfer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceTransfer>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"transferMulti", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceTransferMulti>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeByte", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceWriteByte>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeBuffer", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceWriteBuffer>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"setDelay", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::SpiDeviceSetDelay>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"openStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenSpiStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"closeStream", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::CloseSpiStream>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/spi", spi, nullptr, nullptr);
+    luna_handle->setCategoryData("/spi", this);
+
+    static const LSMethod batch[] = {
+        {"execute", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::Batch>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/batch", batch, nullptr, nullptr);
+    luna_handle->setCategoryData("/batch", this);
+
+    static const LSMethod modbus[] = {
+        {"open", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::OpenModbus>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"close", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::CloseModbus>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"readHoldingRegisters", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ModbusReadHoldingRegisters>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"writeRegisters", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::ModbusWriteRegisters>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"addPoll", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::AddModbusPoll>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {"removePoll", &LS::Handle::methodWraper<PeripheralManagerService, &PeripheralManagerService::RemoveModbusPoll>,
+        static_cast<LSMethodFlags>(LUNA_METHOD_FLAG_VALIDATE_IN)},
+        {nullptr, nullptr}};
+
+    luna_handle->registerCategory("/modbus", modbus, nullptr, nullptr);
+    luna_handle->setCategoryData("/modbus", this);
+}
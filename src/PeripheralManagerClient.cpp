@@ -1,619 +1,1168 @@
-// Copyright (c) 2024 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#include <iostream>
-#include <map>
-#include <iostream>
-#include <vector>
-#include <memory>
-#include <cstdio>
-#include <fstream>
-#include <cassert>
-#include <functional>
-#include <string>
-#include <bits/stdc++.h>
-#include <pbnjson.hpp>
-#include "PeripheralManagerClient.h"
-#include "PeripheralManagerException.h"
-#define ROW 4
-#define COL 5
-
-PeripheralManagerClient::PeripheralManagerClient() {}
-PeripheralManagerClient::~PeripheralManagerClient() {}
-
-Status PeripheralManagerClient::ListGpio(std::vector<DevicesPinInfo>& gpioStat) {
-    std::vector<std::string> gpios;
-    gpios = GpioManager::GetGpioManager()->GetGpioPins();
-    DevicesPinInfo gpioPinInfo;
-    for(auto& name:gpios)
-    {
-        if(gpios_.count(name))
-        {
-            gpioPinInfo.status = "used";
-        }
-        else
-        {
-            gpioPinInfo.status = "available";
-        }
-        gpioPinInfo.name = std::move(name);
-        gpioStat.push_back(gpioPinInfo);
-    }
-}
-
-bool PeripheralManagerClient::OpenGpio(const std::string& name) {
-    if (!GpioManager::GetGpioManager()->HasGpio(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-        return false;
-    }
-    auto gpio = GpioManager::GetGpioManager()->OpenGpioPin(name);
-    if (!gpio) {
-        AppLogError() << "Failed to open GPIO " << name;
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEBUSY);
-        return false;
-    }
-
-    gpios_.emplace(name, std::move(gpio));
-    return true;
-}
-
-
-bool  PeripheralManagerClient::ReleaseGpio(const std::string& name) {
-    if (!GpioManager::GetGpioManager()->HasGpio(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-        return false;
-    }
-    gpios_.erase(name);
-    return true;
-}
-
-bool PeripheralManagerClient::SetGpioDirection(const std::string& name,
-        int direction) {
-    if (!gpios_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-        return false;
-    }
-
-    if (gpios_.find(name)->second->SetDirection(GpioDirection(direction))) {
-        return true;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return false;
-}
-bool PeripheralManagerClient::getDirection(const std::string& name,
-        std::string& direction) {
-    if (!gpios_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (gpios_.find(name)->second->getDirection(direction)) {
-        return true;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return false;
-}
-
-bool PeripheralManagerClient::SetGpioValue(const std::string& name,
-        bool value) {
-    if (!gpios_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (gpios_.find(name)->second->SetValue(value)) {
-        return true;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return false;
-}
-
-bool PeripheralManagerClient::GetGpioValue(const std::string& name,
-        bool* value) {
-    if (!gpios_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (gpios_.find(name)->second->GetValue(value)) {
-        return true;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return false;
-}
-int PeripheralManagerClient::GetGpioPollingFd(
-        const std::string& name,
-        int* fd) {
-    if (!gpios_.count(name)){
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    else (gpios_.find(name)->second->GetPollingFd(fd));
-    {
-        return *fd;
-    }
-    return 0;
-}
-
-
-Status PeripheralManagerClient::ListSpiBuses(std::vector<std::string>* buses) {
-    *buses = SpiManager::GetSpiManager()->GetSpiDevBuses();
-    return;
-}
-
-Status PeripheralManagerClient::OpenSpiDevice(const std::string& name) {
-    if (!SpiManager::GetSpiManager()->HasSpiDevBus(name)){
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-    }
-
-    std::unique_ptr<SpiDevice> device =
-            SpiManager::GetSpiManager()->OpenSpiDevice(name);
-
-    if (!device) {
-        AppLogError()  << "Failed to open device " << name;
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEBUSY);
-    }
-
-    spi_devices_.emplace(name, std::move(device));
-    return;
-}
-
-Status PeripheralManagerClient::ReleaseSpiDevice(const std::string& name) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    spi_devices_.erase(name);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceWriteByte(const std::string& name,
-        int8_t byte) {
-    if (!spi_devices_.count(name)){
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (spi_devices_.find(name)->second->WriteByte(byte)) {
-        return;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceWriteBuffer(
-        const std::string& name,
-        const std::vector<uint8_t>& buffer) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-    if (spi_devices_.find(name)->second->WriteBuffer(buffer.data(),
-            buffer.size())) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceTransfer(
-        const std::string& name,
-        std::vector<uint8_t>& tx_data,
-        std::vector<uint8_t>* rx_data,
-        int size) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (!rx_data) {
-        if (spi_devices_.find(name)->second->Transfer(tx_data.data(), nullptr,
-                size)) {
-            return;
-        }
-    } else {
-        if (spi_devices_.find(name)->second->Transfer(tx_data.data(),
-                (*rx_data).data(), size)) {
-            return;
-        }
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::SpiDeviceSetMode(const std::string& name,
-        int mode) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (spi_devices_.find(name)->second->SetMode(SpiMode(mode))) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceSetFrequency(const std::string& name,
-        int frequency_hz) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (frequency_hz > 0 &&
-            spi_devices_.find(name)->second->SetFrequency(frequency_hz)) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::SpiDeviceSetBitJustification(
-        const std::string& name,
-        bool lsb_first) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (spi_devices_.find(name)->second->SetBitJustification(lsb_first)) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceSetBitsPerWord(const std::string& name,
-        int nbits) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (spi_devices_.find(name)->second->SetBitsPerWord(nbits)) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::SpiDeviceSetDelay(const std::string& name,
-        int delay_usecs) {
-    if (!spi_devices_.count(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    // |delay_usecs| must be positive and fit in an unsigned 16 bit.
-    if (delay_usecs < 0 || delay_usecs > INT16_MAX) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEINVAL);
-    }
-
-    if (spi_devices_.find(name)->second->SetDelay(
-            static_cast<uint16_t>(delay_usecs))) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    return;
-}
-
-Status PeripheralManagerClient::ListI2cBuses(pbnjson::JValue& list,
-        bool verbose) {
-
-    I2cManager::GetI2cManager()->GetI2cDevBuses(list, verbose);
-    return;
-}
-
-Status PeripheralManagerClient::OpenI2cDevice(const std::string& name,
-        int32_t address) {
-    if (!I2cManager::GetI2cManager()->HasI2cDevBus(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-    }
-
-    std::unique_ptr<I2cDevice> device =
-            I2cManager::GetI2cManager()->OpenI2cDevice(name, address);
-    if (!device) {
-        AppLogError()  << "Failed to open device " << name;
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEBUSY);
-    }
-    std::pair<std::string, uint32_t> i2c_dev(name, address);
-    i2c_devices_.emplace(i2c_dev, std::move(device));
-    return;
-}
-
-Status PeripheralManagerClient::ReleaseI2cDevice(const std::string& name,
-        int32_t address) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    i2c_devices_.erase({name, address});
-    return;
-}
-
-Status PeripheralManagerClient::I2cRead(const std::string& name,
-        int32_t address,
-        std::vector<uint8_t>* data,
-        int32_t size,
-        int32_t* bytes_read) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (size < 0) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEINVAL);
-    }
-    data->resize(size);
-
-    uint32_t* nread = reinterpret_cast<uint32_t*>(bytes_read);
-    int32_t ret = i2c_devices_.find({name, address})
-                                            ->second->Read(data->data(), data->size(), nread);
-    data->resize(*nread);
-
-    if (ret == 0) {
-        return;
-    }
-    else {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    }
-}
-
-Status PeripheralManagerClient::I2cReadRegByte(const std::string& name,
-        int32_t address,
-        int32_t reg,
-        int32_t* val) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    uint8_t tmp_val = 0;
-    if (i2c_devices_.find({name, address})->second->ReadRegByte(reg, &tmp_val) ==
-            0) {
-        *val = tmp_val;
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::I2cReadRegWord(const std::string& name,
-        int32_t address,
-        int32_t reg,
-        int32_t* val) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    uint16_t tmp_val = 0;
-    if (i2c_devices_.find({name, address})->second->ReadRegWord(reg, &tmp_val) == 0) {
-        *val = tmp_val;
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::I2cReadRegBuffer(const std::string& name,
-        int32_t address,
-        int32_t reg,
-        std::vector<uint8_t>* data,
-        int32_t size,
-        int32_t* bytes_read) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (size < 0) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEINVAL);
-    }
-    data->resize(size);
-
-    uint32_t* nread = reinterpret_cast<uint32_t*>(bytes_read);
-    int32_t ret =
-            i2c_devices_.find({name, address})
-            ->second->ReadRegBuffer(reg, data->data(), data->size(), nread);
-
-    data->resize(*nread);
-    if (ret) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    }
-}
-
-Status PeripheralManagerClient::I2cWrite(const std::string& name,
-        int32_t address,
-        const std::vector<uint8_t>& data,
-        int32_t* bytes_written) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    int ret = i2c_devices_.find({name, address})
-                                        ->second->Write(data.data(),
-                                                data.size(),
-                                                reinterpret_cast<uint32_t*>(bytes_written));
-
-    if (ret) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    }
-}
-
-Status PeripheralManagerClient::I2cWriteRegByte(const std::string& name,
-        int32_t address,
-        int32_t reg,
-        int8_t val) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (i2c_devices_.find({name, address})->second->WriteRegByte(reg, val) == 0) {
-        return;
-    }
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::I2cWriteRegWord(const std::string& name,
-        int32_t address,
-        int32_t reg,
-        int32_t val) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-    if (i2c_devices_.find({name, address})->second->WriteRegWord(reg, val) == 0) {
-        return;
-    }
-
-    throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-}
-
-Status PeripheralManagerClient::I2cWriteRegBuffer(
-        const std::string& name,
-        int32_t address,
-        int32_t reg,
-        const std::vector<uint8_t>& data,
-        int32_t* bytes_written) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    int32_t ret =
-            i2c_devices_.find({name, address})
-            ->second->WriteRegBuffer(reg,
-                    data.data(),
-                    data.size(),
-                    reinterpret_cast<uint32_t*>(bytes_written));
-
-    if (ret) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEREMOTEIO);
-    }
-}
-
-Status PeripheralManagerClient::ListUartDevices(
-        std::vector<DevicesPinInfo>& uartStat) {
-    std::vector<std::string> devices;
-    devices = UartManager::GetManager()->GetDevicesList();
-    DevicesPinInfo uartPinInfo;
-    for(auto& name:devices)
-    {
-        if(uart_devices_.count(name))
-            uartPinInfo.status = "used";
-        else
-            uartPinInfo.status = "available";
-
-        uartPinInfo.name = std::move(name);
-        uartStat.push_back(uartPinInfo);
-        AppLogError() << " GPIO Pins Used" << uartPinInfo.name << ":" << uartPinInfo.status;
-    }
-    return;
-}
-
-Status PeripheralManagerClient::OpenUartDevice(const std::string& name, bool canonical) {
-    if (!UartManager::GetManager()->HasUartDevice(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-    }
-
-    auto uart_device = UartManager::GetManager()->OpenUartDevice(name, canonical);
-    if (!uart_device) {
-        AppLogError() << "Failed to open UART device " << name;
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEBUSY);
-    }
-    uart_devices_.emplace(name, std::move(uart_device));
-    return;
-}
-
-bool PeripheralManagerClient::ReleaseUartDevice(const std::string& name) {
-    return uart_devices_.erase(name) ? true
-            : throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-}
-
-bool PeripheralManagerClient::SetUartDeviceBaudrate(const std::string& name,
-        int32_t baudrate) {
-    auto uart_device = uart_devices_.find(name);
-    if (uart_device == uart_devices_.end()) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    if (baudrate < 0) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEINVAL);
-    }
-
-    int ret = uart_device->second->SetBaudrate(static_cast<uint32_t>(baudrate));
-
-    return (ret) ? false : true;
-}
-
-bool PeripheralManagerClient::UartDeviceWrite(
-        const std::string& name,
-        const std::vector<uint8_t>& data,
-        int32_t* bytes_written) {
-    auto uart_device = uart_devices_.find(name);
-    if (uart_device == uart_devices_.end()) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    int ret = uart_device->second->Write(
-            data, reinterpret_cast<uint32_t*>(bytes_written));
-
-    return (ret) ? false : true;
-}
-
-bool PeripheralManagerClient::UartDeviceRead(const std::string& name,
-        std::vector<uint8_t>* data,
-        int size,
-        int* bytes_read) {
-    auto uart_device = uart_devices_.find(name);
-    if (uart_device == uart_devices_.end()) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    int ret = uart_device->second->Read(
-            data, size, reinterpret_cast<uint32_t*>(bytes_read));
-
-    return (ret) ? false : true;
-}
-int PeripheralManagerClient::GetuartPollingFd(
-        const std::string& name,
-        int* fd) {
-    auto uart_device = uart_devices_.find(name);
-    if (uart_device == uart_devices_.end()) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    else (uart_devices_.find(name)->second->GetuPollingFd(fd));
-    {
-        return *fd;
-    }
-
-}
-int32_t  PeripheralManagerClient::getBaudrate(const std::string& name,
-        uint32_t* baudrate) {
-    auto uart_device = uart_devices_.find(name);
-    if (uart_device == uart_devices_.end()) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kEPERM);
-    }
-
-    int32_t ret = uart_device->second->getBaudrate(baudrate);
-
-    return ret;
-}
-int PeripheralManagerClient::Geti2cPollingFd(
-        const std::string& name,
-        int32_t address,
-        int* fd) {
-    if (!i2c_devices_.count({name, address})) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-    }
-    if (!I2cManager::GetI2cManager()->HasI2cDevBus(name)) {
-        throw PeripheralManagerException(std::string(" "), PeripheralManagerErrors::kENODEV);
-    }
-    int ret = i2c_devices_.find({name, address})->second->GetPollingFd(fd);
-
-    return *fd;
-}
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <iostream>
+#include <map>
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <fstream>
+#include <cassert>
+#include <functional>
+#include <string>
+#include <bits/stdc++.h>
+#include <pbnjson.hpp>
+#include "PeripheralManagerClient.h"
+#include "PeripheralManagerException.h"
+#define ROW 4
+#define COL 5
+
+PeripheralManagerClient::PeripheralManagerClient() {}
+PeripheralManagerClient::~PeripheralManagerClient() {}
+
+int32_t PeripheralManagerClient::GetGpioHandle(const std::string& name) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    return LookupHandle(gpio_handles_, name);
+}
+
+int32_t PeripheralManagerClient::GetI2cHandle(const std::string& name,
+        uint32_t address) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    return LookupHandle(i2c_handles_, std::make_pair(name, address));
+}
+
+int32_t PeripheralManagerClient::GetSpiHandle(const std::string& name) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    return LookupHandle(spi_handles_, name);
+}
+
+int32_t PeripheralManagerClient::GetUartHandle(const std::string& name) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    return LookupHandle(uart_handles_, name);
+}
+
+std::string PeripheralManagerClient::GetGpioName(int32_t handle) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    for (const auto& gpio : gpio_handles_) {
+        if (gpio.second == handle)
+            return gpio.first;
+    }
+    return std::string();
+}
+
+std::string PeripheralManagerClient::GetUartName(int32_t handle) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    for (const auto& uart : uart_handles_) {
+        if (uart.second == handle)
+            return uart.first;
+    }
+    return std::string();
+}
+
+std::vector<std::pair<std::string, uint32_t>> PeripheralManagerClient::GetOpenI2cDevices() {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    std::vector<std::pair<std::string, uint32_t>> devices;
+    for (const auto& device : i2c_handles_)
+        devices.push_back(device.first);
+    return devices;
+}
+
+std::vector<std::string> PeripheralManagerClient::GetOpenSpiDevices() {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    std::vector<std::string> devices;
+    for (const auto& device : spi_handles_)
+        devices.push_back(device.first);
+    return devices;
+}
+
+bool PeripheralManagerClient::GetI2cHandleBus(int32_t handle, uint32_t* bus) {
+    return i2c_devices_.With(handle, [bus](I2cDevice* device) {
+        *bus = device->Bus();
+    });
+}
+
+bool PeripheralManagerClient::GetSpiHandleBus(int32_t handle, uint32_t* bus) {
+    return spi_devices_.With(handle, [bus](SpiDevice* device) {
+        *bus = device->Bus();
+    });
+}
+
+GpioPin* PeripheralManagerClient::FindGpio(const std::string& name) {
+    return gpios_.Get(GetGpioHandle(name));
+}
+
+I2cDevice* PeripheralManagerClient::FindI2cDevice(const std::string& name,
+        uint32_t address) {
+    return i2c_devices_.Get(GetI2cHandle(name, address));
+}
+
+SpiDevice* PeripheralManagerClient::FindSpiDevice(const std::string& name) {
+    return spi_devices_.Get(GetSpiHandle(name));
+}
+
+UartDevice* PeripheralManagerClient::FindUartDevice(const std::string& name) {
+    return uart_devices_.Get(GetUartHandle(name));
+}
+
+Status PeripheralManagerClient::ListGpio(std::vector<DevicesPinInfo>& gpioStat) {
+    std::vector<std::string> gpios;
+    gpios = GpioManager::GetGpioManager()->GetGpioPins();
+    DevicesPinInfo gpioPinInfo;
+    // A pin is used whichever session opened it.
+    for(auto& name:gpios)
+    {
+        if(GpioManager::GetGpioManager()->IsGpioInUse(name))
+        {
+            gpioPinInfo.status = "used";
+        }
+        else
+        {
+            gpioPinInfo.status = "available";
+        }
+        gpioPinInfo.name = std::move(name);
+        gpioStat.push_back(gpioPinInfo);
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::OpenGpio(const std::string& name,
+        int32_t* handle) {
+    if (!GpioManager::GetGpioManager()->HasGpio(name)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+    auto gpio = GpioManager::GetGpioManager()->OpenGpioPin(name);
+    if (!gpio) {
+        AppLogError() << "Failed to open GPIO " << name;
+        return PeripheralManagerErrors::kEBUSY;
+    }
+
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    int32_t gpio_handle = AddHandle(gpio_handles_, gpios_, name, std::move(gpio));
+    if (!gpio_handle) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (handle)
+        *handle = gpio_handle;
+    return PeripheralManagerErrors::kNoError;
+}
+
+
+Status  PeripheralManagerClient::ReleaseGpio(const std::string& name) {
+    if (!GpioManager::GetGpioManager()->HasGpio(name)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (!RemoveHandle(gpio_handles_, gpios_, name)) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SetGpioDirection(const std::string& name,
+        int direction) {
+    return SetGpioDirection(GetGpioHandle(name), direction);
+}
+
+Status PeripheralManagerClient::SetGpioDirection(int32_t handle,
+        int direction) {
+    GpioPin* gpio = gpios_.Get(handle);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->SetDirection(GpioDirection(direction))) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+Status PeripheralManagerClient::getDirection(const std::string& name,
+        std::string& direction) {
+    GpioPin* gpio = FindGpio(name);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->getDirection(direction)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SetGpioValue(const std::string& name,
+        bool value) {
+    return SetGpioValue(GetGpioHandle(name), value);
+}
+
+Status PeripheralManagerClient::SetGpioValue(int32_t handle,
+        bool value) {
+    GpioPin* gpio = gpios_.Get(handle);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->SetValue(value)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::GetGpioValue(const std::string& name,
+        bool* value) {
+    return GetGpioValue(GetGpioHandle(name), value);
+}
+
+Status PeripheralManagerClient::GetGpioValue(int32_t handle,
+        bool* value) {
+    GpioPin* gpio = gpios_.Get(handle);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->GetValue(value)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+Status PeripheralManagerClient::GetGpioPollingFd(
+        const std::string& name,
+        int* fd) {
+    GpioPin* gpio = FindGpio(name);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    // The drivers return the fd itself, so only its value tells failure.
+    *fd = -1;
+    gpio->GetPollingFd(fd);
+    return *fd < 0 ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SetGpioEdge(const std::string& name,
+        int edge) {
+    GpioPin* gpio = FindGpio(name);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->SetEdgeType(GpioEdgeType(edge))) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::GetGpioEdgeFd(const std::string& name,
+        int* fd,
+        short* events) {
+    GpioPin* gpio = FindGpio(name);
+    if (!gpio) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio->GetEdgeFd(fd, events)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+bool PeripheralManagerClient::ReadGpioEdgeEvent(const std::string& name,
+        bool* value,
+        uint64_t* timestamp_ns) {
+    GpioPin* gpio = FindGpio(name);
+    if (!gpio) {
+        return false;
+    }
+    return gpio->ReadEdgeEvent(value, timestamp_ns);
+}
+
+Status PeripheralManagerClient::SetGpioValues(
+        const std::vector<std::string>& names,
+        uint64_t bits,
+        uint64_t mask) {
+    if (names.empty() || names.size() > 64) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    // Check every pin first so that nothing is written on a bad request.
+    std::vector<GpioPin*> pins;
+    for (auto& name : names) {
+        GpioPin* gpio = FindGpio(name);
+        if (!gpio) {
+            return PeripheralManagerErrors::kEPERM;
+        }
+        pins.push_back(gpio);
+    }
+
+    for (size_t i = 0; i < pins.size(); i++) {
+        if (((mask >> i) & 1) && !pins[i]->SetValue((bits >> i) & 1)) {
+            return PeripheralManagerErrors::kEREMOTEIO;
+        }
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::GetGpioValues(
+        const std::vector<std::string>& names,
+        uint64_t* bits) {
+    if (names.empty() || names.size() > 64) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    std::vector<GpioPin*> pins;
+    for (auto& name : names) {
+        GpioPin* gpio = FindGpio(name);
+        if (!gpio) {
+            return PeripheralManagerErrors::kEPERM;
+        }
+        pins.push_back(gpio);
+    }
+
+    uint64_t result = 0;
+    for (size_t i = 0; i < pins.size(); i++) {
+        bool value = false;
+        if (!pins[i]->GetValue(&value)) {
+            return PeripheralManagerErrors::kEREMOTEIO;
+        }
+        if (value)
+            result |= (1ULL << i);
+    }
+    *bits = result;
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::OpenGpioGroup(const std::string& group,
+        const std::vector<std::string>& names) {
+    if (gpio_groups_.count(group)) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (names.empty() || names.size() > 64) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    for (auto& name : names) {
+        if (!GpioManager::GetGpioManager()->HasGpio(name)) {
+            return PeripheralManagerErrors::kENODEV;
+        }
+    }
+    auto gpio_group = GpioManager::GetGpioManager()->OpenGpioGroup(names);
+    if (!gpio_group) {
+        AppLogError() << "Failed to open GPIO group " << group;
+        return PeripheralManagerErrors::kEBUSY;
+    }
+
+    gpio_groups_.emplace(group, std::move(gpio_group));
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::ReleaseGpioGroup(const std::string& group) {
+    if (!gpio_groups_.count(group)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+    gpio_groups_.erase(group);
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SetGpioGroupDirection(const std::string& group,
+        int direction) {
+    auto gpio_group = gpio_groups_.find(group);
+    if (gpio_group == gpio_groups_.end()) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio_group->second->SetDirection(GpioDirection(direction))) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SetGpioGroupValues(const std::string& group,
+        uint64_t bits,
+        uint64_t mask) {
+    auto gpio_group = gpio_groups_.find(group);
+    if (gpio_group == gpio_groups_.end()) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (gpio_group->second->SetValues(bits, mask)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::GetGpioGroupValues(const std::string& group,
+        uint64_t* bits) {
+    auto gpio_group = gpio_groups_.find(group);
+    if (gpio_group == gpio_groups_.end()) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    size_t size = gpio_group->second->Size();
+    uint64_t mask = (size >= 64) ? ~0ULL : ((1ULL << size) - 1);
+    if (gpio_group->second->GetValues(bits, mask)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::ListSpiBuses(std::vector<std::string>* buses) {
+    *buses = SpiManager::GetSpiManager()->GetSpiDevBuses();
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::OpenSpiDevice(const std::string& name,
+        int32_t* handle) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (!SpiManager::GetSpiManager()->HasSpiDevBus(name)){
+        return PeripheralManagerErrors::kENODEV;
+    }
+
+    std::unique_ptr<SpiDevice> device =
+            SpiManager::GetSpiManager()->OpenSpiDevice(name);
+
+    if (!device) {
+        AppLogError()  << "Failed to open device " << name;
+        return PeripheralManagerErrors::kEBUSY;
+    }
+
+    int32_t spi_handle = AddHandle(spi_handles_, spi_devices_, name,
+            std::move(device));
+    if (!spi_handle) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (handle)
+        *handle = spi_handle;
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::ReleaseSpiDevice(const std::string& name) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (!RemoveHandle(spi_handles_, spi_devices_, name)) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SpiDeviceWriteByte(const std::string& name,
+        int8_t byte) {
+    return SpiDeviceWriteByte(GetSpiHandle(name), byte);
+}
+
+Status PeripheralManagerClient::SpiDeviceWriteByte(int32_t handle,
+        int8_t byte) {
+    SpiDevice* device = spi_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->WriteByte(byte)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceWriteBuffer(
+        const std::string& name,
+        const std::vector<uint8_t>& buffer) {
+    return SpiDeviceWriteBuffer(GetSpiHandle(name), buffer);
+}
+
+Status PeripheralManagerClient::SpiDeviceWriteBuffer(
+        int32_t handle,
+        const std::vector<uint8_t>& buffer) {
+    SpiDevice* device = spi_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    if (device->WriteBuffer(buffer.data(),
+            buffer.size())) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceTransfer(
+        const std::string& name,
+        std::vector<uint8_t>& tx_data,
+        std::vector<uint8_t>* rx_data,
+        int size) {
+    return SpiDeviceTransfer(GetSpiHandle(name), tx_data, rx_data, size);
+}
+
+Status PeripheralManagerClient::SpiDeviceTransfer(
+        int32_t handle,
+        std::vector<uint8_t>& tx_data,
+        std::vector<uint8_t>* rx_data,
+        int size) {
+    SpiDevice* device = spi_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (!rx_data) {
+        if (device->Transfer(tx_data.data(), nullptr,
+                size)) {
+            return PeripheralManagerErrors::kNoError;
+        }
+    } else {
+        if (device->Transfer(tx_data.data(),
+                (*rx_data).data(), size)) {
+            return PeripheralManagerErrors::kNoError;
+        }
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceTransferMulti(
+        const std::string& name,
+        std::vector<SpiSegment>* segments) {
+    return SpiDeviceTransferMulti(GetSpiHandle(name), segments);
+}
+
+Status PeripheralManagerClient::SpiDeviceTransferMulti(
+        int32_t handle,
+        std::vector<SpiSegment>* segments) {
+    SpiDevice* device = spi_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->TransferMulti(segments)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceSetMode(const std::string& name,
+        int mode) {
+    SpiDevice* device = FindSpiDevice(name);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->SetMode(SpiMode(mode))) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceSetFrequency(const std::string& name,
+        int frequency_hz) {
+    SpiDevice* device = FindSpiDevice(name);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (frequency_hz > 0 &&
+            device->SetFrequency(frequency_hz)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceSetBitJustification(
+        const std::string& name,
+        bool lsb_first) {
+    SpiDevice* device = FindSpiDevice(name);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->SetBitJustification(lsb_first)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceSetBitsPerWord(const std::string& name,
+        int nbits) {
+    SpiDevice* device = FindSpiDevice(name);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->SetBitsPerWord(nbits)) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::SpiDeviceSetDelay(const std::string& name,
+        int delay_usecs) {
+    SpiDevice* device = FindSpiDevice(name);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    // |delay_usecs| must be positive and fit in an unsigned 16 bit.
+    if (delay_usecs < 0 || delay_usecs > INT16_MAX) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+
+    if (device->SetDelay(
+            static_cast<uint16_t>(delay_usecs))) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::ListI2cBuses(pbnjson::JValue& list,
+        bool verbose) {
+
+    I2cManager::GetI2cManager()->GetI2cDevBuses(list, verbose);
+    return PeripheralManagerErrors::kNoError;
+}
+
+std::vector<std::string> PeripheralManagerClient::GetStaleI2cScans() {
+    return I2cManager::GetI2cManager()->GetStaleI2cScans();
+}
+
+Status PeripheralManagerClient::ScanI2cBus(const std::string& name) {
+    if (!I2cManager::GetI2cManager()->ScanI2cDevBus(name)) {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::OpenI2cDevice(const std::string& name,
+        int32_t address,
+        int32_t* handle) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    if (!I2cManager::GetI2cManager()->HasI2cDevBus(name)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+
+    std::unique_ptr<I2cDevice> device =
+            I2cManager::GetI2cManager()->OpenI2cDevice(name, address);
+    if (!device) {
+        AppLogError()  << "Failed to open device " << name;
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    std::pair<std::string, uint32_t> i2c_dev(name, address);
+    int32_t i2c_handle = AddHandle(i2c_handles_, i2c_devices_, i2c_dev,
+            std::move(device));
+    if (!i2c_handle) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (handle)
+        *handle = i2c_handle;
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::ReleaseI2cDevice(const std::string& name,
+        int32_t address) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    std::pair<std::string, uint32_t> i2c_dev(name, address);
+    if (!RemoveHandle(i2c_handles_, i2c_devices_, i2c_dev)) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::I2cRead(const std::string& name,
+        int32_t address,
+        std::vector<uint8_t>* data,
+        int32_t size,
+        int32_t* bytes_read) {
+    return I2cRead(GetI2cHandle(name, address), data, size, bytes_read);
+}
+
+Status PeripheralManagerClient::I2cRead(int32_t handle,
+        std::vector<uint8_t>* data,
+        int32_t size,
+        int32_t* bytes_read) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (size < 0) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    data->resize(size);
+
+    uint32_t* nread = reinterpret_cast<uint32_t*>(bytes_read);
+    int32_t ret = device->Read(data->data(), data->size(), nread);
+    data->resize(*nread);
+
+    if (ret == 0) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    else {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+}
+
+Status PeripheralManagerClient::I2cReadRegByte(const std::string& name,
+        int32_t address,
+        int32_t reg,
+        int32_t* val) {
+    return I2cReadRegByte(GetI2cHandle(name, address), reg, val);
+}
+
+Status PeripheralManagerClient::I2cReadRegByte(int32_t handle,
+        int32_t reg,
+        int32_t* val) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    uint8_t tmp_val = 0;
+    if (device->ReadRegByte(reg, &tmp_val) ==
+            0) {
+        *val = tmp_val;
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::I2cReadRegWord(const std::string& name,
+        int32_t address,
+        int32_t reg,
+        int32_t* val) {
+    return I2cReadRegWord(GetI2cHandle(name, address), reg, val);
+}
+
+Status PeripheralManagerClient::I2cReadRegWord(int32_t handle,
+        int32_t reg,
+        int32_t* val) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    uint16_t tmp_val = 0;
+    if (device->ReadRegWord(reg, &tmp_val) == 0) {
+        *val = tmp_val;
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::I2cReadRegBuffer(const std::string& name,
+        int32_t address,
+        int32_t reg,
+        std::vector<uint8_t>* data,
+        int32_t size,
+        int32_t* bytes_read) {
+    return I2cReadRegBuffer(GetI2cHandle(name, address), reg, data, size,
+            bytes_read);
+}
+
+Status PeripheralManagerClient::I2cReadRegBuffer(int32_t handle,
+        int32_t reg,
+        std::vector<uint8_t>* data,
+        int32_t size,
+        int32_t* bytes_read) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (size < 0) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    data->resize(size);
+
+    uint32_t* nread = reinterpret_cast<uint32_t*>(bytes_read);
+    int32_t ret =
+            device->ReadRegBuffer(reg, data->data(), data->size(), nread);
+
+    data->resize(*nread);
+    if (ret) {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::I2cWrite(const std::string& name,
+        int32_t address,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    return I2cWrite(GetI2cHandle(name, address), data, bytes_written);
+}
+
+Status PeripheralManagerClient::I2cWrite(int32_t handle,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    int ret = device->Write(data.data(),
+                                                data.size(),
+                                                reinterpret_cast<uint32_t*>(bytes_written));
+
+    if (ret) {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::I2cWriteRegByte(const std::string& name,
+        int32_t address,
+        int32_t reg,
+        int8_t val) {
+    return I2cWriteRegByte(GetI2cHandle(name, address), reg, val);
+}
+
+Status PeripheralManagerClient::I2cWriteRegByte(int32_t handle,
+        int32_t reg,
+        int8_t val) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (device->WriteRegByte(reg, val) == 0) {
+        return PeripheralManagerErrors::kNoError;
+    }
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::I2cWriteRegWord(const std::string& name,
+        int32_t address,
+        int32_t reg,
+        int32_t val) {
+    return I2cWriteRegWord(GetI2cHandle(name, address), reg, val);
+}
+
+Status PeripheralManagerClient::I2cWriteRegWord(int32_t handle,
+        int32_t reg,
+        int32_t val) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    if (device->WriteRegWord(reg, val) == 0) {
+        return PeripheralManagerErrors::kNoError;
+    }
+
+    return PeripheralManagerErrors::kEREMOTEIO;
+}
+
+Status PeripheralManagerClient::I2cWriteRegBuffer(
+        const std::string& name,
+        int32_t address,
+        int32_t reg,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    return I2cWriteRegBuffer(GetI2cHandle(name, address), reg, data,
+            bytes_written);
+}
+
+Status PeripheralManagerClient::I2cWriteRegBuffer(
+        int32_t handle,
+        int32_t reg,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    int32_t ret =
+            device->WriteRegBuffer(reg,
+                    data.data(),
+                    data.size(),
+                    reinterpret_cast<uint32_t*>(bytes_written));
+
+    if (ret) {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::I2cTransfer(const std::string& name,
+        int32_t address,
+        std::vector<I2cMessage>* msgs) {
+    return I2cTransfer(GetI2cHandle(name, address), msgs);
+}
+
+Status PeripheralManagerClient::I2cTransfer(int32_t handle,
+        std::vector<I2cMessage>* msgs) {
+    I2cDevice* device = i2c_devices_.Get(handle);
+    if (!device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    int32_t ret = device->Transfer(msgs);
+    if (ret == EINVAL) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    if (ret) {
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::ListUartDevices(
+        std::vector<DevicesPinInfo>& uartStat) {
+    std::vector<std::string> devices;
+    devices = UartManager::GetManager()->GetDevicesList();
+    DevicesPinInfo uartPinInfo;
+    for(auto& name:devices)
+    {
+        if(UartManager::GetManager()->IsUartDeviceInUse(name))
+            uartPinInfo.status = "used";
+        else
+            uartPinInfo.status = "available";
+
+        uartPinInfo.name = std::move(name);
+        uartStat.push_back(uartPinInfo);
+        AppLogHot(Debug) << " GPIO Pins Used" << uartPinInfo.name << ":" << uartPinInfo.status;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::OpenUartDevice(const std::string& name, bool canonical,
+        uint32_t buffer_size, int32_t* handle) {
+    if (!UartManager::GetManager()->HasUartDevice(name)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+
+    auto uart_device = UartManager::GetManager()->OpenUartDevice(name, canonical);
+    if (!uart_device) {
+        AppLogError() << "Failed to open UART device " << name;
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (buffer_size && !uart_device->StartReader(buffer_size)) {
+        AppLogError() << "Failed to start the reader of UART device " << name;
+        return PeripheralManagerErrors::kEREMOTEIO;
+    }
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    int32_t uart_handle = AddHandle(uart_handles_, uart_devices_, name,
+            std::move(uart_device));
+    if (!uart_handle) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    if (handle)
+        *handle = uart_handle;
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::ReleaseUartDevice(const std::string& name) {
+    std::lock_guard<std::mutex> lock(devices_mutex_);
+    return RemoveHandle(uart_handles_, uart_devices_, name) ? PeripheralManagerErrors::kNoError
+            : PeripheralManagerErrors::kEPERM;
+}
+
+Status PeripheralManagerClient::SetUartDeviceBaudrate(const std::string& name,
+        int32_t baudrate) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (baudrate < 0) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+
+    int ret = uart_device->SetBaudrate(static_cast<uint32_t>(baudrate));
+
+    return ret ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::UartDeviceWrite(
+        const std::string& name,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    return UartDeviceWrite(GetUartHandle(name), data, bytes_written);
+}
+
+Status PeripheralManagerClient::UartDeviceWrite(
+        int32_t handle,
+        const std::vector<uint8_t>& data,
+        int32_t* bytes_written) {
+    UartDevice* uart_device = uart_devices_.Get(handle);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    if (uart_device->Modbus()) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+
+    int ret = uart_device->Write(
+            data, reinterpret_cast<uint32_t*>(bytes_written));
+
+    return ret ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::UartDeviceFlushInput(int32_t handle) {
+    UartDevice* uart_device = uart_devices_.Get(handle);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    if (uart_device->Modbus()) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+    return uart_device->FlushInput() ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::UartDeviceRead(const std::string& name,
+        std::vector<uint8_t>* data,
+        int size,
+        int* bytes_read) {
+    return UartDeviceRead(GetUartHandle(name), data, size, bytes_read);
+}
+
+Status PeripheralManagerClient::UartDeviceRead(int32_t handle,
+        std::vector<uint8_t>* data,
+        int size,
+        int* bytes_read) {
+    UartDevice* uart_device = uart_devices_.Get(handle);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    if (uart_device->Modbus()) {
+        return PeripheralManagerErrors::kEBUSY;
+    }
+
+    int ret = uart_device->Read(
+            data, size, reinterpret_cast<uint32_t*>(bytes_read));
+
+    // EAGAIN only means that nothing was buffered yet.
+    return (ret && ret != EAGAIN) ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+Status PeripheralManagerClient::GetuartPollingFd(
+        const std::string& name,
+        int* fd) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        *fd = -1;
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    uart_device->GetuPollingFd(fd);
+    return *fd < 0 ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
+Status  PeripheralManagerClient::getBaudrate(const std::string& name,
+        uint32_t* baudrate) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    // The driver reports 0 when the rate could not be read.
+    return uart_device->getBaudrate(baudrate) ? PeripheralManagerErrors::kNoError
+            : PeripheralManagerErrors::kEREMOTEIO;
+}
+Status PeripheralManagerClient::GetUartReaderStats(const std::string& name,
+        UartReaderStats* stats) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    if (!uart_device->GetReaderStats(stats)) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SetUartReaderSink(const std::string& name,
+        std::shared_ptr<SharedRing> sink) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+
+    UartReaderStats stats;
+    if (!uart_device->GetReaderStats(&stats)) {
+        if (!sink) {
+            return PeripheralManagerErrors::kNoError;
+        }
+        if (!uart_device->StartReader(sink->Capacity())) {
+            return PeripheralManagerErrors::kEINVAL;
+        }
+    }
+    if (!uart_device->SetReaderSink(std::move(sink))) {
+        return PeripheralManagerErrors::kEINVAL;
+    }
+    return PeripheralManagerErrors::kNoError;
+}
+
+Status PeripheralManagerClient::SetUartFramer(const std::string& name,
+        std::unique_ptr<UartFramer> framer) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    uart_device->SetFramer(std::move(framer));
+    return PeripheralManagerErrors::kNoError;
+}
+
+UartFramer* PeripheralManagerClient::GetUartFramer(const std::string& name) {
+    return GetUartFramer(GetUartHandle(name));
+}
+
+UartFramer* PeripheralManagerClient::GetUartFramer(int32_t handle) {
+    UartDevice* uart_device = uart_devices_.Get(handle);
+    return uart_device ? uart_device->Framer() : nullptr;
+}
+
+Status PeripheralManagerClient::StartUartModbus(const std::string& name,
+        int response_timeout_ms) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    return uart_device->StartModbus(response_timeout_ms) ? PeripheralManagerErrors::kNoError
+            : PeripheralManagerErrors::kEBUSY;
+}
+
+Status PeripheralManagerClient::StopUartModbus(const std::string& name) {
+    UartDevice* uart_device = FindUartDevice(name);
+    if (!uart_device) {
+        return PeripheralManagerErrors::kEPERM;
+    }
+    uart_device->StopModbus();
+    return PeripheralManagerErrors::kNoError;
+}
+
+ModbusMaster* PeripheralManagerClient::GetUartModbus(const std::string& name) {
+    UartDevice* uart_device = FindUartDevice(name);
+    return uart_device ? uart_device->Modbus() : nullptr;
+}
+
+Status PeripheralManagerClient::Geti2cPollingFd(
+        const std::string& name,
+        int32_t address,
+        int* fd) {
+    I2cDevice* device = FindI2cDevice(name, address);
+    if (!device) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+    if (!I2cManager::GetI2cManager()->HasI2cDevBus(name)) {
+        return PeripheralManagerErrors::kENODEV;
+    }
+    device->GetPollingFd(fd);
+    return *fd < 0 ? PeripheralManagerErrors::kEREMOTEIO
+            : PeripheralManagerErrors::kNoError;
+}
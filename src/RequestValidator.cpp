@@ -0,0 +1,34 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "RequestValidator.h"
+
+bool HasParamType(const pbnjson::JValue& value, ParamType type) {
+    switch (type) {
+    case ParamType::kString:
+        return value.isString();
+    case ParamType::kNumber:
+        return value.isNumber();
+    case ParamType::kBoolean:
+        return value.isBoolean();
+    case ParamType::kArray:
+        return value.isArray();
+    case ParamType::kObject:
+        return value.isObject();
+    default:
+        return true;
+    }
+}
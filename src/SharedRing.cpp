@@ -0,0 +1,189 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "SharedRing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <new>
+#include "Logger.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+#ifndef F_ADD_SEALS
+#define F_ADD_SEALS 1033
+#define F_SEAL_SEAL 0x0001
+#define F_SEAL_SHRINK 0x0002
+#define F_SEAL_GROW 0x0004
+#endif
+
+// Not every libc we build against wraps memfd_create yet.
+static int createMemFd(const std::string& name) {
+    return syscall(SYS_memfd_create, name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
+}
+
+std::unique_ptr<SharedRing> SharedRing::Create(const std::string& name, size_t capacity) {
+    size_t size = 1;
+    while (size < capacity)
+        size <<= 1;
+    if (size > UINT32_MAX)
+        return nullptr;
+    size_t map_size = kSharedRingDataOffset + size;
+
+    int memfd = createMemFd(name);
+    if (memfd < 0)
+        return nullptr;
+    // Sealing the size keeps the client from truncating the file under
+    // the service, which would fault the producer.
+    if (ftruncate(memfd, map_size) < 0 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        close(memfd);
+        return nullptr;
+    }
+    void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    int event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (map == MAP_FAILED || event_fd < 0) {
+        if (map != MAP_FAILED)
+            munmap(map, map_size);
+        if (event_fd >= 0)
+            close(event_fd);
+        close(memfd);
+        return nullptr;
+    }
+
+    SharedRingControl* control = new (map) SharedRingControl;
+    control->magic = kSharedRingMagic;
+    control->version = kSharedRingVersion;
+    control->capacity = size;
+    control->tail = 0;
+    control->dropped = 0;
+    control->head = 0;
+    return std::unique_ptr<SharedRing>(new SharedRing(memfd, event_fd, map, map_size));
+}
+
+std::unique_ptr<SharedRing> SharedRing::Attach(int memfd, int event_fd) {
+    struct stat st;
+    if (fstat(memfd, &st) < 0 || st.st_size < static_cast<off_t>(kSharedRingDataOffset)) {
+        close(memfd);
+        close(event_fd);
+        return nullptr;
+    }
+    size_t map_size = st.st_size;
+    void* map = mmap(nullptr, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    const SharedRingControl* control = static_cast<const SharedRingControl*>(map);
+    if (map == MAP_FAILED || control->magic != kSharedRingMagic ||
+        control->version != kSharedRingVersion ||
+        control->capacity == 0 || (control->capacity & (control->capacity - 1)) ||
+        kSharedRingDataOffset + control->capacity != map_size) {
+        if (map != MAP_FAILED)
+            munmap(map, map_size);
+        close(memfd);
+        close(event_fd);
+        return nullptr;
+    }
+    return std::unique_ptr<SharedRing>(new SharedRing(memfd, event_fd, map, map_size));
+}
+
+SharedRing::SharedRing(int memfd, int event_fd, void* map, size_t map_size)
+    : memfd_(memfd),
+      eventfd_(event_fd),
+      map_(map),
+      map_size_(map_size),
+      control_(static_cast<SharedRingControl*>(map)),
+      data_(static_cast<uint8_t*>(map) + kSharedRingDataOffset),
+      mask_(map_size - kSharedRingDataOffset - 1),
+      tail_(control_->tail.load(std::memory_order_acquire)) {}
+
+SharedRing::~SharedRing() {
+    munmap(map_, map_size_);
+    close(memfd_);
+    close(eventfd_);
+}
+
+uint64_t SharedRing::Dropped() const {
+    return control_->dropped.load(std::memory_order_relaxed);
+}
+
+void SharedRing::CopyIn(uint64_t pos, const uint8_t* data, size_t size) {
+    size_t offset = pos & mask_;
+    size_t first = std::min(size, Capacity() - offset);
+    memcpy(data_ + offset, data, first);
+    memcpy(data_, data + first, size - first);
+}
+
+void SharedRing::CopyOut(uint64_t pos, uint8_t* data, size_t size) const {
+    size_t offset = pos & mask_;
+    size_t first = std::min(size, Capacity() - offset);
+    memcpy(data, data_ + offset, first);
+    memcpy(data + first, data_, size - first);
+}
+
+bool SharedRing::Push(const uint8_t* data, size_t size) {
+    if (!size)
+        return true;
+    uint64_t head = control_->head.load(std::memory_order_acquire);
+    // A head outside the window is a confused client; treat it as full.
+    uint64_t used = tail_ - head;
+    size_t record = sizeof(SharedRingRecordHeader) + size;
+    if (used > Capacity() || record > Capacity() - used) {
+        control_->dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    SharedRingRecordHeader header = {static_cast<uint32_t>(size)};
+    CopyIn(tail_, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+    CopyIn(tail_ + sizeof(header), data, size);
+    tail_ += record;
+    control_->tail.store(tail_, std::memory_order_release);
+
+    // The data is stored either way; a lost wakeup is only logged, and the
+    // client still finds the data at its next wakeup.
+    uint64_t one = 1;
+    if (write(eventfd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        AppLogHotRateLimited(Error, 1000) << "Failed to signal shared ring: " << strerror(errno);
+    }
+    return true;
+}
+
+size_t SharedRing::Pop(uint8_t* data, size_t size) {
+    uint64_t head = control_->head.load(std::memory_order_relaxed);
+    uint64_t tail = control_->tail.load(std::memory_order_acquire);
+    uint64_t used = tail - head;
+    if (!used)
+        return 0;
+
+    SharedRingRecordHeader header;
+    if (used < sizeof(header) || used > Capacity()) {
+        control_->head.store(tail, std::memory_order_release);
+        return 0;
+    }
+    CopyOut(head, reinterpret_cast<uint8_t*>(&header), sizeof(header));
+    if (header.length > used - sizeof(header)) {
+        control_->head.store(tail, std::memory_order_release);
+        return 0;
+    }
+    CopyOut(head + sizeof(header), data, std::min<size_t>(size, header.length));
+    control_->head.store(head + sizeof(header) + header.length, std::memory_order_release);
+    return header.length;
+}
@@ -1,307 +1,414 @@
-// Copyright (c) 2021 LG Electronics, Inc.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-// http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-//
-// SPDX-License-Identifier: Apache-2.0
-
-#include "UartDriverSysfs.h"
-
-#include <fcntl.h>
-#include <termios.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include "CharDevice.h"
-
-
-UartDriverSysfs::UartDriverSysfs(CharDeviceFactory* factory)
-: char_device_factory_(factory){}
-
-UartDriverSysfs::~UartDriverSysfs() {}
-
-bool UartDriverSysfs::Init(const std::string& name, bool canonical) {
-    path_ = name;
-    int fd = -1;
-
-    // Get a char device. If char_device_factory_ is set
-    // then this is a unittest and the char device is provided
-    // by the test. Otherwise create a normal CharDevice.
-    if (!char_device_factory_) {
-        char_interface_.reset(new CharDevice());
-    } else {
-        char_interface_ = char_device_factory_->NewCharDevice();
-    }
-
-    // Open as non-blocking as we don't want peripheral_manager to block on a
-    // single client read.
-    if(canonical) {
-        fd = char_interface_->Open(path_.c_str(), O_RDWR );
-    }
-    else {
-        fd = char_interface_->Open(path_.c_str(), O_RDWR | O_NONBLOCK);
-    }
-    if (fd < 0) {
-        AppLogError() << "Failed to open " << path_;
-        return false;
-    }
-
-    // Configure the device in raw mode.
-    struct termios config;
-    if (char_interface_->Ioctl(fd, TCGETS, &config)) {
-        AppLogError() << "Failed to read the tty config";
-        close(fd);
-        return false;
-    }
-    if(canonical) {
-        config.c_cflag = CS8 | CLOCAL | CREAD;
-        config.c_lflag |= ICANON;
-        config.c_iflag = IGNPAR;
-        config.c_oflag = 0;
-        config.c_lflag |= ICANON;
-        config.c_cc[VMIN] = 0;
-        config.c_cc[VTIME] = 0;
-    }
-    else {
-        cfmakeraw(&config);
-    }
-
-    if (char_interface_->Ioctl(fd, TCSETSF, &config)) {
-        AppLogError() << "Failed to configure the UART device as Raw.";
-        close(fd);
-        return false;
-    }
-
-    fd_ = fd;
-    return true;
-}
-
-int UartDriverSysfs::SetBaudrate(uint32_t baudrate) {
-    speed_t s;
-    switch (baudrate) {
-    case 0:
-        s = B0;
-        break;
-
-    case 50:
-        s = B50;
-        break;
-
-    case 75:
-        s = B75;
-        break;
-
-    case 110:
-        s = B110;
-        break;
-
-    case 134:
-        s = B134;
-        break;
-
-    case 150:
-        s = B150;
-        break;
-
-    case 200:
-        s = B200;
-        break;
-
-    case 300:
-        s = B300;
-        break;
-
-    case 600:
-        s = B600;
-        break;
-
-    case 1200:
-        s = B1200;
-        break;
-
-    case 1800:
-        s = B1800;
-        break;
-
-    case 2400:
-        s = B2400;
-        break;
-
-    case 4800:
-        s = B4800;
-        break;
-
-    case 9600:
-        s = B9600;
-        break;
-
-    case 19200:
-        s = B19200;
-        break;
-
-    case 38400:
-        s = B38400;
-        break;
-
-    case 57600:
-        s = B57600;
-        break;
-
-    case 115200:
-        s = B115200;
-        break;
-
-    case 230400:
-        s = B230400;
-        break;
-    default:
-        return EINVAL;
-    }
-
-    struct termios config;
-
-    if (char_interface_->Ioctl(fd_, TCGETS, &config) != 0 ||
-            cfsetspeed(&config, s) != 0 ||
-            char_interface_->Ioctl(fd_, TCSETS, &config) != 0) {
-        AppLogError() << "Failed to set the UART baurate to " << baudrate;
-        return EIO;
-    }
-
-    return 0;
-}
-
-int UartDriverSysfs::Write(const std::vector<uint8_t>& data,
-        uint32_t* bytes_written) {
-    errno = 0;
-    int ret = char_interface_->Write(fd_, data.data(), data.size());
-
-    if (ret == -1) {
-        AppLogError() << "Failed to write to UART device";
-        *bytes_written = 0;
-        return EIO;
-    }
-
-    *bytes_written = ret;
-    return 0;
-}
-
-int UartDriverSysfs::Read(std::vector<uint8_t>* data,
-        uint32_t size,
-        uint32_t* bytes_read) {
-    errno = 0;
-    data->resize(size);
-
-    int ret = char_interface_->Read(fd_, data->data(), size);
-
-    if (ret == -1) {
-        *bytes_read = 0;
-        data->resize(0);
-        if (errno == EAGAIN) {
-            return EAGAIN;
-        }
-        AppLogError() << "Failed to read from UART device";
-        return EIO;
-    }
-
-    *bytes_read = ret;
-    data->resize(ret);
-    return 0;
-}
-int  UartDriverSysfs::GetuPollingFd(int * fd) {
-    *fd = fd_;
-    return fd_;
-}
-uint32_t UartDriverSysfs::getBaudrate(uint32_t* baudrate) {
-    struct termios config;
-    tcgetattr( fd_, &config);
-    speed_t speed;
-    speed = cfgetospeed( &config);
-    switch(speed){
-    case B0:
-        speed = 0;
-        break;
-
-    case B50:
-        speed = 50;
-        break;
-
-    case B75:
-        speed = 75;
-        break;
-
-    case B110:
-        speed = 110;
-        break;
-
-    case B134:
-        speed = 134;
-        break;
-
-    case B150:
-        speed = 150;
-        break;
-
-    case B200:
-        speed = 200;
-        break;
-
-    case B300:
-        speed = 300;
-        break;
-
-    case B600:
-        speed = 600;
-        break;
-
-    case B1200:
-        speed = 1200;
-        break;
-
-    case B1800:
-        speed = 1800;
-        break;
-
-    case B2400:
-        speed = 2400;
-        break;
-
-    case B4800:
-        speed = 4800;
-        break;
-
-    case B9600:
-        speed = 9600;
-        break;
-
-    case B19200:
-        speed = 19200;
-        break;
-
-    case B38400:
-        speed = 38400;
-        break;
-
-    case B57600:
-        speed = 57600;
-        break;
-
-    case B115200:
-        speed = 115200;
-        break;
-
-    case B230400:
-        speed = 230400;
-        break;
-    }
-    *baudrate = speed;
-    return speed;
-}
-
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "UartDriverSysfs.h"
+
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include "CharDevice.h"
+
+// Bytes moved from the tty per read in the background reader.
+const size_t kReaderChunkSize = 4096;
+
+namespace {
+
+// Standard termios speeds, looked up in both directions.
+struct BaudrateSpeed {
+    uint32_t baudrate;
+    speed_t speed;
+};
+
+constexpr BaudrateSpeed kBaudrates[] = {
+    {0, B0}, {50, B50}, {75, B75}, {110, B110}, {134, B134}, {150, B150},
+    {200, B200}, {300, B300}, {600, B600}, {1200, B1200}, {1800, B1800},
+    {2400, B2400}, {4800, B4800}, {9600, B9600}, {19200, B19200},
+    {38400, B38400}, {57600, B57600}, {115200, B115200}, {230400, B230400},
+    {460800, B460800}, {500000, B500000}, {576000, B576000},
+    {921600, B921600}, {1000000, B1000000}, {1152000, B1152000},
+    {1500000, B1500000}, {2000000, B2000000}, {2500000, B2500000},
+    {3000000, B3000000}, {3500000, B3500000}, {4000000, B4000000},
+};
+constexpr size_t kBaudrateCount = sizeof(kBaudrates) / sizeof(kBaudrates[0]);
+constexpr speed_t kNoSpeed = static_cast<speed_t>(-1);
+
+constexpr speed_t speedOf(uint32_t baudrate, size_t i = 0) {
+    return i == kBaudrateCount ? kNoSpeed :
+            kBaudrates[i].baudrate == baudrate ? kBaudrates[i].speed : speedOf(baudrate, i + 1);
+}
+
+constexpr uint32_t baudrateOf(speed_t speed, size_t i = 0) {
+    return i == kBaudrateCount ? 0 :
+            kBaudrates[i].speed == speed ? kBaudrates[i].baudrate : baudrateOf(speed, i + 1);
+}
+
+static_assert(speedOf(115200) == B115200 && baudrateOf(B3000000) == 3000000,
+        "baudrate table out of order");
+static_assert(speedOf(250000) == kNoSpeed, "custom rates are not in the table");
+
+// struct termios2 and its ioctls from <asm/termbits.h>, which cannot be
+// included next to <termios.h>. BOTHER takes the rate from c_ospeed.
+struct Termios2 {
+    tcflag_t c_iflag;
+    tcflag_t c_oflag;
+    tcflag_t c_cflag;
+    tcflag_t c_lflag;
+    cc_t c_line;
+    cc_t c_cc[19];
+    speed_t c_ispeed;
+    speed_t c_ospeed;
+};
+const unsigned long kTcGets2 = _IOR('T', 0x2A, Termios2);
+const unsigned long kTcSets2 = _IOW('T', 0x2B, Termios2);
+const tcflag_t kBother = 0010000;
+const int kInputSpeedShift = 16;
+
+}  // namespace
+
+UartDriverSysfs::UartDriverSysfs(CharDeviceFactory* factory)
+: fd_(-1), stop_fd_(-1), data_fd_(-1), received_bytes_(0), overflow_bytes_(0),
+  reader_failed_(false), char_device_factory_(factory){}
+
+UartDriverSysfs::~UartDriverSysfs() {
+    StopReader();
+    if (fd_ >= 0 && char_interface_ != nullptr) {
+        char_interface_->Close(fd_);
+    }
+}
+
+bool UartDriverSysfs::StartReader(uint32_t buffer_size) {
+    if (fd_ < 0 || ring_ || buffer_size == 0) {
+        return false;
+    }
+
+    stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    data_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stop_fd_ < 0 || data_fd_ < 0) {
+        AppLogError() << "Failed to create reader eventfd for " << path_;
+        StopReader();
+        return false;
+    }
+
+    ring_.reset(new ByteRingBuffer(buffer_size));
+    reader_failed_ = false;
+    reader_ = std::thread(&UartDriverSysfs::ReaderLoop, this);
+    return true;
+}
+
+void UartDriverSysfs::StopReader() {
+    if (reader_.joinable()) {
+        uint64_t one = 1;
+        if (write(stop_fd_, &one, sizeof(one)) < 0) {
+            AppLogError() << "Failed to stop the reader of " << path_;
+        }
+        reader_.join();
+    }
+    if (stop_fd_ >= 0) {
+        close(stop_fd_);
+        stop_fd_ = -1;
+    }
+    if (data_fd_ >= 0) {
+        close(data_fd_);
+        data_fd_ = -1;
+    }
+    ring_.reset();
+}
+
+void UartDriverSysfs::FailReader(const char* reason) {
+    AppLogError() << "UART reader stopped on " << path_ << ": " << reason;
+    reader_failed_ = true;
+    // Wake whoever polls data_fd_ so the next Read reports the failure.
+    uint64_t one = 1;
+    if (write(data_fd_, &one, sizeof(one)) < 0) {
+        AppLogError() << "Failed to signal UART data";
+    }
+}
+
+void UartDriverSysfs::ReaderLoop() {
+    std::vector<uint8_t> chunk(kReaderChunkSize);
+    struct pollfd fds[2];
+    fds[0].fd = fd_;
+    fds[0].events = POLLIN;
+    fds[1].fd = stop_fd_;
+    fds[1].events = POLLIN;
+
+    while (true) {
+        if (char_interface_->Poll(fds, 2, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+            FailReader("poll failed");
+            break;
+        }
+        if (fds[1].revents)
+            break;
+        if (fds[0].revents & (POLLERR | POLLNVAL)) {
+            FailReader("device error");
+            break;
+        }
+        if (!(fds[0].revents & (POLLIN | POLLHUP)))
+            continue;
+
+        ssize_t ret = char_interface_->Read(fd_, chunk.data(), chunk.size());
+        if (ret < 0 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        // A hangup still reads what was received before it, then 0.
+        if (ret <= 0) {
+            FailReader(ret ? "read failed" : "hangup");
+            break;
+        }
+
+        {
+            // A client ring gets the chunk as one record, straight from here.
+            std::lock_guard<std::mutex> lock(sink_mutex_);
+            if (sink_) {
+                received_bytes_ += ret;
+                if (!sink_->Push(chunk.data(), ret))
+                    overflow_bytes_ += ret;
+                continue;
+            }
+        }
+
+        // Keep draining the tty when full so the kernel buffer never
+        // overflows; what does not fit is counted and dropped.
+        size_t pushed = ring_->Push(chunk.data(), ret);
+        received_bytes_ += ret;
+        overflow_bytes_ += ret - pushed;
+        if (pushed) {
+            uint64_t one = 1;
+            if (write(data_fd_, &one, sizeof(one)) < 0) {
+                AppLogHotRateLimited(Error, 1000) << "Failed to signal UART data";
+            }
+        }
+    }
+}
+
+bool UartDriverSysfs::GetReaderStats(UartReaderStats* stats) {
+    if (!ring_) {
+        return false;
+    }
+    stats->capacity = ring_->Capacity();
+    stats->buffered = ring_->Size();
+    stats->received = received_bytes_;
+    stats->overflow = overflow_bytes_;
+    return true;
+}
+
+bool UartDriverSysfs::SetReaderSink(std::shared_ptr<SharedRing> sink) {
+    if (!ring_) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(sink_mutex_);
+    sink_ = std::move(sink);
+    return true;
+}
+
+bool UartDriverSysfs::Init(const std::string& name, bool canonical) {
+    path_ = name;
+    int fd = -1;
+
+    // Get a char device. If char_device_factory_ is set
+    // then this is a unittest and the char device is provided
+    // by the test. Otherwise create a normal CharDevice.
+    if (!char_device_factory_) {
+        char_interface_.reset(new CharDevice());
+    } else {
+        char_interface_ = char_device_factory_->NewCharDevice();
+    }
+
+    // Open as non-blocking as we don't want peripheral_manager to block on a
+    // single client read or write. Reads and writes run on the main loop, so
+    // this holds for canonical devices too: a read without a complete line
+    // returns EAGAIN.
+    fd = char_interface_->Open(path_.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        AppLogError() << "Failed to open " << path_;
+        return false;
+    }
+
+    // Configure the device in raw mode.
+    struct termios config;
+    if (char_interface_->Ioctl(fd, TCGETS, &config)) {
+        AppLogError() << "Failed to read the tty config";
+        close(fd);
+        return false;
+    }
+    if(canonical) {
+        config.c_cflag = CS8 | CLOCAL | CREAD;
+        config.c_lflag |= ICANON;
+        config.c_iflag = IGNPAR;
+        config.c_oflag = 0;
+        config.c_lflag |= ICANON;
+        config.c_cc[VMIN] = 0;
+        config.c_cc[VTIME] = 0;
+    }
+    else {
+        cfmakeraw(&config);
+    }
+
+    if (char_interface_->Ioctl(fd, TCSETSF, &config)) {
+        AppLogError() << "Failed to configure the UART device as Raw.";
+        close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    return true;
+}
+
+int UartDriverSysfs::SetBaudrate(uint32_t baudrate) {
+    speed_t s = speedOf(baudrate);
+    if (s == kNoSpeed) {
+        return baudrate ? SetCustomBaudrate(baudrate) : EINVAL;
+    }
+
+    struct termios config;
+
+    if (char_interface_->Ioctl(fd_, TCGETS, &config) != 0 ||
+            cfsetspeed(&config, s) != 0 ||
+            char_interface_->Ioctl(fd_, TCSETS, &config) != 0) {
+        AppLogError() << "Failed to set the UART baurate to " << baudrate;
+        return EIO;
+    }
+
+    return 0;
+}
+
+int UartDriverSysfs::Write(const std::vector<uint8_t>& data,
+        uint32_t* bytes_written) {
+    errno = 0;
+    int ret = char_interface_->Write(fd_, data.data(), data.size());
+
+    // A full output queue takes nothing now; the caller sees the count.
+    if (ret == -1 && errno == EAGAIN) {
+        *bytes_written = 0;
+        return 0;
+    }
+    if (ret == -1) {
+        AppLogHotRateLimited(Error, 1000) << "Failed to write to UART device";
+        *bytes_written = 0;
+        return EIO;
+    }
+
+    *bytes_written = ret;
+    return 0;
+}
+
+int UartDriverSysfs::Read(std::vector<uint8_t>* data,
+        uint32_t size,
+        uint32_t* bytes_read) {
+    errno = 0;
+    data->resize(size);
+
+    if (ring_) {
+        // Clear the data event before popping, so that bytes pushed after
+        // this point signal it again.
+        uint64_t count = 0;
+        if (read(data_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+            AppLogHotRateLimited(Error, 1000) << "Failed to clear UART data event";
+        }
+        // Sampled before popping: the reader pushes everything it got
+        // before it fails, so an empty pop after this means no more data.
+        bool failed = reader_failed_;
+        *bytes_read = ring_->Pop(data->data(), size);
+        data->resize(*bytes_read);
+        // After a reader failure the event stays set, so every poller
+        // gets to see the EIO.
+        if (ring_->Size() || failed) {
+            uint64_t one = 1;
+            if (write(data_fd_, &one, sizeof(one)) < 0) {
+                AppLogHotRateLimited(Error, 1000) << "Failed to signal UART data";
+            }
+        }
+        if (*bytes_read)
+            return 0;
+        return failed ? EIO : EAGAIN;
+    }
+
+    int ret = char_interface_->Read(fd_, data->data(), size);
+
+    if (ret == -1) {
+        *bytes_read = 0;
+        data->resize(0);
+        if (errno == EAGAIN) {
+            return EAGAIN;
+        }
+        AppLogHotRateLimited(Error, 1000) << "Failed to read from UART device";
+        return EIO;
+    }
+
+    *bytes_read = ret;
+    data->resize(ret);
+    return 0;
+}
+int UartDriverSysfs::FlushInput() {
+    // The tty first, then what the reader already moved into the ring. A
+    // chunk the reader is pushing right now may still get through.
+    if (char_interface_->Ioctl(fd_, TCFLSH, reinterpret_cast<void*>(TCIFLUSH)) != 0) {
+        AppLogHotRateLimited(Error, 1000) << "Failed to flush UART input";
+        return EIO;
+    }
+    if (ring_) {
+        uint64_t count = 0;
+        if (read(data_fd_, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+            AppLogHotRateLimited(Error, 1000) << "Failed to clear UART data event";
+        }
+        uint8_t stale[kReaderChunkSize];
+        while (ring_->Pop(stale, sizeof(stale))) {
+        }
+    }
+    return 0;
+}
+
+int  UartDriverSysfs::GetuPollingFd(int * fd) {
+    *fd = ring_ ? data_fd_ : fd_;
+    return *fd;
+}
+uint32_t UartDriverSysfs::getBaudrate(uint32_t* baudrate) {
+    // termios2 reports the actual rate, custom ones included.
+    Termios2 config2;
+    if (char_interface_->Ioctl(fd_, kTcGets2, &config2) == 0) {
+        *baudrate = config2.c_ospeed;
+        return *baudrate;
+    }
+
+    struct termios config;
+    *baudrate = 0;
+    if (char_interface_->Ioctl(fd_, TCGETS, &config) == 0) {
+        *baudrate = baudrateOf(cfgetospeed(&config));
+    }
+    return *baudrate;
+}
+
+int UartDriverSysfs::SetCustomBaudrate(uint32_t baudrate) {
+    Termios2 config;
+    if (char_interface_->Ioctl(fd_, kTcGets2, &config) != 0) {
+        AppLogError() << "UART does not support custom baudrate " << baudrate;
+        return EINVAL;
+    }
+    // Clearing the input speed bits makes the input follow the output.
+    config.c_cflag &= ~(CBAUD | (CBAUD << kInputSpeedShift));
+    config.c_cflag |= kBother;
+    config.c_ispeed = baudrate;
+    config.c_ospeed = baudrate;
+    if (char_interface_->Ioctl(fd_, kTcSets2, &config) != 0) {
+        AppLogError() << "Failed to set the UART baudrate to " << baudrate;
+        return EIO;
+    }
+    return 0;
+}
+
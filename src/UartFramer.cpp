@@ -0,0 +1,297 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "UartFramer.h"
+#include <string.h>
+#include <algorithm>
+#include "Checksum.h"
+
+namespace {
+
+// Longest "maxLength" a framer accepts.
+const size_t kMaxFrameLength = 1 << 20;
+
+// Frames end at a delimiter byte, found a chunk at a time with memchr.
+class DelimiterFramer : public UartFramer {
+public:
+    explicit DelimiterFramer(const UartFramerConfig& config)
+    : UartFramer(config), discarding_(false) {}
+
+protected:
+    void Decode(const uint8_t* data, size_t size, Frames* frames) override {
+        const uint8_t* end = data + size;
+        while (data < end) {
+            const uint8_t* found = static_cast<const uint8_t*>(
+                    memchr(data, config_.delimiter, end - data));
+            if (!found) {
+                Append(data, end);
+                return;
+            }
+            Append(data, config_.keep_delimiter ? found + 1 : found);
+            if (!discarding_ && !frame_.empty())
+                frames->push_back(std::move(frame_));
+            frame_.clear();
+            discarding_ = false;
+            data = found + 1;
+        }
+    }
+
+private:
+    void Append(const uint8_t* begin, const uint8_t* end) {
+        if (discarding_)
+            return;
+        // An oversized frame is skipped up to the next delimiter.
+        if (frame_.size() + (end - begin) > config_.max_length) {
+            Drop();
+            frame_.clear();
+            discarding_ = true;
+            return;
+        }
+        frame_.insert(frame_.end(), begin, end);
+    }
+
+    std::vector<uint8_t> frame_;
+    bool discarding_;
+};
+
+// Frames start with a length prefix counting the bytes after it. There is
+// nothing to resynchronize on, so an oversized length is dropped and the
+// next bytes are read as a new prefix.
+class LengthFramer : public UartFramer {
+public:
+    explicit LengthFramer(const UartFramerConfig& config)
+    : UartFramer(config), prefix_size_(0), length_(0) {}
+
+protected:
+    void Decode(const uint8_t* data, size_t size, Frames* frames) override {
+        size_t i = 0;
+        while (i < size) {
+            if (prefix_size_ < config_.length_bytes) {
+                uint32_t byte = data[i++];
+                length_ = config_.big_endian ? (length_ << 8) | byte
+                        : length_ | (byte << (8 * prefix_size_));
+                if (++prefix_size_ < config_.length_bytes)
+                    continue;
+                if (length_ > config_.max_length)
+                    Drop();
+                if (length_ == 0 || length_ > config_.max_length)
+                    Reset();
+                continue;
+            }
+            size_t take = std::min<size_t>(length_ - frame_.size(), size - i);
+            frame_.insert(frame_.end(), data + i, data + i + take);
+            i += take;
+            if (frame_.size() == length_) {
+                frames->push_back(std::move(frame_));
+                Reset();
+            }
+        }
+    }
+
+private:
+    void Reset() {
+        frame_.clear();
+        prefix_size_ = 0;
+        length_ = 0;
+    }
+
+    std::vector<uint8_t> frame_;
+    size_t prefix_size_;
+    uint32_t length_;
+};
+
+// Consistent overhead byte stuffing: frames end at a zero byte and are
+// decoded once complete.
+class CobsFramer : public UartFramer {
+public:
+    explicit CobsFramer(const UartFramerConfig& config)
+    : UartFramer(config), discarding_(false) {}
+
+protected:
+    void Decode(const uint8_t* data, size_t size, Frames* frames) override {
+        // COBS adds a byte per 254 and one in front.
+        size_t max_encoded = config_.max_length + config_.max_length / 254 + 1;
+        const uint8_t* end = data + size;
+        while (data < end) {
+            const uint8_t* found = static_cast<const uint8_t*>(memchr(data, 0, end - data));
+            const uint8_t* stop = found ? found : end;
+            if (!discarding_ && encoded_.size() + (stop - data) > max_encoded) {
+                Drop();
+                encoded_.clear();
+                discarding_ = true;
+            }
+            if (!discarding_)
+                encoded_.insert(encoded_.end(), data, stop);
+            if (!found)
+                return;
+            if (!discarding_ && !encoded_.empty()) {
+                std::vector<uint8_t> frame;
+                if (Unstuff(&frame))
+                    frames->push_back(std::move(frame));
+                else
+                    Drop();
+            }
+            encoded_.clear();
+            discarding_ = false;
+            data = found + 1;
+        }
+    }
+
+private:
+    bool Unstuff(std::vector<uint8_t>* frame) const {
+        frame->reserve(encoded_.size());
+        size_t i = 0;
+        while (i < encoded_.size()) {
+            size_t code = encoded_[i++];
+            if (i + code - 1 > encoded_.size())
+                return false;
+            frame->insert(frame->end(), encoded_.begin() + i, encoded_.begin() + i + code - 1);
+            i += code - 1;
+            if (code != 0xff && i < encoded_.size())
+                frame->push_back(0);
+        }
+        return frame->size() <= config_.max_length;
+    }
+
+    std::vector<uint8_t> encoded_;
+    bool discarding_;
+};
+
+// RFC 1055 SLIP: frames end at END and are unescaped as bytes arrive.
+class SlipFramer : public UartFramer {
+public:
+    explicit SlipFramer(const UartFramerConfig& config)
+    : UartFramer(config), escaped_(false), discarding_(false) {}
+
+protected:
+    void Decode(const uint8_t* data, size_t size, Frames* frames) override {
+        for (size_t i = 0; i < size; i++) {
+            uint8_t byte = data[i];
+            if (byte == kEnd) {
+                if (escaped_)
+                    Discard();
+                else if (!discarding_ && !frame_.empty())
+                    frames->push_back(std::move(frame_));
+                frame_.clear();
+                escaped_ = false;
+                discarding_ = false;
+                continue;
+            }
+            if (discarding_)
+                continue;
+            if (escaped_) {
+                escaped_ = false;
+                if (byte == kEscEnd) {
+                    byte = kEnd;
+                } else if (byte == kEscEsc) {
+                    byte = kEsc;
+                } else {
+                    Discard();
+                    continue;
+                }
+            } else if (byte == kEsc) {
+                escaped_ = true;
+                continue;
+            }
+            if (frame_.size() == config_.max_length) {
+                Discard();
+                continue;
+            }
+            frame_.push_back(byte);
+        }
+    }
+
+private:
+    static const uint8_t kEnd = 0xc0;
+    static const uint8_t kEsc = 0xdb;
+    static const uint8_t kEscEnd = 0xdc;
+    static const uint8_t kEscEsc = 0xdd;
+
+    // Skips the rest of a malformed or oversized frame.
+    void Discard() {
+        Drop();
+        frame_.clear();
+        escaped_ = false;
+        discarding_ = true;
+    }
+
+    std::vector<uint8_t> frame_;
+    bool escaped_;
+    bool discarding_;
+};
+
+}  // namespace
+
+std::unique_ptr<UartFramer> UartFramer::Create(const UartFramerConfig& config) {
+    if (config.max_length == 0 || config.max_length > kMaxFrameLength)
+        return nullptr;
+    if (!config.checksum.empty() &&
+            (!IsChecksum(config.checksum) || config.max_length < ChecksumSize(config.checksum)))
+        return nullptr;
+
+    if (config.type == kFramingDelimiter)
+        return std::unique_ptr<UartFramer>(new DelimiterFramer(config));
+    if (config.type == kFramingLength) {
+        if (config.length_bytes != 1 && config.length_bytes != 2 && config.length_bytes != 4)
+            return nullptr;
+        return std::unique_ptr<UartFramer>(new LengthFramer(config));
+    }
+    if (config.type == kFramingCobs)
+        return std::unique_ptr<UartFramer>(new CobsFramer(config));
+    if (config.type == kFramingSlip)
+        return std::unique_ptr<UartFramer>(new SlipFramer(config));
+    return nullptr;
+}
+
+void UartFramer::Feed(const uint8_t* data, size_t size, Frames* frames) {
+    size_t first = frames->size();
+    Decode(data, size, frames);
+    if (config_.checksum.empty()) {
+        frame_count_ += frames->size() - first;
+        return;
+    }
+
+    size_t kept = first;
+    for (size_t i = first; i < frames->size(); i++) {
+        if (!VerifyChecksum(config_.checksum, &(*frames)[i])) {
+            Drop();
+            continue;
+        }
+        if (kept != i)
+            (*frames)[kept] = std::move((*frames)[i]);
+        kept++;
+    }
+    frames->resize(kept);
+    frame_count_ += kept - first;
+}
+
+bool AppendUartReply(const uint8_t* data, size_t size, const std::vector<uint8_t>& terminator,
+        size_t reply_size, std::vector<uint8_t>* reply) {
+    // The terminator may straddle the previous read.
+    size_t from = reply->size() >= terminator.size() ? reply->size() - terminator.size() + 1 : 0;
+    reply->insert(reply->end(), data, data + size);
+    if (!terminator.empty()) {
+        auto found = std::search(reply->begin() + from, reply->end(), terminator.begin(), terminator.end());
+        if (found != reply->end()) {
+            reply->erase(found + terminator.size(), reply->end());
+            return true;
+        }
+    }
+    if (!reply_size || reply->size() < reply_size)
+        return false;
+    reply->resize(reply_size);
+    return true;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Size and CPU cost of binary payloads in a Luna reply and request: the
+// JSON byte array the methods use without "encoding", against base64 and
+// hex strings. Each round builds the reply as the handlers do, stringifies
+// it, parses it back and extracts the bytes, as a client would.
+//
+// Usage: DataEncodingBenchmark [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <pbnjson.hpp>
+#include "DataEncoding.h"
+
+struct Result {
+    size_t json_size;
+    double us_per_round;
+};
+
+static Result runArray(const std::vector<uint8_t>& data, long iterations) {
+    size_t json_size = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long n = 0; n < iterations; n++) {
+        pbnjson::JValue data_array = pbnjson::JArray();
+        for (size_t i = 0; i < data.size(); i++)
+            data_array << data[i];
+        std::string payload = pbnjson::JObject{{"returnValue", true}, {"data", data_array}}.stringify();
+        json_size = payload.size();
+
+        pbnjson::JValue parsed = pbnjson::JDomParser::fromString(payload);
+        pbnjson::JValue array = parsed["data"];
+        std::vector<uint8_t> out;
+        int size = array.arraySize();
+        for (int i = 0; i < size; i++)
+            out.push_back(array[i].asNumber<int>());
+        if (out != data) {
+            fprintf(stderr, "array round trip failed\n");
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return Result{json_size, elapsed.count() / iterations};
+}
+
+static Result runEncoded(const std::vector<uint8_t>& data, const std::string& encoding, long iterations) {
+    size_t json_size = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long n = 0; n < iterations; n++) {
+        std::string text = EncodeData(data.data(), data.size(), encoding);
+        std::string payload = pbnjson::JObject{{"returnValue", true}, {"data", text}}.stringify();
+        json_size = payload.size();
+
+        pbnjson::JValue parsed = pbnjson::JDomParser::fromString(payload);
+        std::vector<uint8_t> out;
+        if (!DecodeData(parsed["data"].asString(), encoding, &out) || out != data) {
+            fprintf(stderr, "%s round trip failed\n", encoding.c_str());
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return Result{json_size, elapsed.count() / iterations};
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 2000;
+    printf("%6s %-7s %9s %12s\n", "bytes", "format", "json size", "us/round");
+    for (size_t size : {16, 256, 4096}) {
+        std::vector<uint8_t> data(size);
+        for (size_t i = 0; i < size; i++)
+            data[i] = static_cast<uint8_t>(i * 151 + 7);
+        Result array = runArray(data, iterations);
+        Result base64 = runEncoded(data, kEncodingBase64, iterations);
+        Result hex = runEncoded(data, kEncodingHex, iterations);
+        printf("%6zu %-7s %9zu %12.2f\n", size, "array", array.json_size, array.us_per_round);
+        printf("%6zu %-7s %9zu %12.2f\n", size, "base64", base64.json_size, base64.us_per_round);
+        printf("%6zu %-7s %9zu %12.2f\n", size, "hex", hex.json_size, hex.us_per_round);
+    }
+    return 0;
+}
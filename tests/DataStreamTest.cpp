@@ -0,0 +1,106 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Loopback checks of the stream socket without the Luna hub: socket mode,
+// frames and fd passing in both directions, peer credentials, dropping
+// frames for a peer that does not read, and the refusal of a second peer.
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include "DataStream.h"
+#include "TestCheck.h"
+
+int main() {
+    char dir[] = "/tmp/datastream-test-XXXXXX";
+    CHECK(mkdtemp(dir));
+    std::string path = std::string(dir) + "/stream";
+
+    umask(0);
+    std::unique_ptr<DataStream> service = DataStream::Listen(path);
+    CHECK(service);
+    struct stat st;
+    CHECK(stat(path.c_str(), &st) == 0);
+    CHECK((st.st_mode & 0777) == 0660);
+
+    std::unique_ptr<DataStream> client = DataStream::Connect(path);
+    CHECK(client);
+    CHECK(service->Accept());
+    CHECK(service->PeerPid() == getpid());
+    CHECK(service->PeerUid() == getuid());
+
+    const uint8_t hello[] = {'t', 'o', 'k', 'e', 'n'};
+    CHECK(client->Send(kStreamFrameHello, 0, hello, sizeof(hello)));
+    StreamFrameHeader header;
+    std::vector<uint8_t> payload;
+    CHECK(service->Receive(&header, &payload));
+    CHECK(header.type == kStreamFrameHello);
+    CHECK(payload == std::vector<uint8_t>(hello, hello + sizeof(hello)));
+
+    std::vector<uint8_t> data(kStreamMaxPayload);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = i * 7;
+    CHECK(service->Send(kStreamFrameData, 42, data.data(), data.size()));
+    CHECK(client->Receive(&header, &payload));
+    CHECK(header.type == kStreamFrameData);
+    CHECK(header.sequence == 42);
+    CHECK(header.length == data.size());
+    CHECK(payload == data);
+    CHECK(!service->Send(kStreamFrameData, 43, data.data(), data.size() + 1));
+
+    int pipe_fds[2];
+    CHECK(pipe(pipe_fds) == 0);
+    uint32_t capacity = 4096;
+    CHECK(service->Send(kStreamFrameRing, 0, reinterpret_cast<const uint8_t*>(&capacity),
+            sizeof(capacity), {pipe_fds[1]}));
+    std::vector<int> fds;
+    CHECK(client->Receive(&header, &payload, &fds));
+    CHECK(header.type == kStreamFrameRing);
+    CHECK(fds.size() == 1);
+    CHECK(write(fds[0], "x", 1) == 1);
+    char byte = 0;
+    CHECK(read(pipe_fds[0], &byte, 1) == 1 && byte == 'x');
+    close(fds[0]);
+    close(pipe_fds[0]);
+    close(pipe_fds[1]);
+
+    // A peer that stops reading costs frames, never a blocked Send().
+    bool sent = true;
+    for (int i = 0; i < 4096 && sent; i++)
+        sent = service->Send(kStreamFrameData, i, data.data(), data.size());
+    CHECK(!sent);
+    CHECK(service->Dropped() == 1);
+
+    // A second client is refused while the first one is connected.
+    std::unique_ptr<DataStream> intruder = DataStream::Connect(path);
+    CHECK(intruder);
+    CHECK(!service->Accept());
+    CHECK(!intruder->Receive(&header, &payload));
+
+    client.reset();
+    CHECK(!service->Receive(&header, &payload));
+    service->Disconnect();
+    client = DataStream::Connect(path);
+    CHECK(client);
+    CHECK(service->Accept());
+
+    service.reset();
+    CHECK(access(path.c_str(), F_OK) < 0);
+    rmdir(dir);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Latency of reporting a call on a closed handle, the routine error of a
+// client that retries after release: the PeripheralManagerException the
+// client layer used to throw and the handler caught, against the Status
+// return it uses now. Both sides end with the error_text lookup the
+// handler does for the reply.
+//
+// Usage: ErrorPathBenchmark [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "HandleTable.h"
+#include "PeripheralManagerException.h"
+
+typedef PeripheralManagerErrors Status;
+
+static HandleTable<int> table;
+
+__attribute__((noinline)) static void throwingCall(int32_t handle) {
+    if (!table.Get(handle))
+        throw PeripheralManagerException("Device not open", PeripheralManagerErrors::kEPERM);
+}
+
+__attribute__((noinline)) static Status statusCall(int32_t handle) {
+    if (!table.Get(handle))
+        return PeripheralManagerErrors::kEPERM;
+    return PeripheralManagerErrors::kNoError;
+}
+
+static size_t throwingHandler(int32_t handle) {
+    try {
+        throwingCall(handle);
+        return 0;
+    } catch (PeripheralManagerException& err) {
+        return error_text.at(err.getErrorCode()).size();
+    }
+}
+
+static size_t statusHandler(int32_t handle) {
+    Status status = statusCall(handle);
+    if (status != PeripheralManagerErrors::kNoError)
+        return error_text.at(status).size();
+    return 0;
+}
+
+template <typename Handler>
+static double nsPerCall(long iterations, int32_t handle, Handler handler) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        if (!handler(handle)) {
+            fprintf(stderr, "call %ld did not fail\n", i);
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    int32_t closed = table.Add(std::unique_ptr<int>(new int(0)));
+    table.Remove(closed);
+
+    double thrown = nsPerCall(iterations, closed, throwingHandler);
+    double status = nsPerCall(iterations, closed, statusHandler);
+    printf("throw/catch:   %8.0f ns/call\n", thrown);
+    printf("Status return: %8.0f ns/call\n", status);
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Toggle rate of GpioDriverSysfs against a fake /sys/class/gpio tree in a
+// temporary directory, compared with the openat()/write()/close() sequence
+// the driver used per call before it kept the attribute fds open.
+//
+// Usage: GpioSysfsBenchmark [iterations]
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <string>
+#include "GpioDriverSysfs.h"
+
+static bool makeFakePin(const std::string& root, uint32_t index) {
+    std::string pin = root + "/gpio" + std::to_string(index);
+    if (mkdir(pin.c_str(), 0755) < 0)
+        return false;
+    for (const char* attribute : {"value", "direction", "edge"}) {
+        int fd = open((pin + "/" + attribute).c_str(), O_CREAT | O_WRONLY, 0644);
+        if (fd < 0)
+            return false;
+        close(fd);
+    }
+    return true;
+}
+
+template <typename Toggle>
+static double nsPerToggle(long iterations, Toggle toggle) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        if (!toggle(i & 1)) {
+            fprintf(stderr, "toggle %ld failed\n", i);
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 200000;
+    char root[] = "/tmp/gpio-benchmark-XXXXXX";
+    if (!mkdtemp(root) || !makeFakePin(root, 17)) {
+        perror("fake sysfs");
+        return 1;
+    }
+
+    GpioDriverSysfs driver(nullptr, root);
+    if (!driver.Init(0, 17) || !driver.SetDirection(kDirectionOutInitiallyLow)) {
+        fprintf(stderr, "Init failed\n");
+        return 1;
+    }
+    double persistent = nsPerToggle(iterations, [&](bool value) {
+        return driver.SetValue(value);
+    });
+
+    int pin_fd = open((std::string(root) + "/gpio17").c_str(), O_RDONLY);
+    double per_call = nsPerToggle(iterations, [&](bool value) {
+        int fd = openat(pin_fd, "value", O_RDWR);
+        if (fd < 0)
+            return false;
+        ssize_t bytes = write(fd, value ? "1" : "0", 1);
+        close(fd);
+        return bytes == 1;
+    });
+    close(pin_fd);
+
+    printf("openat/write/close: %8.0f ns/toggle %10.0f toggles/s\n", per_call, 1e9 / per_call);
+    printf("persistent pwrite:  %8.0f ns/toggle %10.0f toggles/s\n", persistent, 1e9 / persistent);
+
+    std::string pin = std::string(root) + "/gpio17";
+    for (const char* attribute : {"value", "direction", "edge"})
+        unlink((pin + "/" + attribute).c_str());
+    rmdir(pin.c_str());
+    rmdir(root);
+    return 0;
+}
@@ -0,0 +1,212 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// ModbusMaster against a simulated slave on the master side of a pseudo
+// terminal at 115200 baud: reads, single and multiple writes, exception,
+// CRC and timeout replies, cached polling, stopping with requests queued,
+// and the 3.5 character silence before every request.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <atomic>
+#include <future>
+#include "Checksum.h"
+#include "ModbusMaster.h"
+#include "TestCheck.h"
+#include "UartDriverSysfs.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// Units the slave treats specially.
+const uint8_t kUnit = 1;
+const uint8_t kBadCrcUnit = 8;
+const uint8_t kSilentUnit = 9;
+
+// The fixed inter-frame gap above 19200 baud.
+const std::chrono::microseconds kFrameGap(1750);
+
+const int kResponseTimeoutMs = 200;
+
+class Slave {
+public:
+    explicit Slave(int fd) : fd_(fd), quit_(false), min_gap_us_(INT64_MAX) {
+        for (int i = 0; i < 100; i++)
+            registers_[i] = i * 10;
+        thread_ = std::thread(&Slave::Run, this);
+    }
+
+    ~Slave() {
+        quit_ = true;
+        thread_.join();
+    }
+
+    uint16_t Register(int address) { return registers_[address]; }
+    std::chrono::microseconds MinGap() { return std::chrono::microseconds(min_gap_us_); }
+
+private:
+    void Run() {
+        std::vector<uint8_t> frame;
+        Clock::time_point replied;
+        bool measure = false;
+        while (!quit_) {
+            struct pollfd pfd = {fd_, POLLIN, 0};
+            if (poll(&pfd, 1, 5) <= 0)
+                continue;
+            uint8_t buffer[256];
+            ssize_t size = read(fd_, buffer, sizeof(buffer));
+            if (size <= 0)
+                continue;
+            if (frame.empty() && measure) {
+                int64_t gap = std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - replied).count();
+                min_gap_us_ = std::min<int64_t>(min_gap_us_, gap);
+            }
+            frame.insert(frame.end(), buffer, buffer + size);
+            size_t expected = frame.size() > 6 && frame[1] == 0x10 ? 9 + frame[6] : 8;
+            if (frame.size() < expected)
+                continue;
+            CHECK(frame.size() == expected);
+            CHECK(VerifyChecksum(kChecksumCrc16Modbus, &frame));
+            std::vector<uint8_t> reply = Reply(frame);
+            frame.clear();
+            if (reply.empty())
+                continue;
+            CHECK(write(fd_, reply.data(), reply.size()) == static_cast<ssize_t>(reply.size()));
+            replied = Clock::now();
+            measure = true;
+        }
+    }
+
+    std::vector<uint8_t> Reply(const std::vector<uint8_t>& request) {
+        if (request[0] == kSilentUnit)
+            return std::vector<uint8_t>();
+        std::vector<uint8_t> reply = {request[0], request[1]};
+        uint16_t address = request[2] << 8 | request[3];
+        uint16_t count = request[4] << 8 | request[5];
+        if (address >= 100) {
+            reply[1] |= 0x80;
+            reply.push_back(2);
+        } else if (request[1] == 0x03) {
+            reply.push_back(count * 2);
+            for (int i = 0; i < count; i++) {
+                reply.push_back(registers_[address + i] >> 8);
+                reply.push_back(registers_[address + i]);
+            }
+        } else if (request[1] == 0x06) {
+            registers_[address] = count;
+            reply.insert(reply.end(), request.begin() + 2, request.begin() + 6);
+        } else if (request[1] == 0x10) {
+            for (int i = 0; i < count; i++)
+                registers_[address + i] = request[7 + 2 * i] << 8 | request[8 + 2 * i];
+            reply.insert(reply.end(), request.begin() + 2, request.begin() + 6);
+        }
+        AppendChecksum(kChecksumCrc16Modbus, &reply);
+        if (request[0] == kBadCrcUnit)
+            reply.back() ^= 0xff;
+        return reply;
+    }
+
+    int fd_;
+    std::atomic<bool> quit_;
+    std::atomic<uint16_t> registers_[100];
+    std::atomic<int64_t> min_gap_us_;
+    std::thread thread_;
+};
+
+static ModbusResult readRegisters(ModbusMaster* master, uint8_t unit, uint16_t address, uint16_t count) {
+    std::promise<ModbusResult> result;
+    master->ReadHoldingRegisters(unit, address, count, [&](const ModbusResult& r) {
+        result.set_value(r);
+    });
+    return result.get_future().get();
+}
+
+static ModbusResult writeRegisters(ModbusMaster* master, uint16_t address, const std::vector<uint16_t>& values) {
+    std::promise<ModbusResult> result;
+    master->WriteRegisters(kUnit, address, values, [&](const ModbusResult& r) {
+        result.set_value(r);
+    });
+    return result.get_future().get();
+}
+
+int main() {
+    int pty = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(pty >= 0);
+    CHECK(grantpt(pty) == 0 && unlockpt(pty) == 0);
+    UartDriverSysfs driver(nullptr);
+    CHECK(driver.Init(ptsname(pty)));
+    CHECK(driver.SetBaudrate(115200) == 0);
+    Slave slave(pty);
+    std::unique_ptr<ModbusMaster> master(new ModbusMaster(&driver, kResponseTimeoutMs));
+
+    ModbusResult result = readRegisters(master.get(), kUnit, 5, 3);
+    CHECK(result.error == ModbusError::kNone);
+    CHECK(result.registers == std::vector<uint16_t>({50, 60, 70}));
+
+    CHECK(writeRegisters(master.get(), 5, {777}).error == ModbusError::kNone);
+    CHECK(slave.Register(5) == 777);
+    CHECK(writeRegisters(master.get(), 6, {1, 2, 3}).error == ModbusError::kNone);
+    CHECK(slave.Register(6) == 1 && slave.Register(7) == 2 && slave.Register(8) == 3);
+
+    result = readRegisters(master.get(), kUnit, 150, 1);
+    CHECK(result.error == ModbusError::kException);
+    CHECK(result.exception_code == 2);
+
+    CHECK(readRegisters(master.get(), kBadCrcUnit, 0, 1).error == ModbusError::kCrc);
+
+    Clock::time_point start = Clock::now();
+    CHECK(readRegisters(master.get(), kSilentUnit, 0, 1).error == ModbusError::kTimeout);
+    CHECK(Clock::now() - start >= std::chrono::milliseconds(200));
+
+    // Polled values are served from the cache once the first poll ran.
+    uint32_t poll = master->AddPoll(kUnit, 0, 20, 20);
+    std::vector<uint16_t> values;
+    uint64_t age_ms = 0;
+    start = Clock::now();
+    while (!master->GetCachedRegisters(kUnit, 6, 3, &values, &age_ms)) {
+        CHECK(Clock::now() - start < std::chrono::seconds(1));
+        usleep(1000);
+    }
+    CHECK(values == std::vector<uint16_t>({1, 2, 3}));
+    CHECK(!master->GetCachedRegisters(kUnit, 18, 3, &values, &age_ms));
+    CHECK(master->RemovePoll(poll));
+    CHECK(!master->GetCachedRegisters(kUnit, 6, 3, &values, &age_ms));
+
+    for (int i = 0; i < 20; i++)
+        CHECK(readRegisters(master.get(), kUnit, 0, 10).error == ModbusError::kNone);
+    CHECK(slave.MinGap() >= kFrameGap);
+
+    // Stopping interrupts the request on the wire rather than waiting out
+    // its timeout, and fails the queued one.
+    std::promise<ModbusError> first;
+    std::promise<ModbusError> second;
+    master->ReadHoldingRegisters(kSilentUnit, 0, 1, [&](const ModbusResult& r) {
+        first.set_value(r.error);
+    });
+    master->ReadHoldingRegisters(kSilentUnit, 0, 1, [&](const ModbusResult& r) {
+        second.set_value(r.error);
+    });
+    usleep(20000);
+    Clock::time_point stop = Clock::now();
+    master.reset();
+    CHECK(Clock::now() - stop < std::chrono::milliseconds(kResponseTimeoutMs / 2));
+    CHECK(first.get_future().get() == ModbusError::kStopped);
+    CHECK(second.get_future().get() == ModbusError::kStopped);
+
+    return 0;
+}
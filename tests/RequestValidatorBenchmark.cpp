@@ -0,0 +1,122 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Per-request cost of checking and reading the properties of a parsed
+// spi/transfer request: ReadParams against the loop each handler carried
+// before, which converted the key with asString() once per allowed name,
+// built the error reply inside the loop and then looked every property up
+// again to read it. Only the check and the reads are timed; both sides see
+// the same parsed request.
+//
+// Usage: RequestValidatorBenchmark [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <pbnjson.hpp>
+#include "RequestValidator.h"
+
+struct TransferParams {
+    Param<int64_t> handle;
+    Param<int64_t> size;
+    Param<std::string> name;
+    Param<pbnjson::JValue> data;
+    Param<std::string> encoding;
+};
+
+static const ParamSpec<TransferParams> kSpiDeviceTransferParams[] = {
+    {"handle", &TransferParams::handle},
+    {"size", &TransferParams::size},
+    {"name", &TransferParams::name},
+    {"data", &TransferParams::data, ParamType::kAny},
+    {"encoding", &TransferParams::encoding},
+};
+
+static bool legacyCheck(const pbnjson::JValue& parsed, pbnjson::JValue* response_json,
+        TransferParams* params) {
+    std::string temp;
+    bool extra_property = false;
+    for (auto ii : parsed) {
+        if (ii.first.asString() == "handle" || ii.first.asString() == "size" ||
+                ii.first.asString() == "name" || ii.first.asString() == "data" ||
+                ii.first.asString() == "encoding") {
+            continue;
+        } else {
+            extra_property = true;
+            temp = ii.first.asString();
+            *response_json = pbnjson::JObject{{"returnValue", false},{"errorText", temp + " property not allowed"}};
+        }
+    }
+    if (extra_property)
+        return false;
+    if (parsed.hasKey("handle") && !parsed["handle"].isNumber())
+        return false;
+    if (parsed.hasKey("size") && !parsed["size"].isNumber())
+        return false;
+    if (parsed.hasKey("name") && !parsed["name"].isString())
+        return false;
+    if (parsed.hasKey("encoding") && !parsed["encoding"].isString())
+        return false;
+    params->handle.value = parsed["handle"].asNumber<int64_t>();
+    params->size.value = parsed["size"].asNumber<int64_t>();
+    params->name.value = parsed["name"].asString();
+    params->data.value = parsed["data"];
+    params->encoding.value = parsed["encoding"].asString();
+    return true;
+}
+
+template <typename Check>
+static double nsPerRequest(long iterations, bool expected, Check check) {
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations; i++) {
+        if (check() != expected) {
+            fprintf(stderr, "check %ld returned %d\n", i, !expected);
+            exit(1);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+int main(int argc, char** argv) {
+    long iterations = argc > 1 ? atol(argv[1]) : 1000000;
+    const struct {
+        const char* name;
+        const char* payload;
+        bool valid;
+    } requests[] = {
+        {"valid", "{\"encoding\":\"hex\",\"data\":\"a5a5a5a5\",\"size\":4,\"handle\":3}", true},
+        {"extra key", "{\"handle\":3,\"data\":\"a5a5\",\"encoding\":\"hex\",\"speed\":1000000}", false},
+    };
+
+    printf("%-10s %12s %12s\n", "request", "legacy ns", "table ns");
+    for (const auto& request : requests) {
+        pbnjson::JValue parsed = pbnjson::JDomParser::fromString(request.payload);
+        double legacy = nsPerRequest(iterations, request.valid, [&]() {
+            pbnjson::JValue response_json;
+            TransferParams params;
+            return legacyCheck(parsed, &response_json, &params);
+        });
+        double table = nsPerRequest(iterations, request.valid, [&]() {
+            std::string error;
+            TransferParams params;
+            return ReadParams(parsed, kSpiDeviceTransferParams, &params, &error);
+        });
+        printf("%-10s %12.0f %12.0f\n", request.name, legacy, table);
+    }
+    return 0;
+}
@@ -0,0 +1,145 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Checks of the memfd ring shared with stream clients: sealing, the
+// handover through Attach(), wraparound, record framing, drop accounting,
+// a client that corrupts the head, and a producer and consumer thread
+// running at once.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+#include "SharedRing.h"
+#include "TestCheck.h"
+
+static void checkHandover() {
+    std::unique_ptr<SharedRing> ring = SharedRing::Create("test", 100);
+    CHECK(ring);
+    CHECK(ring->Capacity() == 128);
+    CHECK(ftruncate(ring->MemFd(), 0) < 0);
+
+    std::unique_ptr<SharedRing> view = SharedRing::Attach(dup(ring->MemFd()), dup(ring->EventFd()));
+    CHECK(view);
+    CHECK(view->Capacity() == 128);
+
+    uint8_t data[100];
+    for (int i = 0; i < 100; i++)
+        data[i] = i;
+    // 100 bytes and a header a round against 128 of capacity wraps on
+    // most rounds.
+    for (int round = 0; round < 10; round++) {
+        CHECK(ring->Push(data, sizeof(data)));
+        CHECK(!ring->Push(data, sizeof(data)));
+        uint64_t count;
+        CHECK(read(view->EventFd(), &count, sizeof(count)) == sizeof(count));
+        uint8_t out[128];
+        CHECK(view->Pop(out, sizeof(out)) == sizeof(data));
+        CHECK(memcmp(out, data, sizeof(data)) == 0);
+    }
+    CHECK(view->Dropped() == 10);
+    CHECK(view->Pop(data, sizeof(data)) == 0);
+
+    // Records come back one per Pop() with their boundaries, and a short
+    // buffer truncates a record without losing the next one.
+    CHECK(ring->Push(data, 3));
+    CHECK(ring->Push(data + 3, 5));
+    CHECK(ring->Push(data + 8, 20));
+    uint8_t out[32];
+    CHECK(view->Pop(out, sizeof(out)) == 3);
+    CHECK(memcmp(out, data, 3) == 0);
+    CHECK(view->Pop(out, sizeof(out)) == 5);
+    CHECK(memcmp(out, data + 3, 5) == 0);
+    memset(out, 0xff, sizeof(out));
+    CHECK(view->Pop(out, 4) == 20);
+    CHECK(memcmp(out, data + 8, 4) == 0 && out[4] == 0xff);
+    CHECK(view->Pop(out, sizeof(out)) == 0);
+
+    // A head the client moved past the tail reads as a full ring.
+    size_t map_size = kSharedRingDataOffset + view->Capacity();
+    uint8_t* map = static_cast<uint8_t*>(mmap(nullptr, map_size, PROT_READ | PROT_WRITE,
+            MAP_SHARED, view->MemFd(), 0));
+    CHECK(map != MAP_FAILED);
+    SharedRingControl* control = reinterpret_cast<SharedRingControl*>(map);
+    control->head.store(control->tail.load() + 1);
+    CHECK(!ring->Push(data, 1));
+    control->head.store(control->tail.load());
+
+    // A header claiming more than was pushed discards what is buffered.
+    uint64_t head = control->head.load();
+    CHECK(ring->Push(data, 1));
+    CHECK(ring->Push(data, 1));
+    SharedRingRecordHeader header = {1000};
+    memcpy(map + kSharedRingDataOffset + (head & (view->Capacity() - 1)), &header, sizeof(header));
+    CHECK(view->Pop(out, sizeof(out)) == 0);
+    CHECK(control->head.load() == control->tail.load());
+    CHECK(ring->Push(data, 1));
+    CHECK(view->Pop(out, sizeof(out)) == 1);
+    munmap(map, map_size);
+}
+
+static void checkAttachRejectsForeignFile() {
+    int memfd = open("/tmp", O_TMPFILE | O_RDWR, 0600);
+    CHECK(memfd >= 0);
+    CHECK(ftruncate(memfd, kSharedRingDataOffset + 128) == 0);
+    CHECK(!SharedRing::Attach(memfd, eventfd(0, 0)));
+}
+
+// The producer pushes numbered 8-byte records while the consumer drains
+// them; every record is either received in order or counted as dropped.
+static void checkConcurrent() {
+    const uint64_t kRecords = 1000000;
+    std::unique_ptr<SharedRing> ring = SharedRing::Create("test", 4096);
+    CHECK(ring);
+    std::unique_ptr<SharedRing> view = SharedRing::Attach(dup(ring->MemFd()), dup(ring->EventFd()));
+    CHECK(view);
+
+    std::thread producer([&]() {
+        for (uint64_t i = 0; i < kRecords; i++)
+            ring->Push(reinterpret_cast<const uint8_t*>(&i), sizeof(i));
+    });
+
+    uint64_t received = 0;
+    uint64_t last = 0;
+    while (received + view->Dropped() < kRecords) {
+        uint64_t record;
+        size_t size = view->Pop(reinterpret_cast<uint8_t*>(&record), sizeof(record));
+        if (size) {
+            CHECK(size == sizeof(record));
+            CHECK(received == 0 || record > last);
+            last = record;
+            received++;
+        } else {
+            struct pollfd pfd = {view->EventFd(), POLLIN, 0};
+            poll(&pfd, 1, 10);
+            uint64_t count;
+            if (read(view->EventFd(), &count, sizeof(count)) < 0) {}
+        }
+    }
+    producer.join();
+    CHECK(received > 0);
+    CHECK(received + view->Dropped() == kRecords);
+}
+
+int main() {
+    checkHandover();
+    checkAttachRejectsForeignFile();
+    checkConcurrent();
+    return 0;
+}
@@ -0,0 +1,82 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// UartDriverSysfs baud rates on a pseudo terminal: table rates go through
+// TCSETS, others through termios2 and BOTHER. The kernel's view is read
+// back on a second fd, independently of the driver's getBaudrate().
+//
+// <asm/termbits.h> is used here instead of <termios.h>; the two cannot be
+// included together and termios2 is only in the former.
+
+#include <asm/termbits.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "TestCheck.h"
+#include "UartDriverSysfs.h"
+
+static struct termios2 kernelConfig(const char* path) {
+    int fd = open(path, O_RDONLY | O_NOCTTY);
+    CHECK(fd >= 0);
+    struct termios2 config;
+    CHECK(ioctl(fd, TCGETS2, &config) == 0);
+    close(fd);
+    return config;
+}
+
+int main() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(master >= 0);
+    CHECK(grantpt(master) == 0 && unlockpt(master) == 0);
+    const char* slave = ptsname(master);
+    CHECK(slave);
+
+    UartDriverSysfs driver(nullptr);
+    CHECK(driver.Init(slave));
+
+    for (uint32_t rate : {9600u, 115200u, 921600u, 4000000u}) {
+        CHECK(driver.SetBaudrate(rate) == 0);
+        uint32_t baudrate = 0;
+        driver.getBaudrate(&baudrate);
+        CHECK(baudrate == rate);
+        CHECK((kernelConfig(slave).c_cflag & CBAUD) != BOTHER);
+    }
+
+    // DMX and MIDI rates have no B* constant.
+    for (uint32_t rate : {250000u, 31250u}) {
+        CHECK(driver.SetBaudrate(rate) == 0);
+        uint32_t baudrate = 0;
+        driver.getBaudrate(&baudrate);
+        CHECK(baudrate == rate);
+        struct termios2 config = kernelConfig(slave);
+        CHECK((config.c_cflag & CBAUD) == BOTHER);
+        CHECK(config.c_ospeed == rate);
+    }
+
+    // Data still flows at the custom rate.
+    const char message[] = "hello";
+    uint32_t written = 0;
+    CHECK(driver.Write(std::vector<uint8_t>(message, message + 5), &written) == 0);
+    CHECK(written == 5);
+    char received[5];
+    CHECK(read(master, received, sizeof(received)) == 5);
+    CHECK(memcmp(received, message, 5) == 0);
+
+    close(master);
+    return 0;
+}
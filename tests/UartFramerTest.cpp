@@ -0,0 +1,233 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// UART framing with checksums, end to end on a pseudo terminal: frames
+// encoded here are written to the master side, read back through
+// UartDriverSysfs in whatever chunks the tty delivers, and cut by the
+// framer. Each framing also gets its input one byte at a time, a frame
+// with a corrupted byte and an oversized one.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Checksum.h"
+#include "TestCheck.h"
+#include "UartDriverSysfs.h"
+#include "UartFramer.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static Bytes cobsEncode(const Bytes& frame) {
+    Bytes out(1);
+    size_t code_at = 0;
+    for (uint8_t byte : frame) {
+        if (byte) {
+            out.push_back(byte);
+            if (out.size() - code_at < 0xff)
+                continue;
+        }
+        out[code_at] = out.size() - code_at;
+        code_at = out.size();
+        out.push_back(0);
+    }
+    out[code_at] = out.size() - code_at;
+    out.push_back(0);
+    return out;
+}
+
+static Bytes slipEncode(const Bytes& frame) {
+    Bytes out;
+    for (uint8_t byte : frame) {
+        if (byte == 0xc0) {
+            out.push_back(0xdb);
+            out.push_back(0xdc);
+        } else if (byte == 0xdb) {
+            out.push_back(0xdb);
+            out.push_back(0xdd);
+        } else {
+            out.push_back(byte);
+        }
+    }
+    out.push_back(0xc0);
+    return out;
+}
+
+static Bytes lengthEncode(const Bytes& frame, const UartFramerConfig& config) {
+    Bytes out;
+    for (size_t i = 0; i < config.length_bytes; i++) {
+        size_t shift = 8 * (config.big_endian ? config.length_bytes - 1 - i : i);
+        out.push_back(frame.size() >> shift);
+    }
+    out.insert(out.end(), frame.begin(), frame.end());
+    return out;
+}
+
+static Bytes encode(const Bytes& frame, const UartFramerConfig& config) {
+    if (config.type == kFramingCobs)
+        return cobsEncode(frame);
+    if (config.type == kFramingSlip)
+        return slipEncode(frame);
+    if (config.type == kFramingLength)
+        return lengthEncode(frame, config);
+    Bytes out = frame;
+    out.push_back(config.delimiter);
+    return out;
+}
+
+// Payloads with the bytes each framing has to escape or delimit.
+static std::vector<Bytes> payloads() {
+    std::vector<Bytes> frames = {
+        {'h', 'e', 'l', 'l', 'o'},
+        {0x00, 0xc0, 0xdb, 0xdc, 0xdd, 0x00},
+        {0x01},
+    };
+    Bytes ramp;
+    for (int i = 0; i < 300; i++)
+        ramp.push_back(i % 251 + 1);
+    frames.push_back(ramp);
+    return frames;
+}
+
+// The wire bytes of |frames|, checksum added. Frame |corrupt| gets one
+// payload byte flipped after its checksum was computed; without a checksum
+// nothing is corrupted.
+static Bytes wire(const std::vector<Bytes>& frames, const UartFramerConfig& config, size_t corrupt) {
+    Bytes out;
+    for (size_t i = 0; i < frames.size(); i++) {
+        Bytes frame = frames[i];
+        AppendChecksum(config.checksum, &frame);
+        if (i == corrupt && !config.checksum.empty())
+            frame[0] ^= 0x20;
+        Bytes encoded = encode(frame, config);
+        out.insert(out.end(), encoded.begin(), encoded.end());
+    }
+    return out;
+}
+
+static void checkFrames(const UartFramer& framer, const UartFramer::Frames& got,
+        const std::vector<Bytes>& frames, size_t corrupt) {
+    if (framer.Config().checksum.empty())
+        corrupt = frames.size();
+    UartFramer::Frames expected;
+    for (size_t i = 0; i < frames.size(); i++) {
+        if (i != corrupt)
+            expected.push_back(frames[i]);
+    }
+    CHECK(got == expected);
+    CHECK(framer.DroppedCount() == (corrupt < frames.size() ? 1 : 0));
+}
+
+static void checkPty(const UartFramerConfig& config, int master, UartDriverSysfs* driver,
+        int polling_fd) {
+    const std::vector<Bytes> frames = payloads();
+    std::unique_ptr<UartFramer> framer = UartFramer::Create(config);
+    CHECK(framer);
+    Bytes bytes = wire(frames, config, 1);
+    size_t sent = 0;
+    size_t received = 0;
+    UartFramer::Frames got;
+    while (received < bytes.size()) {
+        if (sent < bytes.size()) {
+            ssize_t ret = write(master, bytes.data() + sent, std::min<size_t>(64, bytes.size() - sent));
+            CHECK(ret > 0 || errno == EAGAIN);
+            if (ret > 0)
+                sent += ret;
+        }
+        struct pollfd pfd = {polling_fd, POLLIN, 0};
+        CHECK(poll(&pfd, 1, 1000) == 1);
+        Bytes data;
+        uint32_t size = 0;
+        if (driver->Read(&data, 256, &size) == 0) {
+            framer->Feed(data.data(), size, &got);
+            received += size;
+        }
+    }
+    checkFrames(*framer, got, frames, 1);
+}
+
+static void checkBytewise(const UartFramerConfig& config) {
+    const std::vector<Bytes> frames = payloads();
+    std::unique_ptr<UartFramer> framer = UartFramer::Create(config);
+    CHECK(framer);
+    Bytes bytes = wire(frames, config, 2);
+    UartFramer::Frames got;
+    for (uint8_t byte : bytes)
+        framer->Feed(&byte, 1, &got);
+    checkFrames(*framer, got, frames, 2);
+
+    // A frame one byte over the limit is dropped. The delimiting framings
+    // then cut the next frame; a length prefix has nothing to resynchronize
+    // on, so there only the drop is checked.
+    UartFramerConfig limited = config;
+    limited.max_length = 8 + ChecksumSize(config.checksum);
+    framer = UartFramer::Create(limited);
+    CHECK(framer);
+    got.clear();
+    if (config.type == kFramingLength) {
+        bytes = wire(std::vector<Bytes>(1, Bytes(9, 0)), limited, 1);
+        framer->Feed(bytes.data(), bytes.size(), &got);
+        CHECK(got.empty());
+        CHECK(framer->DroppedCount() >= 1);
+        return;
+    }
+    std::vector<Bytes> sized = {Bytes(9, 'x'), Bytes(8, 'y')};
+    bytes = wire(sized, limited, sized.size());
+    framer->Feed(bytes.data(), bytes.size(), &got);
+    CHECK(got == UartFramer::Frames(1, sized[1]));
+    CHECK(framer->DroppedCount() == 1);
+}
+
+int main() {
+    const uint8_t check[] = "123456789";
+    CHECK(Crc16Modbus(check, 9) == 0x4b37);
+    CHECK(Crc16Ccitt(check, 9) == 0x29b1);
+    CHECK(Crc32(check, 9) == 0xcbf43926);
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(master >= 0);
+    CHECK(grantpt(master) == 0 && unlockpt(master) == 0);
+    CHECK(fcntl(master, F_SETFL, O_NONBLOCK) == 0);
+    UartDriverSysfs driver(nullptr);
+    CHECK(driver.Init(ptsname(master)));
+    int polling_fd = -1;
+    CHECK(driver.GetuPollingFd(&polling_fd) >= 0);
+
+    std::vector<UartFramerConfig> configs(5);
+    configs[0].type = kFramingCobs;
+    configs[0].checksum = kChecksumCrc16Ccitt;
+    configs[1].type = kFramingSlip;
+    configs[1].checksum = kChecksumCrc16Modbus;
+    configs[2].type = kFramingLength;
+    configs[2].length_bytes = 2;
+    configs[2].big_endian = false;
+    configs[2].checksum = kChecksumCrc32;
+    configs[3].type = kFramingLength;
+    configs[3].length_bytes = 4;
+    configs[3].checksum = kChecksumCrc16Ccitt;
+    // No checksum here, its bytes could contain the delimiter.
+    configs[4].type = kFramingDelimiter;
+    configs[4].delimiter = 0xff;
+
+    for (const UartFramerConfig& config : configs) {
+        checkPty(config, master, &driver, polling_fd);
+        checkBytewise(config);
+    }
+
+    close(master);
+    return 0;
+}
@@ -0,0 +1,208 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// UART framing throughput over a pseudo terminal loopback: a thread writes
+// encoded frames to the master side while UartDriverSysfs reads the slave
+// through its polling fd and the framer cuts what arrives. Each framing is
+// also fed the same bytes from memory, which separates the cost of the
+// framer from that of the tty. The reads column is how often a client
+// without server-side framing would have been woken up.
+//
+// Usage: UartFramingBenchmark [frames]
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <chrono>
+#include <thread>
+#include "Checksum.h"
+#include "UartDriverSysfs.h"
+#include "UartFramer.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+const size_t kPayloadSize = 64;
+
+static Bytes cobsEncode(const Bytes& frame) {
+    Bytes out(1);
+    size_t code_at = 0;
+    for (uint8_t byte : frame) {
+        if (byte) {
+            out.push_back(byte);
+            if (out.size() - code_at < 0xff)
+                continue;
+        }
+        out[code_at] = out.size() - code_at;
+        code_at = out.size();
+        out.push_back(0);
+    }
+    out[code_at] = out.size() - code_at;
+    out.push_back(0);
+    return out;
+}
+
+static Bytes slipEncode(const Bytes& frame) {
+    Bytes out;
+    for (uint8_t byte : frame) {
+        if (byte == 0xc0) {
+            out.push_back(0xdb);
+            out.push_back(0xdc);
+        } else if (byte == 0xdb) {
+            out.push_back(0xdb);
+            out.push_back(0xdd);
+        } else {
+            out.push_back(byte);
+        }
+    }
+    out.push_back(0xc0);
+    return out;
+}
+
+static Bytes encode(const Bytes& frame, const UartFramerConfig& config) {
+    if (config.type == kFramingCobs)
+        return cobsEncode(frame);
+    if (config.type == kFramingSlip)
+        return slipEncode(frame);
+    Bytes out;
+    if (config.type == kFramingLength) {
+        for (size_t i = 0; i < config.length_bytes; i++)
+            out.push_back(frame.size() >> (8 * (config.length_bytes - 1 - i)));
+        out.insert(out.end(), frame.begin(), frame.end());
+        return out;
+    }
+    out = frame;
+    out.push_back(config.delimiter);
+    return out;
+}
+
+// |frames| payloads with every byte value but the delimiter, checksum
+// added and encoded back to back.
+static Bytes wire(long frames, const UartFramerConfig& config) {
+    Bytes out;
+    for (long i = 0; i < frames; i++) {
+        Bytes frame;
+        for (size_t j = 0; j < kPayloadSize; j++) {
+            uint8_t byte = (i + j) & 0xff;
+            frame.push_back(byte == config.delimiter ? byte + 1 : byte);
+        }
+        AppendChecksum(config.checksum, &frame);
+        Bytes encoded = encode(frame, config);
+        out.insert(out.end(), encoded.begin(), encoded.end());
+    }
+    return out;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start) {
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+static void run(const char* name, const UartFramerConfig& config, long frames,
+        int master, UartDriverSysfs* driver, int polling_fd) {
+    const Bytes bytes = wire(frames, config);
+
+    std::unique_ptr<UartFramer> framer = UartFramer::Create(config);
+    UartFramer::Frames got;
+    auto start = std::chrono::steady_clock::now();
+    framer->Feed(bytes.data(), bytes.size(), &got);
+    double memory_ns = elapsedNs(start);
+    if (got.size() != static_cast<size_t>(frames)) {
+        fprintf(stderr, "%s: %zu of %ld frames from memory\n", name, got.size(), frames);
+        exit(1);
+    }
+
+    framer = UartFramer::Create(config);
+    got.clear();
+    long reads = 0;
+    size_t received = 0;
+    start = std::chrono::steady_clock::now();
+    std::thread writer([&]() {
+        size_t sent = 0;
+        while (sent < bytes.size()) {
+            ssize_t ret = write(master, bytes.data() + sent, bytes.size() - sent);
+            if (ret < 0) {
+                perror("pty write");
+                exit(1);
+            }
+            sent += ret;
+        }
+    });
+    while (received < bytes.size()) {
+        struct pollfd pfd = {polling_fd, POLLIN, 0};
+        if (poll(&pfd, 1, 1000) != 1) {
+            fprintf(stderr, "%s: pty stalled\n", name);
+            exit(1);
+        }
+        Bytes data;
+        uint32_t size = 0;
+        if (driver->Read(&data, 4096, &size) != 0)
+            continue;
+        reads++;
+        received += size;
+        framer->Feed(data.data(), size, &got);
+    }
+    double pty_ns = elapsedNs(start);
+    writer.join();
+    if (got.size() != static_cast<size_t>(frames) || framer->DroppedCount()) {
+        fprintf(stderr, "%s: %zu of %ld frames over the pty\n", name, got.size(), frames);
+        exit(1);
+    }
+
+    printf("%-22s memory %6.0f ns/frame  pty %7.0f ns/frame %8.0f frames/s %6.1f MB/s  %ld reads\n",
+            name, memory_ns / frames, pty_ns / frames, 1e9 * frames / pty_ns,
+            1e3 * bytes.size() / pty_ns, reads);
+}
+
+int main(int argc, char** argv) {
+    long frames = argc > 1 ? atol(argv[1]) : 20000;
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+        perror("pty");
+        return 1;
+    }
+    UartDriverSysfs driver(nullptr);
+    int polling_fd = -1;
+    if (!driver.Init(ptsname(master)) || driver.GetuPollingFd(&polling_fd) < 0) {
+        fprintf(stderr, "Init failed\n");
+        return 1;
+    }
+
+    UartFramerConfig config;
+    config.type = kFramingDelimiter;
+    config.delimiter = '\n';
+    run("delimiter", config, frames, master, &driver, polling_fd);
+
+    config = UartFramerConfig();
+    config.type = kFramingLength;
+    config.length_bytes = 2;
+    config.checksum = kChecksumCrc16Modbus;
+    run("length+crc16-modbus", config, frames, master, &driver, polling_fd);
+
+    config = UartFramerConfig();
+    config.type = kFramingCobs;
+    config.checksum = kChecksumCrc16Ccitt;
+    run("cobs+crc16-ccitt", config, frames, master, &driver, polling_fd);
+
+    config = UartFramerConfig();
+    config.type = kFramingSlip;
+    config.checksum = kChecksumCrc32;
+    run("slip+crc32", config, frames, master, &driver, polling_fd);
+
+    close(master);
+    return 0;
+}
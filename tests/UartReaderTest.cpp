@@ -0,0 +1,106 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// UartDriverSysfs background reader on a pseudo terminal: data reaches
+// Read() through the ring, FlushInput() empties it, and once the other
+// end hangs up the polling fd wakes up and Read() reports EIO instead of
+// EAGAIN. Without the reader neither a canonical read nor a write to a full
+// tty blocks.
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include "TestCheck.h"
+#include "UartDriverSysfs.h"
+
+// Waits for |fd| to become readable, at most a second.
+static bool waitReadable(int fd) {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    return poll(&pfd, 1, 1000) == 1 && (pfd.revents & POLLIN);
+}
+
+// Reads and writes run on the main loop, so they must not wait for the
+// other end.
+static void checkNonBlocking() {
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(master >= 0);
+    CHECK(grantpt(master) == 0 && unlockpt(master) == 0);
+
+    UartDriverSysfs canonical(nullptr);
+    CHECK(canonical.Init(ptsname(master), true));
+    std::vector<uint8_t> data;
+    uint32_t bytes_read = 0;
+    CHECK(write(master, "par", 3) == 3);
+    CHECK(canonical.Read(&data, 16, &bytes_read) == EAGAIN);
+    CHECK(write(master, "tial\n", 5) == 5);
+    int fd = -1;
+    CHECK(canonical.GetuPollingFd(&fd) >= 0);
+    CHECK(waitReadable(fd));
+    CHECK(canonical.Read(&data, 16, &bytes_read) == 0);
+    CHECK(bytes_read == 8 && memcmp(data.data(), "partial\n", 8) == 0);
+
+    // Nobody reads the master, so the tty fills up.
+    std::vector<uint8_t> chunk(4096, 'x');
+    uint32_t bytes_written = chunk.size();
+    for (int i = 0; i < 1024 && bytes_written; i++)
+        CHECK(canonical.Write(chunk, &bytes_written) == 0);
+    CHECK(bytes_written == 0);
+
+    close(master);
+}
+
+int main() {
+    checkNonBlocking();
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    CHECK(master >= 0);
+    CHECK(grantpt(master) == 0 && unlockpt(master) == 0);
+    const char* slave = ptsname(master);
+    CHECK(slave);
+
+    UartDriverSysfs driver(nullptr);
+    CHECK(driver.Init(slave));
+    CHECK(driver.StartReader(4096));
+    int polling_fd = -1;
+    CHECK(driver.GetuPollingFd(&polling_fd) >= 0);
+
+    std::vector<uint8_t> data;
+    uint32_t bytes_read = 0;
+    CHECK(driver.Read(&data, 16, &bytes_read) == EAGAIN);
+
+    CHECK(write(master, "abc", 3) == 3);
+    CHECK(waitReadable(polling_fd));
+    CHECK(driver.Read(&data, 16, &bytes_read) == 0);
+    CHECK(bytes_read == 3 && memcmp(data.data(), "abc", 3) == 0);
+
+    // FlushInput() drops what the reader buffered but nobody read.
+    CHECK(write(master, "stale", 5) == 5);
+    CHECK(waitReadable(polling_fd));
+    CHECK(driver.FlushInput() == 0);
+    CHECK(driver.Read(&data, 16, &bytes_read) == EAGAIN);
+
+    close(master);
+    CHECK(waitReadable(polling_fd));
+    CHECK(driver.Read(&data, 16, &bytes_read) == EIO);
+    CHECK(bytes_read == 0);
+    // The failure stays signalled for the next poller.
+    CHECK(waitReadable(polling_fd));
+    CHECK(driver.Read(&data, 16, &bytes_read) == EIO);
+    return 0;
+}
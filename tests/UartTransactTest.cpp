@@ -0,0 +1,87 @@
+// Copyright (c) 2021 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// When a uart/transact reply is complete: a terminator split at every
+// possible point across reads, near misses, the size limit, and both
+// together.
+
+#include <string>
+#include "TestCheck.h"
+#include "UartFramer.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static Bytes bytes(const std::string& text) {
+    return Bytes(text.begin(), text.end());
+}
+
+// Feeds |input| cut at |first| and |second|; returns the read that
+// completed the reply, or 0 if none did.
+static int feed(const std::string& input, size_t first, size_t second,
+        const Bytes& terminator, size_t size, Bytes* reply) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(input.data());
+    size_t cuts[] = {0, first, second, input.size()};
+    for (int i = 0; i < 3; i++) {
+        if (AppendUartReply(data + cuts[i], cuts[i + 1] - cuts[i], terminator, size, reply))
+            return i + 1;
+    }
+    return 0;
+}
+
+int main() {
+    const Bytes terminator = bytes("\r\nOK\r\n");
+    const std::string input = "AT+CSQ\r\n+CSQ: 21,99\r\nOK\r\nRING";
+    const Bytes expected = bytes("AT+CSQ\r\n+CSQ: 21,99\r\nOK\r\n");
+
+    for (size_t first = 0; first <= input.size(); first++) {
+        for (size_t second = first; second <= input.size(); second++) {
+            Bytes reply;
+            int completed = feed(input, first, second, terminator, 0, &reply);
+            CHECK(completed);
+            CHECK(reply == expected);
+        }
+    }
+
+    // Parts of the terminator alone do not complete the reply.
+    Bytes reply;
+    CHECK(!AppendUartReply(terminator.data(), 3, terminator, 0, &reply));
+    CHECK(!AppendUartReply(reinterpret_cast<const uint8_t*>("X\r\n"), 3, terminator, 0, &reply));
+    CHECK(!AppendUartReply(terminator.data(), 2, terminator, 0, &reply));
+    CHECK(AppendUartReply(terminator.data() + 2, 4, terminator, 0, &reply));
+    CHECK(reply == bytes("\r\nOX\r\n\r\nOK\r\n"));
+
+    // Size alone completes at exactly that many bytes.
+    reply.clear();
+    CHECK(feed("0123456789", 4, 7, Bytes(), 8, &reply) == 3);
+    CHECK(reply == bytes("01234567"));
+    reply.clear();
+    CHECK(feed("0123456789", 4, 8, Bytes(), 8, &reply) == 2);
+    CHECK(reply == bytes("01234567"));
+
+    // Whichever comes first ends the reply.
+    reply.clear();
+    CHECK(feed("ab\r\nOK\r\ncd", 3, 9, terminator, 4, &reply) == 2);
+    CHECK(reply == bytes("ab\r\nOK\r\n"));
+    reply.clear();
+    CHECK(feed("abcdef\r\nOK\r\n", 2, 5, terminator, 4, &reply) == 2);
+    CHECK(reply == bytes("abcd"));
+
+    // Without either the reply only ends with the timeout.
+    reply.clear();
+    CHECK(feed("abcdef", 2, 4, Bytes(), 0, &reply) == 0);
+    CHECK(reply == bytes("abcdef"));
+    return 0;
+}